@@ -0,0 +1,221 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_BENCHMARKUTILS_H
+#define THREADING_BENCHMARKUTILS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Helpers shared by benchmark executables: clock, percentiles,
+ * command line parsing and a minimal JSON object writer.
+ */
+namespace bench {
+
+typedef std::chrono::steady_clock Clock;
+
+inline int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Percentile summary of a set of samples
+ */
+struct Summary {
+    size_t count = 0;
+    double mean = 0;
+    double p50 = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double p999 = 0;
+    double max = 0;
+};
+
+/**
+ * Nearest-rank percentile of sorted samples
+ * @param sorted samples sorted ascending, must not be empty
+ * @param q quantile in [0, 1]
+ */
+inline double percentile(const std::vector<double>& sorted, double q)
+{
+    size_t rank = static_cast<size_t>(q * sorted.size());
+    if (rank >= sorted.size())
+        rank = sorted.size() - 1;
+    return sorted[rank];
+}
+
+/**
+ * @brief Sorts samples in place and summarizes them
+ */
+inline Summary summarize(std::vector<double>& samples)
+{
+    Summary s;
+    if (samples.empty())
+        return s;
+    std::sort(samples.begin(), samples.end());
+    double total = 0;
+    for (double v : samples)
+        total += v;
+    s.count = samples.size();
+    s.mean = total / samples.size();
+    s.p50 = percentile(samples, 0.50);
+    s.p90 = percentile(samples, 0.90);
+    s.p99 = percentile(samples, 0.99);
+    s.p999 = percentile(samples, 0.999);
+    s.max = samples.back();
+    return s;
+}
+
+/**
+ * @brief Builds one flat JSON object, fields are written in insertion order
+ */
+class JsonObject {
+public:
+    JsonObject& field(const std::string& name, const std::string& value)
+    {
+        std::string escaped;
+        for (char c : value) {
+            if (c == '"' || c == '\\')
+                escaped.push_back('\\');
+            escaped.push_back(c);
+        }
+        return raw(name, "\"" + escaped + "\"");
+    }
+
+    JsonObject& field(const std::string& name, const char* value)
+    { return field(name, std::string(value)); }
+
+    JsonObject& field(const std::string& name, double value)
+    {
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(3) << value;
+        return raw(name, ss.str());
+    }
+
+    JsonObject& field(const std::string& name, uint64_t value)
+    { return raw(name, std::to_string(value)); }
+
+    JsonObject& field(const std::string& name, unsigned int value)
+    { return raw(name, std::to_string(value)); }
+
+    JsonObject& field(const std::string& name, bool value)
+    { return raw(name, value ? "true" : "false"); }
+
+    /**
+     * Writes p50/p90/p99/p999/max/mean fields prefixed with @p prefix
+     */
+    JsonObject& summary(const std::string& prefix, const Summary& s)
+    {
+        field(prefix + "mean", s.mean);
+        field(prefix + "p50", s.p50);
+        field(prefix + "p90", s.p90);
+        field(prefix + "p99", s.p99);
+        field(prefix + "p999", s.p999);
+        return field(prefix + "max", s.max);
+    }
+
+    std::string str() const
+    { return "{" + body + "}"; }
+
+private:
+    JsonObject& raw(const std::string& name, const std::string& value)
+    {
+        if (!body.empty())
+            body += ", ";
+        body += "\"" + name + "\": " + value;
+        return *this;
+    }
+
+    std::string body;
+};
+
+/**
+ * @brief Trivial "--name value" command line parser
+ */
+class Args {
+public:
+    Args(int argc, char** argv)
+    {
+        for (int i = 1; i + 1 < argc; i += 2)
+            if (std::strncmp(argv[i], "--", 2) == 0)
+                values.emplace_back(argv[i] + 2, argv[i + 1]);
+    }
+
+    std::string get(const std::string& name, const std::string& def) const
+    {
+        for (const auto& kv : values)
+            if (kv.first == name)
+                return kv.second;
+        return def;
+    }
+
+    uint64_t getUInt(const std::string& name, uint64_t def) const
+    {
+        std::string v = get(name, "");
+        return v.empty() ? def : std::strtoull(v.c_str(), nullptr, 10);
+    }
+
+    double getDouble(const std::string& name, double def) const
+    {
+        std::string v = get(name, "");
+        return v.empty() ? def : std::strtod(v.c_str(), nullptr);
+    }
+
+    /**
+     * Parses comma separated list of numbers, e.g. "1000,2000,5000"
+     */
+    std::vector<double> getList(const std::string& name, const std::string& def) const
+    {
+        std::vector<double> list;
+        std::stringstream ss(get(name, def));
+        std::string item;
+        while (std::getline(ss, item, ','))
+            if (!item.empty())
+                list.push_back(std::strtod(item.c_str(), nullptr));
+        return list;
+    }
+
+private:
+    std::vector<std::pair<std::string, std::string>> values;
+};
+
+/**
+ * @brief Deterministic xorshift generator so that runs are reproducible
+ */
+class Random {
+public:
+    explicit Random(uint64_t seed) : state(seed ? seed : 0x9E3779B97F4A7C15ull) { }
+
+    uint64_t next()
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    /// @return uniformly distributed value in (0, 1]
+    double nextUnit()
+    { return (static_cast<double>(next() >> 11) + 1.0) / 9007199254740992.0; }
+
+private:
+    uint64_t state;
+};
+
+} // namespace bench
+
+#endif //THREADING_BENCHMARKUTILS_H
@@ -0,0 +1,328 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+/*
+ * Microbenchmarks for the threading primitives.
+ *
+ * Every benchmark is run for 1..max-threads threads, each thread performs
+ * the same fixed number of operations, so runs are reproducible.
+ * Operations are timed in batches, per-batch ns/op samples give percentiles.
+ * Results are printed to stdout as a JSON array.
+ *
+ * Options:
+ *   --max-threads N   highest thread count (default: hardware concurrency)
+ *   --ops N           timed operations per thread (default: 100000)
+ *   --batch N         operations per timing sample (default: 100)
+ *   --filter NAME     run only benchmarks whose name contains NAME
+ */
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "utils/Condition.h"
+#include "utils/EventCount.h"
+#include "utils/GuardedDeque.h"
+#include "utils/GuardedMap.h"
+#include "query_thread/QueryBase.h"
+
+namespace {
+
+struct Config {
+    unsigned int threads;
+    uint64_t ops;
+    uint64_t batch;
+};
+
+/**
+ * @brief Single benchmark description
+ *
+ * setUp() is called once per thread count before threads are started,
+ * op() is the measured operation, tearDown() is called after threads are joined.
+ */
+struct Benchmark {
+    std::string name;
+    std::function<void(const Config&)> setUp;
+    std::function<void(unsigned int thread, uint64_t i)> op;
+    std::function<void()> tearDown;
+};
+
+/**
+ * @brief Spinning start barrier, keeps threads from starting measurement
+ * before all of them are created
+ */
+class StartBarrier {
+public:
+    explicit StartBarrier(unsigned int count) : remaining(count) { }
+
+    void arriveAndWait()
+    {
+        remaining.fetch_sub(1, std::memory_order_acq_rel);
+        while (remaining.load(std::memory_order_acquire) != 0)
+            std::this_thread::yield();
+    }
+
+private:
+    std::atomic<unsigned int> remaining;
+};
+
+std::string runBenchmark(Benchmark& b, const Config& config)
+{
+    if (b.setUp)
+        b.setUp(config);
+
+    std::vector<std::vector<double>> samples(config.threads);
+    std::vector<int64_t> startNs(config.threads), endNs(config.threads);
+    StartBarrier barrier(config.threads + 1);
+    std::vector<std::thread> threads;
+
+    for (unsigned int t = 0; t < config.threads; t++) {
+        threads.emplace_back([&, t] {
+            std::vector<double>& mine = samples[t];
+            mine.reserve(config.ops / config.batch + 1);
+            for (uint64_t i = 0; i < config.ops / 10; i++)
+                b.op(t, i);
+
+            barrier.arriveAndWait();
+            startNs[t] = bench::nowNs();
+            for (uint64_t done = 0; done < config.ops; ) {
+                uint64_t n = std::min(config.batch, config.ops - done);
+                int64_t start = bench::nowNs();
+                for (uint64_t i = 0; i < n; i++)
+                    b.op(t, done + i);
+                mine.push_back(static_cast<double>(bench::nowNs() - start) / n);
+                done += n;
+            }
+            endNs[t] = bench::nowNs();
+        });
+    }
+
+    barrier.arriveAndWait();
+    for (auto& thread : threads)
+        thread.join();
+    double wallNs = static_cast<double>(*std::max_element(endNs.begin(), endNs.end()) -
+                                        *std::min_element(startNs.begin(), startNs.end()));
+
+    if (b.tearDown)
+        b.tearDown();
+
+    std::vector<double> all;
+    for (auto& s : samples)
+        all.insert(all.end(), s.begin(), s.end());
+    bench::Summary s = bench::summarize(all);
+    uint64_t totalOps = config.ops * config.threads;
+
+    return bench::JsonObject()
+            .field("benchmark", b.name)
+            .field("threads", config.threads)
+            .field("ops", totalOps)
+            .field("ops_per_sec", totalOps / (wallNs / 1e9))
+            .summary("ns_per_op_", s)
+            .str();
+}
+
+/*
+ * State shared by benchmarks, recreated by setUp() for every thread count
+ */
+std::unique_ptr<GuardedDeque<uint64_t>> deque;
+std::unique_ptr<GuardedMap<uint64_t, uint64_t>> map;
+std::vector<bench::Random> randoms;
+
+/**
+ * @brief Pair of threads bouncing a token through a Condition
+ *
+ * The benchmark thread sets the token and waits until echo thread resets it,
+ * so one op is a full notify/wait round trip.
+ */
+struct PingPong {
+    Condition::SPtr cond = Condition::create();
+    bool token = false;
+    bool stop = false;
+    std::thread echo;
+
+    PingPong()
+    {
+        echo = std::thread([this] {
+            while (true) {
+                cond->wait(WAKE_IF(token || stop));
+                cond->acquireLock();
+                if (stop) {
+                    cond->releaseLock();
+                    break;
+                }
+                token = false;
+                cond->releaseLock();
+                cond->notify_one();
+            }
+        });
+    }
+
+    ~PingPong()
+    {
+        cond->acquireLock();
+        stop = true;
+        cond->releaseLock();
+        cond->notify_all();
+        echo.join();
+    }
+
+    void roundTrip()
+    {
+        cond->acquireLock();
+        token = true;
+        cond->releaseLock();
+        cond->notify_one();
+        cond->wait(WAKE_IF(!token));
+    }
+};
+
+/**
+ * @brief Same round trip as PingPong, but through an EventCount and an atomic token
+ */
+struct EventPingPong {
+    EventCount::SPtr events = EventCount::create();
+    std::atomic<bool> token{false};
+    std::atomic<bool> stop{false};
+    std::thread echo;
+
+    EventPingPong()
+    {
+        echo = std::thread([this] {
+            while (true) {
+                events->wait(WAKE_IF(token.load() || stop.load()));
+                if (stop.load())
+                    break;
+                token.store(false);
+                events->notify_all();
+            }
+        });
+    }
+
+    ~EventPingPong()
+    {
+        stop.store(true);
+        events->notify_all();
+        echo.join();
+    }
+
+    void roundTrip()
+    {
+        token.store(true);
+        events->notify_all();
+        events->wait(WAKE_IF(!token.load()));
+    }
+};
+
+std::vector<std::unique_ptr<PingPong>> pingPongs;
+std::vector<std::unique_ptr<EventPingPong>> eventPingPongs;
+Condition::SPtr idleCondition;
+EventCount::SPtr idleEventCount;
+
+void resetRandoms(const Config& config)
+{
+    randoms.clear();
+    for (unsigned int t = 0; t < config.threads; t++)
+        randoms.emplace_back(t + 1);
+}
+
+std::vector<Benchmark> makeBenchmarks()
+{
+    std::vector<Benchmark> list;
+
+    list.push_back({"guarded_deque_push_pop",
+        [](const Config&) { deque.reset(new GuardedDeque<uint64_t>()); },
+        [](unsigned int, uint64_t i) {
+            deque->pushBack(i);
+            deque->getFront();
+        },
+        [] { deque.reset(); }});
+
+    list.push_back({"condition_notify_no_waiter",
+        [](const Config&) { idleCondition = Condition::create(); },
+        [](unsigned int, uint64_t) { idleCondition->notify_one(); },
+        [] { idleCondition.reset(); }});
+
+    list.push_back({"condition_round_trip",
+        [](const Config& config) {
+            for (unsigned int t = 0; t < config.threads; t++)
+                pingPongs.emplace_back(new PingPong());
+        },
+        [](unsigned int t, uint64_t) { pingPongs[t]->roundTrip(); },
+        [] { pingPongs.clear(); }});
+
+    list.push_back({"event_count_notify_no_waiter",
+        [](const Config&) { idleEventCount = EventCount::create(); },
+        [](unsigned int, uint64_t) { idleEventCount->notify_one(); },
+        [] { idleEventCount.reset(); }});
+
+    list.push_back({"event_count_round_trip",
+        [](const Config& config) {
+            for (unsigned int t = 0; t < config.threads; t++)
+                eventPingPongs.emplace_back(new EventPingPong());
+        },
+        [](unsigned int t, uint64_t) { eventPingPongs[t]->roundTrip(); },
+        [] { eventPingPongs.clear(); }});
+
+    list.push_back({"query_set_get",
+        nullptr,
+        [](unsigned int, uint64_t i) {
+            auto query = std::make_shared<QueryBase<uint64_t>>();
+            query->setResult(i);
+            query->getResult();
+        },
+        nullptr});
+
+    list.push_back({"guarded_map_get",
+        [](const Config& config) {
+            resetRandoms(config);
+            map.reset(new GuardedMap<uint64_t, uint64_t>());
+            for (uint64_t k = 0; k < 1024; k++)
+                map->set(k, k);
+        },
+        [](unsigned int t, uint64_t) { map->get(randoms[t].next() % 1024); },
+        [] { map.reset(); }});
+
+    list.push_back({"guarded_map_set",
+        [](const Config& config) {
+            resetRandoms(config);
+            map.reset(new GuardedMap<uint64_t, uint64_t>());
+        },
+        [](unsigned int t, uint64_t i) { map->set(randoms[t].next() % 1024, i); },
+        [] { map.reset(); }});
+
+    return list;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bench::Args args(argc, argv);
+    unsigned int hw = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int maxThreads = static_cast<unsigned int>(args.getUInt("max-threads", hw));
+    std::string filter = args.get("filter", "");
+
+    Config config;
+    config.ops = args.getUInt("ops", 100000);
+    config.batch = std::max<uint64_t>(1, args.getUInt("batch", 100));
+
+    std::vector<Benchmark> benchmarks = makeBenchmarks();
+    bool first = true;
+    std::cout << "[" << std::endl;
+    for (auto& b : benchmarks) {
+        if (!filter.empty() && b.name.find(filter) == std::string::npos)
+            continue;
+        for (unsigned int t = 1; t <= maxThreads; t++) {
+            config.threads = t;
+            std::cout << (first ? "  " : ", ") << runBenchmark(b, config) << std::endl;
+            first = false;
+        }
+    }
+    std::cout << "]" << std::endl;
+    return 0;
+}
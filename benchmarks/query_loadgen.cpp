@@ -0,0 +1,357 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+/*
+ * Open-loop load generator for query threads.
+ *
+ * Queries are sent on a fixed schedule (constant or Poisson arrivals) which
+ * does not depend on how fast they are processed. Latency is measured from
+ * the time the query was scheduled to be sent, not from the time it was
+ * actually pushed, so queueing delay is never hidden by a slow sender
+ * (coordinated omission correction).
+ *
+ * For every offered rate a fresh target is created, loaded for --duration-ms
+ * and drained, one JSON object per rate is printed as part of a JSON array.
+ *
+ * Options:
+ *   --target pool|simple|timeout  query thread type (default: pool)
+ *   --workers N                   pool size (default: hardware concurrency)
+ *   --timeout-ms N                QueryThreadTimeout timeout (default: 10)
+ *   --rates R1,R2,...             offered rates in queries/sec (default: 1000,10000,50000)
+ *   --arrival constant|poisson    arrival process (default: constant)
+ *   --service-us N                synthetic service time (default: 10)
+ *   --service-dist fixed|exp      service time distribution (default: fixed)
+ *   --duration-ms N               load duration per rate (default: 2000)
+ *   --drain-ms N                  max time to wait for backlog (default: duration)
+ *   --wait busy|yield|park|block  worker wait policy (default: block)
+ *   --codel-target-us N           enable CoDel shedding with this target (default: off)
+ *   --codel-interval-us N         CoDel interval (default: 100000)
+ *   --seed N                      random seed (default: 1)
+ */
+
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "query_thread/QueryBase.h"
+#include "query_thread/QueryQueueBase.h"
+#include "query_thread/QueryThreadPool.h"
+#include "query_thread/QueryThreadPoolThread.h"
+#include "query_thread/QueryThreadSimple.h"
+#include "query_thread/QueryThreadTimeout.h"
+
+namespace {
+
+struct LoadQuery : public QueryBase<void> {
+    LoadQuery(int64_t intendedNs, int64_t serviceNs)
+            : intendedNs(intendedNs), serviceNs(serviceNs) { }
+
+    /// Time the query was scheduled to be sent at
+    const int64_t intendedNs;
+    /// Synthetic work to burn in onQuery
+    const int64_t serviceNs;
+};
+
+/**
+ * @brief Collects latencies, every worker gets its own slot to avoid contention
+ */
+class LatencyRecorder {
+public:
+    explicit LatencyRecorder(unsigned int slots) : samples(slots), completed(0) { }
+
+    unsigned int acquireSlot()
+    { return nextSlot.fetch_add(1, std::memory_order_relaxed); }
+
+    void record(unsigned int slot, double latencyNs)
+    {
+        samples[slot].push_back(latencyNs);
+        completed.fetch_add(1, std::memory_order_release);
+    }
+
+    uint64_t getCompleted() const
+    { return completed.load(std::memory_order_acquire); }
+
+    std::vector<double> merge() const
+    {
+        std::vector<double> all;
+        for (const auto& s : samples)
+            all.insert(all.end(), s.begin(), s.end());
+        return all;
+    }
+
+private:
+    std::vector<std::vector<double>> samples;
+    std::atomic<unsigned int> nextSlot{0};
+    std::atomic<uint64_t> completed;
+};
+
+void processLoadQuery(LoadQuery& query, LatencyRecorder& recorder, unsigned int slot)
+{
+    int64_t end = bench::nowNs() + query.serviceNs;
+    while (bench::nowNs() < end) { }
+    recorder.record(slot, static_cast<double>(bench::nowNs() - query.intendedNs));
+    query.setResult();
+}
+
+class LoadPoolWorker : public QueryThreadPoolThread<LoadQuery> {
+public:
+    LoadPoolWorker(const QueueTypePtr& queue, LatencyRecorder* recorder)
+            : QueryThreadPoolThread<LoadQuery>(queue)
+            , recorder(recorder)
+            , slot(recorder->acquireSlot()) { }
+
+protected:
+    void onQuery(QueryTypePtr query) override
+    { processLoadQuery(*query, *recorder, slot); }
+
+private:
+    LatencyRecorder* recorder;
+    unsigned int slot;
+};
+
+class LoadSimpleThread : public QueryThreadSimple<LoadQuery> {
+public:
+    explicit LoadSimpleThread(LatencyRecorder* recorder)
+            : recorder(recorder), slot(recorder->acquireSlot()) { }
+
+protected:
+    void onQuery(QueryTypePtr query) override
+    { processLoadQuery(*query, *recorder, slot); }
+
+private:
+    LatencyRecorder* recorder;
+    unsigned int slot;
+};
+
+class LoadTimeoutThread : public QueryThreadTimeout<LoadQuery> {
+public:
+    LoadTimeoutThread(std::chrono::milliseconds timeout, LatencyRecorder* recorder)
+            : QueryThreadTimeout<LoadQuery>(timeout)
+            , recorder(recorder), slot(recorder->acquireSlot()) { }
+
+protected:
+    void onQuery(QueryTypePtr query) override
+    { processLoadQuery(*query, *recorder, slot); }
+
+    void onTimeout() override {}
+
+private:
+    LatencyRecorder* recorder;
+    unsigned int slot;
+};
+
+/**
+ * @brief Uniform interface over the tested query thread types
+ */
+class Target {
+public:
+    virtual ~Target() = default;
+    virtual void put(std::shared_ptr<LoadQuery>&& query) = 0;
+    virtual void stop() = 0;
+    virtual uint64_t getShed() = 0;
+};
+
+/**
+ * @brief Settings applied to targets before they are started
+ */
+struct TargetConfig {
+    WaitStrategy strategy;
+    bool codel = false;
+    CoDelParams codelParams;
+
+    template<typename QueueType>
+    void apply(QueueType& queue) const
+    {
+        if (codel)
+            queue.enableCoDel(codelParams);
+    }
+};
+
+class PoolTarget : public Target {
+public:
+    PoolTarget(unsigned int workers, const TargetConfig& config, LatencyRecorder* recorder)
+            : pool(workers, std::make_shared<QueryQueueBase<LoadQuery>>(), recorder)
+    {
+        config.apply(*pool.getQueue());
+        pool.setWaitStrategy(config.strategy);
+        pool.startThreads();
+    }
+
+    void put(std::shared_ptr<LoadQuery>&& query) override
+    { pool.putQuery(std::move(query)); }
+
+    void stop() override
+    {
+        pool.stopThreads();
+        pool.joinThreads();
+    }
+
+    uint64_t getShed() override
+    { return pool.getQueue()->getShedCount(); }
+
+private:
+    QueryThreadPool<LoadPoolWorker> pool;
+};
+
+template<typename ThreadType>
+class ThreadTarget : public Target {
+public:
+    template<typename... Args>
+    explicit ThreadTarget(const TargetConfig& config, Args&&... args)
+            : thread(std::forward<Args>(args)...)
+    {
+        config.apply(*thread.getQueue());
+        thread.setWaitStrategy(config.strategy);
+        thread.startThread();
+    }
+
+    void put(std::shared_ptr<LoadQuery>&& query) override
+    { thread.putQuery(std::move(query)); }
+
+    void stop() override
+    {
+        thread.stopThread();
+        thread.joinThread();
+    }
+
+    uint64_t getShed() override
+    { return thread.getQueue()->getShedCount(); }
+
+private:
+    ThreadType thread;
+};
+
+/**
+ * Waits until @p deadlineNs, sleeping while it is far away and spinning
+ * for the last stretch to keep send times precise
+ */
+void waitUntil(int64_t deadlineNs)
+{
+    const int64_t spinNs = 50000;
+    while (true) {
+        int64_t left = deadlineNs - bench::nowNs();
+        if (left <= 0)
+            return;
+        if (left > spinNs)
+            std::this_thread::sleep_for(std::chrono::nanoseconds(left - spinNs));
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bench::Args args(argc, argv);
+    std::string targetName = args.get("target", "pool");
+    unsigned int workers = static_cast<unsigned int>(
+            args.getUInt("workers", std::max(1u, std::thread::hardware_concurrency())));
+    std::chrono::milliseconds timeout(args.getUInt("timeout-ms", 10));
+    std::vector<double> rates = args.getList("rates", "1000,10000,50000");
+    bool poisson = args.get("arrival", "constant") == "poisson";
+    double serviceNs = args.getDouble("service-us", 10) * 1000;
+    bool exponentialService = args.get("service-dist", "fixed") == "exp";
+    int64_t durationNs = static_cast<int64_t>(args.getUInt("duration-ms", 2000)) * 1000000;
+    int64_t drainNs = static_cast<int64_t>(args.getUInt("drain-ms", durationNs / 1000000)) * 1000000;
+    bench::Random random(args.getUInt("seed", 1));
+
+    std::string waitName = args.get("wait", "block");
+    WaitPolicy policy = WaitPolicy::Block;
+    if (waitName == "busy")
+        policy = WaitPolicy::BusySpin;
+    else if (waitName == "yield")
+        policy = WaitPolicy::SpinYield;
+    else if (waitName == "park")
+        policy = WaitPolicy::SpinPark;
+    TargetConfig config;
+    config.strategy = WaitStrategy(policy);
+    double codelTargetUs = args.getDouble("codel-target-us", 0);
+    if (codelTargetUs > 0) {
+        config.codel = true;
+        config.codelParams.target = std::chrono::microseconds(static_cast<int64_t>(codelTargetUs));
+        config.codelParams.interval = std::chrono::microseconds(args.getUInt("codel-interval-us", 100000));
+    }
+
+    if (targetName != "pool")
+        workers = 1;
+
+    std::cout << "[" << std::endl;
+    bool first = true;
+    for (double rate : rates) {
+        if (rate <= 0)
+            continue;
+        LatencyRecorder recorder(workers);
+        std::unique_ptr<Target> target;
+        if (targetName == "simple")
+            target.reset(new ThreadTarget<LoadSimpleThread>(config, &recorder));
+        else if (targetName == "timeout")
+            target.reset(new ThreadTarget<LoadTimeoutThread>(config, timeout, &recorder));
+        else
+            target.reset(new PoolTarget(workers, config, &recorder));
+
+        const double intervalNs = 1e9 / rate;
+        std::vector<int64_t> intended;
+        intended.reserve(static_cast<size_t>(rate * durationNs / 1e9) + 1);
+
+        int64_t start = bench::nowNs();
+        double offsetNs = 0;
+        while (offsetNs < durationNs) {
+            int64_t sendAt = start + static_cast<int64_t>(offsetNs);
+            waitUntil(sendAt);
+            double service = exponentialService ? -std::log(random.nextUnit()) * serviceNs : serviceNs;
+            target->put(std::make_shared<LoadQuery>(sendAt, static_cast<int64_t>(service)));
+            intended.push_back(sendAt);
+            offsetNs += poisson ? -std::log(random.nextUnit()) * intervalNs : intervalNs;
+        }
+
+        int64_t drainDeadline = bench::nowNs() + drainNs;
+        while (recorder.getCompleted() + target->getShed() < intended.size() &&
+               bench::nowNs() < drainDeadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        int64_t end = bench::nowNs();
+        uint64_t completed = recorder.getCompleted();
+        uint64_t shed = target->getShed();
+        uint64_t incomplete = intended.size() - std::min<uint64_t>(intended.size(), completed + shed);
+
+        target->stop();
+
+        std::vector<double> latencies = recorder.merge();
+        /*
+         * Queries which did not complete before the drain deadline were
+         * outstanding at least until then, account them with that lower bound
+         * so that an overloaded target does not look better than it is.
+         * Queries complete in FIFO order, so unfinished ones are the latest sent.
+         */
+        for (size_t i = intended.size() - incomplete; i < intended.size(); i++)
+            latencies.push_back(static_cast<double>(end - intended[i]));
+
+        bench::Summary s = bench::summarize(latencies);
+        for (double* v : {&s.mean, &s.p50, &s.p90, &s.p99, &s.p999, &s.max})
+            *v /= 1000;
+        double throughput = completed / ((end - start) / 1e9);
+
+        std::cout << (first ? "  " : ", ") << bench::JsonObject()
+                .field("target", targetName)
+                .field("workers", workers)
+                .field("arrival", poisson ? "poisson" : "constant")
+                .field("wait", waitName)
+                .field("service_us", serviceNs / 1000)
+                .field("offered_rate", rate)
+                .field("sent", static_cast<uint64_t>(intended.size()))
+                .field("completed", completed)
+                .field("shed", shed)
+                .field("incomplete", incomplete)
+                .field("throughput", throughput)
+                .summary("latency_us_", s)
+                .field("saturated", incomplete > 0 || shed > 0 || throughput < 0.95 * rate)
+                .str() << std::endl;
+        first = false;
+    }
+    std::cout << "]" << std::endl;
+    return 0;
+}
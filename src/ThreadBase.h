@@ -6,10 +6,14 @@
 #define THREADING_THREADBASE_H
 
 #include <atomic>
+#include <chrono>
 #include <string>
 #include <thread>
 #include <system_error>
 
+#include "utils/Condition.h"
+#include "utils/WaitStrategy.h"
+
 /**
  * @class ThreadBase
  * @brief Base class for threading support
@@ -30,7 +34,7 @@ class ThreadBase {
         Joined       ///< Indicates that thread has been successfully joined
     };
 public:
-    ThreadBase() : state(State::Created) { }
+    ThreadBase() : state(State::Created), wakeCondition(Condition::create()), workPending(false) { }
 
     /**
      * @brief Stops and joins the thread.
@@ -61,7 +65,7 @@ public:
         if (!threadStarted.test_and_set(std::memory_order_relaxed))
         {
             state.store(State::Running, std::memory_order_release);
-            thread = std::thread(&ThreadBase::threadLoop, this);
+            launchThread();
         }
     }
 
@@ -69,7 +73,10 @@ public:
      * @brief Sets the state to State::Stopped.
      */
     virtual void stopThread()
-    { state.store(State::Stopped, std::memory_order_relaxed); }
+    {
+        state.store(State::Stopped, std::memory_order_relaxed);
+        wakeCondition->notify_all();
+    }
 
     /**
      * @brief Joins the thread to release resources.
@@ -99,6 +106,25 @@ public:
         }
     }
 
+    /**
+     * @brief Sets how the thread waits when it has no work.
+     *
+     * Must be called before startThread()
+     */
+    void setWaitStrategy(const WaitStrategy& strategy)
+    { waitStrategy = strategy; }
+
+    /**
+     * @brief Wakes the thread up if it waits for work in threadLoop
+     *
+     * With default hasWork() it makes threadLoop call threadIteration() once more.
+     */
+    void wakeThread()
+    {
+        workPending.store(true, std::memory_order_release);
+        wakeCondition->notify_one();
+    }
+
     /**
      * @return true if thread state is Created
      */
@@ -131,6 +157,15 @@ public:
 
 protected:
 
+    /**
+     * @brief Starts executing threadFunction, called by startThread()
+     *
+     * Default implementation creates the OS thread. Logical threads that are
+     * scheduled onto threads of a shared pool override it to start without one.
+     */
+    virtual void launchThread()
+    { thread = std::thread(&ThreadBase::threadFunction, this); }
+
     /**
      * @brief The function that will be run by thread.
      *
@@ -163,6 +198,14 @@ protected:
             if (isStopped())
                 break;
 
+            if (!hasWork())
+            {
+                waitForWork();
+                continue;
+            }
+
+            // Wakeups arriving during the iteration are kept for the next one
+            workPending.store(false, std::memory_order_relaxed);
             threadIteration();
         }
     }
@@ -171,6 +214,44 @@ protected:
      */
     virtual void threadIteration() {};
 
+    /**
+     * @brief Tells threadLoop whether threadIteration() has something to do.
+     *
+     * If it returns false the thread waits in waitForWork() until it returns true.
+     * With WaitPolicy::SpinPark and WaitPolicy::Block whoever makes work
+     * available must call wakeThread().
+     * Default implementation returns true if wakeThread() has been called since
+     * the last iteration began. A thread pacing itself in threadIteration()
+     * overrides it to return true, so the iteration is called continuously.
+     */
+    virtual bool hasWork()
+    { return workPending.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Waits according to the WaitStrategy until hasWork() returns true or the thread is stopped
+     *
+     * A thread whose work becomes due at a known time overrides it
+     * with waitForWorkUntil(), see TaskThread.
+     */
+    virtual void waitForWork()
+    { waitStrategy.wait(*wakeCondition, WAKE_IF(hasWork() || !isRunning())); }
+
+    /**
+     * @brief Like waitForWork(), but returns at @p deadline at the latest
+     */
+    void waitForWorkUntil(std::chrono::steady_clock::time_point deadline)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (deadline > now)
+            waitStrategy.waitFor(*wakeCondition, deadline - now, WAKE_IF(hasWork() || !isRunning()));
+    }
+
+    /**
+     * @return WaitStrategy that thread must use when it waits for work
+     */
+    WaitStrategy& getWaitStrategy() noexcept
+    { return waitStrategy; }
+
     /**
      * @brief Sets the state to State::Failed.
      *
@@ -190,6 +271,12 @@ private:
     std::atomic_flag threadJoined = ATOMIC_FLAG_INIT;
     /// The state of the thread
     std::atomic<State> state;
+    /// Condition to wait on in threadLoop when there is no work
+    Condition::SPtr wakeCondition;
+    /// How to wait when there is no work
+    WaitStrategy waitStrategy;
+    /// Set by wakeThread(), read by default hasWork()
+    std::atomic<bool> workPending;
 };
 
 
@@ -6,19 +6,26 @@
 #define THREADING_THREADPOOLHANDLERBASE_H
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
+#include "utils/WaitStrategy.h"
+
 template<typename _ThreadType>
 class ThreadPoolBase {
 public:
     typedef _ThreadType ThreadType;
     typedef std::shared_ptr<ThreadType> ThreadTypePtr;
 
+    /**
+     * Every thread is constructed from copies of @p __args,
+     * so they can not be moved into the first one
+     */
     template<typename... Args>
-    explicit ThreadPoolBase(unsigned int poolSize, Args&&... __args)
+    explicit ThreadPoolBase(unsigned int poolSize, const Args&... __args)
     {
-        for (int i = 0; i < poolSize; i++)
-            threads.push_back(std::make_shared<ThreadType>(std::forward<Args>(__args)...));
+        for (unsigned int i = 0; i < poolSize; i++)
+            threads.push_back(std::make_shared<ThreadType>(__args...));
     }
     virtual ~ThreadPoolBase() = default;
 
@@ -33,6 +40,8 @@ public:
      */
     virtual void startThreads()
     {
+        std::lock_guard<std::mutex> lock(threadsMutex);
+        started = true;
         for (const auto& thread : threads)
             thread->startThread();
     }
@@ -42,21 +51,95 @@ public:
      */
     virtual void stopThreads()
     {
+        std::lock_guard<std::mutex> lock(threadsMutex);
+        started = false;
         for (const auto& thread : threads)
             thread->stopThread();
     }
 
+    /**
+     * Sets wait strategy of all threads in thread pool,
+     * must be called before startThreads()
+     */
+    virtual void setWaitStrategy(const WaitStrategy& strategy)
+    {
+        std::lock_guard<std::mutex> lock(threadsMutex);
+        waitStrategy = strategy;
+        for (const auto& thread : threads)
+            thread->setWaitStrategy(strategy);
+    }
+
     /**
      * Joins all threads in thread pool
      */
     virtual void joinThreads()
     {
-        for (const auto& thread : threads)
+        std::vector<ThreadTypePtr> toJoin;
+        {
+            std::lock_guard<std::mutex> lock(threadsMutex);
+            toJoin = threads;
+        }
+        for (const auto& thread : toJoin)
             thread->joinThread();
     }
 
+    /**
+     * Adds thread to thread pool, e.g. to replace a stalled one.
+     * Thread is started if the pool is running.
+     * @return added thread
+     */
+    template<typename... Args>
+    ThreadTypePtr addThread(Args&&... __args)
+    {
+        return addConfiguredThread([](ThreadType&) { }, std::forward<Args>(__args)...);
+    }
+
+    /**
+     * Like addThread(), but calls @p configure with the thread before it is started,
+     * e.g. to attach a heartbeat with Watchdog::watchThread()
+     * @return added thread
+     */
+    template<typename Configure, typename... Args>
+    ThreadTypePtr addConfiguredThread(Configure configure, Args&&... __args)
+    {
+        ThreadTypePtr thread = std::make_shared<ThreadType>(std::forward<Args>(__args)...);
+        configure(*thread);
+        std::lock_guard<std::mutex> lock(threadsMutex);
+        thread->setWaitStrategy(waitStrategy);
+        threads.push_back(thread);
+        if (started)
+            thread->startThread();
+        return thread;
+    }
+
+    /**
+     * Calls @p f with every thread in thread pool
+     */
+    template<typename Function>
+    void forEachThread(Function f)
+    {
+        std::lock_guard<std::mutex> lock(threadsMutex);
+        for (const auto& thread : threads)
+            f(thread);
+    }
+
+    /**
+     * @return number of threads in thread pool
+     */
+    size_t getPoolSize() const
+    {
+        std::lock_guard<std::mutex> lock(threadsMutex);
+        return threads.size();
+    }
+
 protected:
     std::vector<ThreadTypePtr> threads;
+    /// Guards threads, which may grow while the pool is running
+    mutable std::mutex threadsMutex;
+
+private:
+    WaitStrategy waitStrategy;
+    bool started = false;
 };
 
 #endif //THREADING_THREADPOOLHANDLERBASE_H
@@ -7,18 +7,33 @@
 
 #include <mutex>
 
-/// @brief Base of thread safe class, this class is inheritable-only
-class ThreadSafeBase {
+#include "utils/LockPolicy.h"
+
+/**
+ * @brief Base of thread safe class, this class is inheritable-only
+ * @tparam _Lock lock type, see LockPolicy.h; classes waiting on
+ *         std::condition_variable, like Condition, need std::mutex
+ */
+template<typename _Lock>
+class ThreadSafeBaseT {
  public:
+    typedef _Lock LockType;
+
     virtual inline void acquireLock() final { mutex.lock(); }
     virtual inline void releaseLock() final { mutex.unlock(); }
-    virtual inline std::mutex& getLock() final { return mutex; }
+    /// Takes the lock for reading, shared with other readers if the lock type allows it
+    virtual inline void acquireSharedLock() final { LockTraits<_Lock>::lockShared(mutex); }
+    virtual inline void releaseSharedLock() final { LockTraits<_Lock>::unlockShared(mutex); }
+    virtual inline _Lock& getLock() final { return mutex; }
  protected:
-    ThreadSafeBase() = default;
-    virtual ~ThreadSafeBase() = default;
+    ThreadSafeBaseT() = default;
+    virtual ~ThreadSafeBaseT() = default;
 
 protected:
-    std::mutex mutex;
+    _Lock mutex;
 };
 
+/// Thread safe base guarded by std::mutex
+typedef ThreadSafeBaseT<std::mutex> ThreadSafeBase;
+
 #endif //THREADING_THREADSAFEBASE_H
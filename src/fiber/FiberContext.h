@@ -0,0 +1,136 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_FIBERCONTEXT_H
+#define THREADING_FIBERCONTEXT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) && !defined(THREADING_FIBER_UCONTEXT)
+
+/*
+ * Saves callee-saved registers of the current context on its stack,
+ * stores stack pointer to *fromSp and restores the context saved at toSp.
+ * Symbols are weak, so every translation unit may emit them.
+ */
+asm(R"(
+    .pushsection .text
+    .weak threading_fiber_switch
+    .type threading_fiber_switch, @function
+    .p2align 4
+threading_fiber_switch:
+    pushq %rbp
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    movq %rsp, (%rdi)
+    movq %rsi, %rsp
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    popq %rbp
+    ret
+    .size threading_fiber_switch, .-threading_fiber_switch
+
+    .weak threading_fiber_trampoline
+    .type threading_fiber_trampoline, @function
+    .p2align 4
+threading_fiber_trampoline:
+    movq %r13, %rdi
+    callq *%r12
+    ud2
+    .size threading_fiber_trampoline, .-threading_fiber_trampoline
+    .popsection
+)");
+
+extern "C" void threading_fiber_switch(void** fromSp, void* toSp);
+extern "C" void threading_fiber_trampoline();
+
+/**
+ * @class FiberContext
+ * @brief Saved execution context of a fiber or of a thread that runs fibers
+ *
+ * On x86-64 only callee-saved registers and the stack pointer are switched,
+ * which costs a few nanoseconds. Other platforms use ucontext, define
+ * THREADING_FIBER_UCONTEXT to force it.
+ */
+class FiberContext {
+public:
+    typedef void (*Entry)(void*);
+
+    /**
+     * @brief Prepares context to call @p entry(@p arg) on the given stack when switched to.
+     *
+     * @p entry must never return, it has to switch to another context instead
+     */
+    void init(void* stackBase, size_t stackSize, Entry entry, void* arg)
+    {
+        uintptr_t top = (reinterpret_cast<uintptr_t>(stackBase) + stackSize) & ~uintptr_t(15);
+        // Return address is placed so that the entry is called with ABI stack alignment
+        void** frame = reinterpret_cast<void**>(top - 8 - 6 * sizeof(void*));
+        frame[0] = nullptr;                                            // r15
+        frame[1] = nullptr;                                            // r14
+        frame[2] = arg;                                                // r13
+        frame[3] = reinterpret_cast<void*>(entry);                     // r12
+        frame[4] = nullptr;                                            // rbx
+        frame[5] = nullptr;                                            // rbp
+        frame[6] = reinterpret_cast<void*>(&threading_fiber_trampoline); // return address
+        sp = frame;
+    }
+
+    /**
+     * @brief Saves current context to @p from and continues with @p to
+     */
+    static void switchTo(FiberContext& from, FiberContext& to)
+    { threading_fiber_switch(&from.sp, to.sp); }
+
+private:
+    void* sp = nullptr;
+};
+
+#else
+
+#include <ucontext.h>
+
+class FiberContext {
+public:
+    typedef void (*Entry)(void*);
+
+    void init(void* stackBase, size_t stackSize, Entry entry, void* arg)
+    {
+        getcontext(&context);
+        context.uc_stack.ss_sp = stackBase;
+        context.uc_stack.ss_size = stackSize;
+        context.uc_link = nullptr;
+        // makecontext() passes int arguments only
+        uintptr_t entryBits = reinterpret_cast<uintptr_t>(entry);
+        uintptr_t argBits = reinterpret_cast<uintptr_t>(arg);
+        makecontext(&context, reinterpret_cast<void (*)()>(&FiberContext::start), 4,
+                    static_cast<unsigned int>(entryBits >> 32), static_cast<unsigned int>(entryBits),
+                    static_cast<unsigned int>(argBits >> 32), static_cast<unsigned int>(argBits));
+    }
+
+    static void switchTo(FiberContext& from, FiberContext& to)
+    { swapcontext(&from.context, &to.context); }
+
+private:
+    static void start(unsigned int entryHigh, unsigned int entryLow,
+                      unsigned int argHigh, unsigned int argLow)
+    {
+        Entry entry = reinterpret_cast<Entry>((uint64_t(entryHigh) << 32) | entryLow);
+        void* arg = reinterpret_cast<void*>((uint64_t(argHigh) << 32) | argLow);
+        entry(arg);
+    }
+
+    ucontext_t context;
+};
+
+#endif
+
+#endif //THREADING_FIBERCONTEXT_H
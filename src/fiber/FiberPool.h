@@ -0,0 +1,355 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_FIBERPOOL_H
+#define THREADING_FIBERPOOL_H
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "FiberContext.h"
+#include "FiberStack.h"
+#include "../ThreadBase.h"
+#include "../ThreadPoolBase.h"
+#include "utils/EventCount.h"
+#include "utils/GuardedDeque.h"
+#include "utils/SPtrFactoryBase.h"
+
+class FiberScheduler;
+
+/**
+ * @class Fiber
+ * @brief Stackful user-mode task, created by FiberPool::spawn()
+ */
+class Fiber {
+    friend class FiberScheduler;
+    friend class FiberWorker;
+public:
+    Fiber(const Fiber&) = delete;
+    Fiber& operator=(const Fiber&) = delete;
+
+    FiberScheduler& getScheduler() const noexcept
+    { return *scheduler; }
+
+private:
+    Fiber(FiberScheduler* scheduler, std::function<void()>&& body)
+            : scheduler(scheduler), body(std::move(body)) { }
+
+    static void main(void* arg);
+
+    FiberScheduler* scheduler;
+    std::function<void()> body;
+    FiberContext context;
+    FiberStack stack;
+    bool finished = false;
+};
+
+/**
+ * @class FiberScheduler
+ * @brief Ready queue and stacks shared by FiberWorker threads
+ *
+ * Fibers may continue on any worker after they are suspended.
+ * A fiber is suspended by switching to the context of its worker, which then
+ * runs the post switch action given to suspend(). Synchronization primitives
+ * publish a suspended fiber to other threads only from that action, so it is
+ * never resumed by another worker while it still runs on its stack.
+ */
+class FiberScheduler : public SPtrFactoryBase<FiberScheduler> {
+    friend class Fiber;
+    friend class FiberWorker;
+public:
+    /// Action run by the worker right after the fiber has switched out
+    typedef void (*PostSwitchAction)(void*);
+
+    explicit FiberScheduler(size_t stackSize = 128 * 1024)
+            : stacks(stackSize), readyCondition(EventCount::create()), liveCount(0) { }
+
+    ~FiberScheduler()
+    {
+        // Fibers which were never run or resumed again
+        while (!ready.empty())
+            destroy(ready.getFront());
+    }
+
+    /**
+     * @brief Creates fiber running @p body, it will be run by one of the workers.
+     *
+     * Exceptions escaping @p body terminate the program, as with std::thread
+     */
+    void spawn(std::function<void()> body)
+    {
+        Fiber* fiber = new Fiber(this, std::move(body));
+        try {
+            fiber->stack = stacks.acquire();
+        } catch (...) {
+            delete fiber;
+            throw;
+        }
+        fiber->context.init(fiber->stack.base, fiber->stack.size, &Fiber::main, fiber);
+        liveCount.fetch_add(1, std::memory_order_relaxed);
+        schedule(fiber);
+    }
+
+    /**
+     * @brief Makes suspended fiber runnable again
+     */
+    void schedule(Fiber* fiber)
+    {
+        ready.pushBack(fiber);
+        readyCondition->notify_one();
+    }
+
+    /**
+     * @brief Suspends the current fiber, @p action(@p arg) is run after it has switched out.
+     *
+     * The action must arrange for schedule() to be called eventually.
+     * Must be called by a fiber.
+     */
+    static void suspend(PostSwitchAction action, void* arg)
+    {
+        ThreadState* state = threadState();
+        Fiber* self = state->current;
+        state->action = action;
+        state->actionArg = arg;
+        FiberContext::switchTo(self->context, state->schedulerContext);
+        // Fiber may continue on another thread here
+    }
+
+    /**
+     * @brief Lets other ready fibers run, yields the thread if called outside of a fiber
+     */
+    static void yield()
+    {
+        Fiber* self = currentFiber();
+        if (!self) {
+            std::this_thread::yield();
+            return;
+        }
+        suspend([](void* arg) {
+            Fiber* fiber = static_cast<Fiber*>(arg);
+            fiber->scheduler->schedule(fiber);
+        }, self);
+    }
+
+    /**
+     * @return fiber running on the calling thread, nullptr if it is not a fiber
+     */
+    static Fiber* currentFiber()
+    { return threadState()->current; }
+
+    static bool inFiber()
+    { return currentFiber() != nullptr; }
+
+    /**
+     * @return number of fibers which were spawned and have not finished yet
+     */
+    size_t getFiberCount() const
+    { return liveCount.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Blocks the calling thread until all fibers have finished, must not be called by a fiber
+     */
+    void waitForFibers()
+    { idleCondition.wait(WAKE_IF(getFiberCount() == 0)); }
+
+    EventCount::SPtr getReadyCondition() const
+    { return readyCondition; }
+
+private:
+    struct ThreadState {
+        FiberContext schedulerContext;
+        Fiber* current = nullptr;
+        PostSwitchAction action = nullptr;
+        void* actionArg = nullptr;
+    };
+
+    /*
+     * Fibers migrate between threads, the address of a thread local
+     * must not be cached by the compiler across a context switch
+     */
+    __attribute__((noinline)) static ThreadState* threadState()
+    {
+        static thread_local ThreadState state;
+        ThreadState* result = &state;
+        asm volatile("" : "+r"(result) : : "memory");
+        return result;
+    }
+
+    Fiber* takeReady()
+    {
+        try {
+            return ready.getFront();
+        } catch (std::runtime_error& e) {
+            return nullptr;
+        }
+    }
+
+    /*
+     * Runs fiber on the calling worker until it suspends or finishes
+     */
+    void run(Fiber* fiber)
+    {
+        ThreadState* state = threadState();
+        state->current = fiber;
+        FiberContext::switchTo(state->schedulerContext, fiber->context);
+        state->current = nullptr;
+
+        if (fiber->finished) {
+            destroy(fiber);
+            if (liveCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                idleCondition.notify_all();
+            return;
+        }
+        if (state->action) {
+            PostSwitchAction action = state->action;
+            state->action = nullptr;
+            action(state->actionArg);
+        }
+    }
+
+    void destroy(Fiber* fiber)
+    {
+        stacks.release(fiber->stack);
+        delete fiber;
+    }
+
+    FiberStackPool stacks;
+    GuardedDeque<Fiber*> ready;
+    EventCount::SPtr readyCondition;
+    EventCount idleCondition;
+    std::atomic<size_t> liveCount;
+};
+
+inline void Fiber::main(void* arg)
+{
+    Fiber* self = static_cast<Fiber*>(arg);
+    try {
+        self->body();
+    } catch (...) {
+        std::terminate();
+    }
+    // Captures are destroyed while they can still use the fiber
+    self->body = nullptr;
+    self->finished = true;
+    FiberContext::switchTo(self->context, FiberScheduler::threadState()->schedulerContext);
+}
+
+/**
+ * @class FiberWorker
+ * @brief Thread which runs ready fibers of a FiberScheduler
+ */
+class FiberWorker : public ThreadBase {
+public:
+    explicit FiberWorker(const FiberScheduler::SPtr& scheduler)
+            : scheduler(scheduler), readyCondition(scheduler->getReadyCondition()) { }
+
+    ~FiberWorker() override
+    {
+        stopThread();
+        joinThread();
+    }
+
+    void stopThread() override
+    {
+        ThreadBase::stopThread();
+        readyCondition->notify_all();
+    }
+
+private:
+    void threadFunction() override
+    {
+        beforeThreadLoop();
+        while (isRunning())
+        {
+            if (scheduler->ready.empty())
+            {
+                getWaitStrategy().wait(*readyCondition,
+                            WAKE_IF(!scheduler->ready.empty() || isStopped()));
+            }
+
+            if (isStopped())
+                break;
+
+            Fiber* fiber = scheduler->takeReady();
+            if (fiber)
+                scheduler->run(fiber);
+        }
+        afterThreadLoop();
+    }
+
+    FiberScheduler::SPtr scheduler;
+    EventCount::SPtr readyCondition;
+};
+
+/**
+ * @class FiberPool
+ * @brief Runs many fibers on a fixed number of threads (M:N)
+ *
+ * A fiber which waits on FiberMutex, FiberCondition or fiberGetResult()
+ * is suspended and its thread runs other fibers meanwhile, so thousands of
+ * blocking handlers need only as many threads as there are cores.
+ * Blocking a fiber with OS primitives blocks its whole worker.
+ * All fibers must finish before the pool is destroyed, fibers which are still
+ * suspended then are leaked.
+ * Queries of a QueryWorker can be handled in fibers with FiberQueryHandler.
+ *
+ * A fiber may resume on another worker after every suspension point
+ * (FiberMutex::lock(), FiberCondition::wait(), fiberGetResult(), yield()), hence:
+ * - do not suspend inside a catch block: the exception being handled is kept per
+ *   thread by the C++ runtime, so after resuming elsewhere std::current_exception()
+ *   and a bare rethrow refer to another thread's exception. Take the exception with
+ *   std::current_exception(), leave the catch block, then suspend;
+ * - do not keep values or addresses of thread_local variables across a suspension
+ *   point, they may belong to the previous thread; read them again after resuming.
+ */
+class FiberPool : public ThreadPoolBase<FiberWorker> {
+    typedef ThreadPoolBase<FiberWorker> Base;
+public:
+    /**
+     * @param stackSize usable stack size of every fiber
+     */
+    explicit FiberPool(unsigned int poolSize, size_t stackSize = 128 * 1024)
+            : FiberPool(poolSize, FiberScheduler::create(stackSize)) { }
+
+    ~FiberPool() override
+    {
+        stopThreads();
+        joinThreads();
+    }
+
+    void stopThreads() override
+    {
+        Base::stopThreads();
+        scheduler->getReadyCondition()->notify_all();
+    }
+
+    /**
+     * @sa FiberScheduler::spawn
+     */
+    void spawn(std::function<void()> body)
+    { scheduler->spawn(std::move(body)); }
+
+    size_t getFiberCount() const
+    { return scheduler->getFiberCount(); }
+
+    /**
+     * @sa FiberScheduler::waitForFibers
+     */
+    void waitForFibers()
+    { scheduler->waitForFibers(); }
+
+    FiberScheduler::SPtr getScheduler() const
+    { return scheduler; }
+
+private:
+    FiberPool(unsigned int poolSize, const FiberScheduler::SPtr& scheduler)
+            : Base(poolSize, scheduler), scheduler(scheduler) { }
+
+    FiberScheduler::SPtr scheduler;
+};
+
+#endif //THREADING_FIBERPOOL_H
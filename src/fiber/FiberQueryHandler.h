@@ -0,0 +1,68 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_FIBERQUERYHANDLER_H
+#define THREADING_FIBERQUERYHANDLER_H
+
+#include <exception>
+#include <memory>
+#include <utility>
+
+#include "FiberPool.h"
+
+/**
+ * @class FiberQueryHandler
+ * @brief Handler policy of QueryWorker which handles every query in its own fiber
+ *
+ * The worker thread only takes queries and spawns fibers, @p _Handler runs in
+ * the fibers on the workers of the scheduler, so it may block on FiberMutex,
+ * FiberCondition or fiberGetResult() without blocking the queue:
+ * @code
+ * FiberPool fibers(4);
+ * QueryWorker<QueryQueueBase<MyQuery>, FiberQueryHandler<MyHandler>> worker(
+ *         queue, FiberQueryHandler<MyHandler>(fibers.getScheduler()));
+ * @endcode
+ * One handler is shared by all fibers and by all copies of the policy, e.g.
+ * the threads of a pool, so it is called concurrently and must be thread safe.
+ * Exceptions escaping the handler complete the query with them.
+ * The worker's arena is not passed, the query outlives the worker's iteration,
+ * and queues which track processing, e.g. KeyedStrandQueue, must not be used:
+ * the worker reports a query processed as soon as its fiber is spawned.
+ * The fibers' pool must outlive the worker, queries still in fibers are
+ * completed after the worker is stopped.
+ * @tparam _Handler functor with @code void operator()(QueryTypePtr query) @endcode
+ */
+template<typename _Handler>
+class FiberQueryHandler {
+public:
+    explicit FiberQueryHandler(const FiberScheduler::SPtr& scheduler, _Handler handler = _Handler())
+            : scheduler(scheduler), handler(std::make_shared<_Handler>(std::move(handler))) { }
+
+    template<typename _QueryTypePtr>
+    void operator()(_QueryTypePtr query)
+    {
+        std::shared_ptr<_Handler> target(handler);
+        try {
+            scheduler->spawn([target, query] {
+                try {
+                    (*target)(query);
+                } catch (...) {
+                    query->trySetException(std::current_exception());
+                }
+            });
+        } catch (...) {
+            // No memory for the fiber stack
+            query->trySetException(std::current_exception());
+        }
+    }
+
+    _Handler& getHandler() noexcept
+    { return *handler; }
+
+private:
+    FiberScheduler::SPtr scheduler;
+    std::shared_ptr<_Handler> handler;
+};
+
+#endif //THREADING_FIBERQUERYHANDLER_H
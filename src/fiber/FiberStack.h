@@ -0,0 +1,110 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_FIBERSTACK_H
+#define THREADING_FIBERSTACK_H
+
+#include <cerrno>
+#include <mutex>
+#include <system_error>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * @struct FiberStack
+ * @brief Stack memory usable by a fiber, guard page is not included
+ */
+struct FiberStack {
+    void* base = nullptr;
+    size_t size = 0;
+};
+
+/**
+ * @class FiberStackPool
+ * @brief Allocates fiber stacks with a guard page and reuses released ones
+ *
+ * Every stack is a separate mapping with an inaccessible page below it,
+ * so a stack overflow faults instead of corrupting memory.
+ * Up to maxCached released stacks are kept for reuse, so creating a fiber
+ * does not cost mmap() and page faults in a steady state.
+ */
+class FiberStackPool {
+public:
+    /**
+     * @param stackSize usable stack size, rounded up to whole pages
+     * @param maxCached maximal number of released stacks kept for reuse
+     */
+    explicit FiberStackPool(size_t stackSize = 128 * 1024, size_t maxCached = 1024)
+            : pageSize(static_cast<size_t>(::sysconf(_SC_PAGESIZE)))
+            , stackSize((stackSize + pageSize - 1) / pageSize * pageSize)
+            , maxCached(maxCached) { }
+
+    ~FiberStackPool()
+    {
+        for (const FiberStack& stack : cached)
+            unmap(stack);
+    }
+
+    FiberStackPool(const FiberStackPool&) = delete;
+    FiberStackPool& operator=(const FiberStackPool&) = delete;
+
+    /**
+     * @throws std::system_error if memory can not be mapped
+     */
+    FiberStack acquire()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!cached.empty()) {
+                FiberStack stack = cached.back();
+                cached.pop_back();
+                return stack;
+            }
+        }
+
+        void* memory = ::mmap(nullptr, stackSize + pageSize, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+        if (memory == MAP_FAILED)
+            throw std::system_error(errno, std::system_category(), "fiber stack mmap");
+        // Stacks grow down, the guard page is the lowest one
+        if (::mprotect(memory, pageSize, PROT_NONE) < 0) {
+            int error = errno;
+            ::munmap(memory, stackSize + pageSize);
+            throw std::system_error(error, std::system_category(), "fiber stack mprotect");
+        }
+        FiberStack stack;
+        stack.base = static_cast<char*>(memory) + pageSize;
+        stack.size = stackSize;
+        return stack;
+    }
+
+    void release(const FiberStack& stack)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (cached.size() < maxCached) {
+                cached.push_back(stack);
+                return;
+            }
+        }
+        unmap(stack);
+    }
+
+    size_t getStackSize() const noexcept
+    { return stackSize; }
+
+private:
+    void unmap(const FiberStack& stack)
+    { ::munmap(static_cast<char*>(stack.base) - pageSize, stack.size + pageSize); }
+
+    const size_t pageSize;
+    const size_t stackSize;
+    const size_t maxCached;
+    std::mutex mutex;
+    std::vector<FiberStack> cached;
+};
+
+#endif //THREADING_FIBERSTACK_H
@@ -0,0 +1,263 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_FIBERSYNC_H
+#define THREADING_FIBERSYNC_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include "FiberPool.h"
+#include "utils/WaitStrategy.h"
+
+/**
+ * @class FiberWaiter
+ * @brief One shot wake up of a fiber or a thread
+ *
+ * Created on the stack of the waiting side. wait() suspends the fiber
+ * (or blocks the thread if it is not a fiber) until notify() is called,
+ * notify() may be called before wait().
+ */
+class FiberWaiter {
+public:
+    FiberWaiter() : fiber(FiberScheduler::currentFiber()), state(Waiting) { }
+
+    FiberWaiter(const FiberWaiter&) = delete;
+    FiberWaiter& operator=(const FiberWaiter&) = delete;
+
+    void wait()
+    {
+        if (fiber) {
+            if (state.load(std::memory_order_acquire) != Notified)
+                FiberScheduler::suspend(&FiberWaiter::park, this);
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return state.load(std::memory_order_relaxed) == Notified; });
+    }
+
+    /**
+     * @brief Wakes the waiting side, the waiter may be destroyed as soon as it returns
+     */
+    void notify()
+    {
+        if (fiber) {
+            Fiber* waiting = fiber;
+            if (state.exchange(Notified, std::memory_order_acq_rel) == Parked)
+                waiting->getScheduler().schedule(waiting);
+            return;
+        }
+        // Waiting thread can not return and destroy the waiter until the lock is released
+        std::lock_guard<std::mutex> lock(mutex);
+        state.store(Notified, std::memory_order_relaxed);
+        condition.notify_one();
+    }
+
+    /// Next waiter in a wait list of FiberMutex or FiberCondition
+    FiberWaiter* next = nullptr;
+
+private:
+    enum State { Waiting, Parked, Notified };
+
+    /*
+     * Runs after the fiber has switched out. If notify() came first
+     * the fiber is rescheduled here, otherwise notify() will do it.
+     */
+    static void park(void* arg)
+    {
+        FiberWaiter* self = static_cast<FiberWaiter*>(arg);
+        Fiber* waiting = self->fiber;
+        int expected = Waiting;
+        if (!self->state.compare_exchange_strong(expected, Parked, std::memory_order_acq_rel))
+            waiting->getScheduler().schedule(waiting);
+    }
+
+    Fiber* const fiber;
+    std::atomic<int> state;
+    std::mutex mutex;
+    std::condition_variable condition;
+};
+
+/**
+ * @class FiberWaitList
+ * @brief FIFO list of waiters guarded by a spin lock, held for a few instructions only
+ */
+class FiberWaitList {
+public:
+    void lock() noexcept
+    {
+        while (flag.test_and_set(std::memory_order_acquire))
+            cpuRelax();
+    }
+
+    void unlock() noexcept
+    { flag.clear(std::memory_order_release); }
+
+    /// Must be called with the list locked
+    void push(FiberWaiter* waiter) noexcept
+    {
+        waiter->next = nullptr;
+        if (tail)
+            tail->next = waiter;
+        else
+            head = waiter;
+        tail = waiter;
+    }
+
+    /// Must be called with the list locked, returns nullptr if empty
+    FiberWaiter* pop() noexcept
+    {
+        FiberWaiter* waiter = head;
+        if (waiter) {
+            head = waiter->next;
+            if (!head)
+                tail = nullptr;
+        }
+        return waiter;
+    }
+
+    /// Must be called with the list locked
+    FiberWaiter* popAll() noexcept
+    {
+        FiberWaiter* waiters = head;
+        head = tail = nullptr;
+        return waiters;
+    }
+
+private:
+    std::atomic_flag flag = ATOMIC_FLAG_INIT;
+    FiberWaiter* head = nullptr;
+    FiberWaiter* tail = nullptr;
+};
+
+/**
+ * @class FiberMutex
+ * @brief Mutex which suspends the waiting fiber instead of blocking its thread
+ *
+ * Satisfies Lockable, so it works with std::lock_guard and std::unique_lock.
+ * Ownership is handed to waiters in FIFO order. Threads which are not fibers
+ * may use it too, they block.
+ */
+class FiberMutex {
+public:
+    FiberMutex() = default;
+    FiberMutex(const FiberMutex&) = delete;
+    FiberMutex& operator=(const FiberMutex&) = delete;
+
+    void lock()
+    {
+        waiters.lock();
+        if (!locked) {
+            locked = true;
+            waiters.unlock();
+            return;
+        }
+        FiberWaiter waiter;
+        waiters.push(&waiter);
+        waiters.unlock();
+        // unlock() passes ownership to us
+        waiter.wait();
+    }
+
+    bool try_lock()
+    {
+        std::lock_guard<FiberWaitList> guard(waiters);
+        if (locked)
+            return false;
+        locked = true;
+        return true;
+    }
+
+    void unlock()
+    {
+        waiters.lock();
+        FiberWaiter* next = waiters.pop();
+        if (!next)
+            locked = false;
+        waiters.unlock();
+        if (next)
+            next->notify();
+    }
+
+private:
+    FiberWaitList waiters;
+    bool locked = false;
+};
+
+/**
+ * @class FiberCondition
+ * @brief Condition variable which suspends the waiting fiber instead of blocking its thread
+ *
+ * Works with any lock, normally std::unique_lock<FiberMutex>.
+ */
+class FiberCondition {
+public:
+    FiberCondition() = default;
+    FiberCondition(const FiberCondition&) = delete;
+    FiberCondition& operator=(const FiberCondition&) = delete;
+
+    template<typename Lock>
+    void wait(Lock& lock)
+    {
+        FiberWaiter waiter;
+        waiters.lock();
+        waiters.push(&waiter);
+        waiters.unlock();
+        lock.unlock();
+        waiter.wait();
+        lock.lock();
+    }
+
+    template<typename Lock, typename Predicate>
+    void wait(Lock& lock, Predicate p)
+    {
+        while (!p())
+            wait(lock);
+    }
+
+    void notify_one()
+    {
+        waiters.lock();
+        FiberWaiter* waiter = waiters.pop();
+        waiters.unlock();
+        if (waiter)
+            waiter->notify();
+    }
+
+    void notify_all()
+    {
+        waiters.lock();
+        FiberWaiter* waiter = waiters.popAll();
+        waiters.unlock();
+        while (waiter) {
+            // Waiter may be destroyed by notify()
+            FiberWaiter* next = waiter->next;
+            waiter->notify();
+            waiter = next;
+        }
+    }
+
+private:
+    FiberWaitList waiters;
+};
+
+/**
+ * @brief Fiber-aware QueryBase::getResult()
+ *
+ * Called by a fiber, suspends it until the query is completed, so its thread
+ * runs other fibers meanwhile. Called by other threads, it is getResult().
+ */
+template<typename _QueryTypePtr>
+auto fiberGetResult(const _QueryTypePtr& query) -> decltype(query->getResult())
+{
+    if (FiberScheduler::inFiber()) {
+        FiberWaiter waiter;
+        query->addCompletionHandler([&waiter] { waiter.notify(); });
+        waiter.wait();
+    }
+    return query->getResult();
+}
+
+#endif //THREADING_FIBERSYNC_H
@@ -0,0 +1,159 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_ASYNCIOSERVICE_H
+#define THREADING_ASYNCIOSERVICE_H
+
+#include <memory>
+#include <system_error>
+#include <vector>
+
+#include "IoQuery.h"
+#include "QueryThreadIoUring.h"
+#include "query_thread/QueryThreadPool.h"
+#include "query_thread/QueryThreadPoolThread.h"
+
+/**
+ * @class BlockingIoWorker
+ * @brief Pool thread which performs IoQuery with blocking syscalls
+ */
+class BlockingIoWorker : public QueryThreadPoolThread<IoQuery> {
+public:
+    explicit BlockingIoWorker(const QueueTypePtr& queue)
+            : QueryThreadPoolThread<IoQuery>(queue) { }
+
+protected:
+    void onQuery(QueryTypePtr query) override
+    { query->complete(query->performBlocking()); }
+};
+
+/**
+ * @class AsyncIoService
+ * @brief File I/O executor which uses io_uring when possible
+ *
+ * Creates QueryThreadIoUring, or a pool of BlockingIoWorker threads if
+ * io_uring is not supported by the kernel or not permitted (e.g. by seccomp).
+ * Queries behave the same in both modes, registered buffer indices are
+ * ignored by the blocking pool.
+ */
+class AsyncIoService {
+public:
+    typedef IoQuery QueryType;
+    typedef std::shared_ptr<IoQuery> QueryTypePtr;
+    typedef IoQuery::ResultType ResultType;
+
+    /**
+     * @param entries io_uring submission queue size
+     * @param fallbackThreads size of the blocking pool used without io_uring
+     */
+    explicit AsyncIoService(unsigned int entries = 256, unsigned int fallbackThreads = 4)
+    {
+#ifdef THREADING_HAS_IO_URING
+        try {
+            uring.reset(new QueryThreadIoUring(entries));
+            return;
+        } catch (const std::system_error& e) {
+            // io_uring is unavailable, use blocking pool
+        }
+#endif
+        pool.reset(new QueryThreadPool<BlockingIoWorker>(
+                fallbackThreads, std::make_shared<QueryQueueBase<IoQuery>>()));
+    }
+
+    ~AsyncIoService()
+    {
+        stopThreads();
+        joinThreads();
+    }
+
+    AsyncIoService(const AsyncIoService&) = delete;
+    AsyncIoService& operator=(const AsyncIoService&) = delete;
+
+    /**
+     * @return true if queries are executed by io_uring
+     */
+    bool usesIoUring() const noexcept
+    {
+#ifdef THREADING_HAS_IO_URING
+        return uring != nullptr;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Registers buffers for IoQuery buffer indices, must be called before startThreads()
+     */
+    void registerBuffers(const std::vector<iovec>& buffers)
+    {
+#ifdef THREADING_HAS_IO_URING
+        if (uring)
+            uring->registerBuffers(buffers);
+#endif
+    }
+
+    void startThreads()
+    {
+#ifdef THREADING_HAS_IO_URING
+        if (uring) {
+            uring->startThread();
+            return;
+        }
+#endif
+        pool->startThreads();
+    }
+
+    void stopThreads()
+    {
+#ifdef THREADING_HAS_IO_URING
+        if (uring) {
+            uring->stopThread();
+            return;
+        }
+#endif
+        pool->stopThreads();
+    }
+
+    void joinThreads()
+    {
+#ifdef THREADING_HAS_IO_URING
+        if (uring) {
+            uring->joinThread();
+            return;
+        }
+#endif
+        pool->joinThreads();
+    }
+
+    PushStatus putQuery(const QueryTypePtr& query)
+    {
+#ifdef THREADING_HAS_IO_URING
+        if (uring)
+            return uring->putQuery(query);
+#endif
+        return pool->putQuery(query);
+    }
+
+    template<typename... _Args>
+    QueryTypePtr emplaceQuery(_Args&&... __args)
+    {
+        QueryTypePtr query = std::make_shared<IoQuery>(std::forward<_Args>(__args)...);
+        PushStatus status = putQuery(query);
+        if (status == PushStatus::Rejected || status == PushStatus::TimedOut)
+            query->setOverloaded();
+        return query;
+    }
+
+    template<typename... _Args>
+    ResultType emplaceQueryAndGetResult(_Args&&... __args)
+    { return emplaceQuery(std::forward<_Args>(__args)...)->getResult(); }
+
+private:
+#ifdef THREADING_HAS_IO_URING
+    std::unique_ptr<QueryThreadIoUring> uring;
+#endif
+    std::unique_ptr<QueryThreadPool<BlockingIoWorker>> pool;
+};
+
+#endif //THREADING_ASYNCIOSERVICE_H
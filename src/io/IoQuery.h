@@ -0,0 +1,124 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_IOQUERY_H
+#define THREADING_IOQUERY_H
+
+#include <cerrno>
+#include <system_error>
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "query_thread/QueryBase.h"
+
+/**
+ * @enum IoOp
+ * @brief File operation performed by IoQuery
+ */
+enum class IoOp {
+    Read,      ///< pread() into the buffer
+    Write,     ///< pwrite() from the buffer
+    Fsync,     ///< fsync() the file
+    Fdatasync  ///< fdatasync() the file
+};
+
+/**
+ * @class IoQuery
+ * @brief Positional read, write or sync of a file descriptor
+ *
+ * Result is the number of bytes transferred, as returned by pread()/pwrite(),
+ * 0 for syncs. Failures complete the query with std::system_error.
+ * The buffer and the descriptor must stay valid until the query is completed.
+ */
+class IoQuery : public QueryBase<ssize_t> {
+public:
+    /**
+     * @param bufferIndex index of the registered buffer containing @p buffer,
+     *        -1 if the buffer is not registered
+     */
+    IoQuery(IoOp op, int fd, void* buffer = nullptr, size_t length = 0,
+            off_t offset = 0, int bufferIndex = -1)
+            : op(op), fd(fd), offset(offset), bufferIndex(bufferIndex)
+    {
+        vector.iov_base = buffer;
+        vector.iov_len = length;
+    }
+
+    IoOp getOp() const noexcept
+    { return op; }
+
+    int getFd() const noexcept
+    { return fd; }
+
+    void* getBuffer() const noexcept
+    { return vector.iov_base; }
+
+    size_t getLength() const noexcept
+    { return vector.iov_len; }
+
+    off_t getOffset() const noexcept
+    { return offset; }
+
+    int getBufferIndex() const noexcept
+    { return bufferIndex; }
+
+    /**
+     * @return the buffer as a single element vector for vectored submissions
+     */
+    const iovec* getIovec() const noexcept
+    { return &vector; }
+
+    /**
+     * @brief Performs the operation with a blocking syscall
+     * @return syscall result, -errno on failure
+     */
+    ssize_t performBlocking() const
+    {
+        ssize_t result;
+        do {
+            switch (op) {
+            case IoOp::Read:
+                result = ::pread(fd, vector.iov_base, vector.iov_len, offset);
+                break;
+            case IoOp::Write:
+                result = ::pwrite(fd, vector.iov_base, vector.iov_len, offset);
+                break;
+            case IoOp::Fsync:
+                result = ::fsync(fd);
+                break;
+            case IoOp::Fdatasync:
+                result = ::fdatasync(fd);
+                break;
+            default:
+                errno = EINVAL;
+                result = -1;
+                break;
+            }
+        } while (result < 0 && errno == EINTR);
+        return result < 0 ? -errno : result;
+    }
+
+    /**
+     * @brief Completes the query with syscall style @p result, negative values are -errno
+     */
+    void complete(ssize_t result)
+    {
+        if (result < 0)
+            setException(std::make_exception_ptr(
+                    std::system_error(static_cast<int>(-result), std::system_category(), "file io")));
+        else
+            setResult(result);
+    }
+
+private:
+    const IoOp op;
+    const int fd;
+    const off_t offset;
+    const int bufferIndex;
+    iovec vector;
+};
+
+#endif //THREADING_IOQUERY_H
@@ -0,0 +1,215 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_IOURING_H
+#define THREADING_IOURING_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define THREADING_HAS_IO_URING 1
+#endif
+#endif
+
+#ifdef THREADING_HAS_IO_URING
+
+/**
+ * @class IoUring
+ * @brief Minimal io_uring submission and completion ring on raw syscalls
+ *
+ * Only one thread may use the ring. Typical cycle is getSqe() for every
+ * operation, submitAndWait() and reap().
+ */
+class IoUring {
+public:
+    /**
+     * @param entries submission queue size, rounded up to a power of two by the kernel
+     * @throws std::system_error if io_uring is unavailable, e.g. ENOSYS or EPERM
+     */
+    explicit IoUring(unsigned int entries)
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0)
+            throw std::system_error(errno, std::system_category(), "io_uring_setup");
+
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMmap)
+            sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+        sqRing = map(sqRingSize, IORING_OFF_SQ_RING);
+        cqRing = singleMmap ? sqRing : map(cqRingSize, IORING_OFF_CQ_RING);
+        sqes = static_cast<io_uring_sqe*>(map(sqesSize, IORING_OFF_SQES));
+
+        char* sq = static_cast<char*>(sqRing);
+        sqHead = reinterpret_cast<unsigned int*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+        sqEntries = params.sq_entries;
+        // Slots are always submitted in order, so the index array is an identity map
+        unsigned int* array = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+        for (unsigned int i = 0; i < sqEntries; i++)
+            array[i] = i;
+
+        char* cq = static_cast<char*>(cqRing);
+        cqHead = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        cqEntries = params.cq_entries;
+
+        localTail = *sqTail;
+        submittedTail = localTail;
+    }
+
+    ~IoUring()
+    {
+        unmap();
+        ::close(fd);
+    }
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    /**
+     * @return zeroed submission entry or nullptr if the submission queue is full
+     */
+    io_uring_sqe* getSqe()
+    {
+        if (getFreeCount() == 0)
+            return nullptr;
+        io_uring_sqe* sqe = &sqes[localTail & sqMask];
+        std::memset(sqe, 0, sizeof(*sqe));
+        localTail++;
+        return sqe;
+    }
+
+    /**
+     * @return number of entries getSqe() can return before the queue is full
+     */
+    unsigned int getFreeCount() const noexcept
+    { return sqEntries - (localTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE)); }
+
+    /**
+     * @return number of entries taken with getSqe() and not submitted yet
+     */
+    unsigned int getPendingCount() const noexcept
+    { return localTail - submittedTail; }
+
+    /**
+     * @brief Submits pending entries and waits for at least @p waitCount completions
+     * @return number of submitted entries or -errno, e.g. -EINTR
+     */
+    int submitAndWait(unsigned int waitCount)
+    {
+        unsigned int pending = getPendingCount();
+        __atomic_store_n(sqTail, localTail, __ATOMIC_RELEASE);
+        unsigned int flags = waitCount > 0 ? IORING_ENTER_GETEVENTS : 0;
+        int result = static_cast<int>(::syscall(__NR_io_uring_enter, fd, pending, waitCount,
+                                                flags, nullptr, 0));
+        if (result < 0)
+            return -errno;
+        submittedTail += static_cast<unsigned int>(result);
+        return result;
+    }
+
+    /**
+     * @brief Calls @p handler(user_data, res) for every available completion
+     * @return number of completions handled
+     */
+    template<typename _Handler>
+    unsigned int reap(_Handler handler)
+    {
+        unsigned int head = *cqHead;
+        unsigned int tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        unsigned int count = 0;
+        for (; head != tail; head++, count++) {
+            const io_uring_cqe& cqe = cqes[head & cqMask];
+            handler(cqe.user_data, cqe.res);
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+    /**
+     * @brief Registers buffers for IORING_OP_READ_FIXED and IORING_OP_WRITE_FIXED
+     * @throws std::system_error if registration fails, e.g. because of RLIMIT_MEMLOCK
+     */
+    void registerBuffers(const iovec* buffers, unsigned int count)
+    {
+        if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, buffers, count) < 0)
+            throw std::system_error(errno, std::system_category(), "io_uring_register");
+    }
+
+    unsigned int getSqEntries() const noexcept
+    { return sqEntries; }
+
+    unsigned int getCqEntries() const noexcept
+    { return cqEntries; }
+
+private:
+    void* map(size_t size, off_t offset)
+    {
+        void* result = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+        if (result == MAP_FAILED) {
+            int error = errno;
+            unmap();
+            ::close(fd);
+            throw std::system_error(error, std::system_category(), "io_uring mmap");
+        }
+        return result;
+    }
+
+    void unmap()
+    {
+        if (sqes)
+            ::munmap(sqes, sqesSize);
+        if (cqRing && !singleMmap)
+            ::munmap(cqRing, cqRingSize);
+        if (sqRing)
+            ::munmap(sqRing, sqRingSize);
+    }
+
+    int fd = -1;
+    bool singleMmap = false;
+    void* sqRing = nullptr;
+    void* cqRing = nullptr;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqRingSize = 0;
+    size_t cqRingSize = 0;
+    size_t sqesSize = 0;
+
+    unsigned int* sqHead = nullptr;
+    unsigned int* sqTail = nullptr;
+    unsigned int sqMask = 0;
+    unsigned int sqEntries = 0;
+    /// Tail including entries not yet published to the kernel
+    unsigned int localTail = 0;
+    /// Tail up to which the kernel has consumed entries
+    unsigned int submittedTail = 0;
+
+    unsigned int* cqHead = nullptr;
+    unsigned int* cqTail = nullptr;
+    unsigned int cqMask = 0;
+    unsigned int cqEntries = 0;
+    io_uring_cqe* cqes = nullptr;
+};
+
+#endif //THREADING_HAS_IO_URING
+
+#endif //THREADING_IOURING_H
@@ -0,0 +1,242 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_QUERYTHREADIOURING_H
+#define THREADING_QUERYTHREADIOURING_H
+
+#include <cerrno>
+#include <memory>
+#include <vector>
+
+#include <poll.h>
+
+#include "IoUring.h"
+
+#ifdef THREADING_HAS_IO_URING
+
+#include "IoQuery.h"
+#include "query_thread/QueryThreadBase.h"
+#include "query_thread/EventFdQueryQueue.h"
+
+/**
+ * @class QueryThreadIoUring
+ * @brief Single thread which keeps many IoQuery operations in flight with io_uring
+ *
+ * Queued queries are turned into submission entries in batches and submitted
+ * with one io_uring_enter() call, queries are completed when their completion
+ * entries arrive. The thread learns about new queries from a poll request
+ * on the queue eventfd, so it sleeps in io_uring_enter() only.
+ * Queries with a registered buffer index use IORING_OP_READ_FIXED and
+ * IORING_OP_WRITE_FIXED, others use vectored reads and writes.
+ *
+ * On stop the thread waits for operations already submitted to the kernel,
+ * queued queries are cancelled.
+ * If io_uring_enter() fails with anything but a transient error, the thread fails:
+ * queries in flight are completed with that error and queued queries are cancelled.
+ * @throws std::system_error from the constructor if io_uring is unavailable
+ */
+class QueryThreadIoUring : public QueryThreadBase<EventFdQueryQueue<IoQuery>> {
+    typedef QueryThreadBase<EventFdQueryQueue<IoQuery>> Base;
+public:
+    typedef typename Base::QueueType QueueType;
+    typedef typename Base::QueueTypePtr QueueTypePtr;
+    typedef typename Base::QueryType QueryType;
+    typedef typename Base::QueryTypePtr QueryTypePtr;
+    typedef typename Base::ResultType ResultType;
+
+    /**
+     * @param entries submission queue size
+     */
+    explicit QueryThreadIoUring(unsigned int entries = 256) :
+            QueryThreadIoUring(std::make_shared<QueueType>(), entries) { }
+
+    QueryThreadIoUring(const QueueTypePtr& queue, unsigned int entries) :
+            Base(queue), ring(entries)
+    {
+        // One completion entry is kept for the queue poll request
+        inFlight.resize(ring.getCqEntries() - 1);
+        for (unsigned int i = 0; i < inFlight.size(); i++)
+            freeSlots.push_back(static_cast<unsigned int>(inFlight.size()) - i);
+    }
+
+    ~QueryThreadIoUring() override
+    {
+        // Ring must outlive the thread
+        stopThread();
+        joinThread();
+    }
+
+    QueryThreadIoUring(const QueryThreadIoUring&) = delete;
+    QueryThreadIoUring& operator=(const QueryThreadIoUring&) = delete;
+    QueryThreadIoUring(QueryThreadIoUring&& other) = delete;
+    QueryThreadIoUring& operator=(QueryThreadIoUring&& other) = delete;
+
+    void stopThread() override
+    {
+        Base::stopThread();
+        Base::queryQueue->signal();
+    }
+
+    /**
+     * @brief Registers buffers which queries can refer to by index.
+     *
+     * Must be called before startThread()
+     * @throws std::system_error if the kernel refuses to pin the buffers
+     */
+    void registerBuffers(const std::vector<iovec>& buffers)
+    { ring.registerBuffers(buffers.data(), static_cast<unsigned int>(buffers.size())); }
+
+    /**
+     * @return maximal number of operations the thread keeps in flight
+     */
+    size_t getMaxInFlight() const noexcept
+    { return inFlight.size(); }
+
+private:
+    /// user_data of the queue poll request, queries use slot numbers starting with 1
+    enum : uint64_t { pollTag = 0 };
+
+    void threadFunction() override
+    {
+        bool pollArmed = false;
+
+        Base::beforeThreadLoop();
+        while (Base::isRunning())
+        {
+            fillSubmissions();
+            if (!pollArmed)
+                pollArmed = armPoll();
+
+            int result = ring.submitAndWait(1);
+            if (isEnterFailure(result)) {
+                Base::fail();
+                failInFlight(result);
+                break;
+            }
+            ring.reap([&](uint64_t tag, int res) {
+                if (tag == pollTag) {
+                    Base::queryQueue->consumeNotification();
+                    pollArmed = false;
+                } else {
+                    completeSlot(static_cast<unsigned int>(tag), res);
+                }
+            });
+        }
+
+        // Kernel may still write to the buffers of submitted operations
+        while (freeSlots.size() < inFlight.size()) {
+            int result = ring.submitAndWait(1);
+            if (isEnterFailure(result)) {
+                failInFlight(result);
+                break;
+            }
+            ring.reap([&](uint64_t tag, int res) {
+                if (tag != pollTag)
+                    completeSlot(static_cast<unsigned int>(tag), res);
+            });
+        }
+        Base::queryQueue->clear();
+        Base::afterThreadLoop();
+    }
+
+    /*
+     * Moves queued queries to submission entries while there are free slots
+     */
+    void fillSubmissions()
+    {
+        // Keep an entry for the poll request
+        while (freeSlots.size() > 0 && ring.getFreeCount() > 1) {
+            if (Base::queryQueue->isEmpty())
+                break;
+            QueryTypePtr query;
+            try {
+                query = Base::queryQueue->getQuery();
+            } catch (std::runtime_error& e) {
+                break;
+            }
+            io_uring_sqe* sqe = ring.getSqe();
+            unsigned int slot = freeSlots.back();
+            freeSlots.pop_back();
+            prepare(*sqe, *query);
+            sqe->user_data = slot;
+            inFlight[slot - 1] = std::move(query);
+        }
+    }
+
+    bool armPoll()
+    {
+        io_uring_sqe* sqe = ring.getSqe();
+        if (!sqe)
+            return false;
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = Base::queryQueue->getEventFd();
+        sqe->poll_events = POLLIN;
+        sqe->user_data = pollTag;
+        return true;
+    }
+
+    static void prepare(io_uring_sqe& sqe, const IoQuery& query)
+    {
+        sqe.fd = query.getFd();
+        sqe.off = static_cast<uint64_t>(query.getOffset());
+        switch (query.getOp()) {
+        case IoOp::Read:
+        case IoOp::Write: {
+            bool read = query.getOp() == IoOp::Read;
+            if (query.getBufferIndex() >= 0) {
+                sqe.opcode = read ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+                sqe.addr = reinterpret_cast<uint64_t>(query.getBuffer());
+                sqe.len = static_cast<uint32_t>(query.getLength());
+                sqe.buf_index = static_cast<uint16_t>(query.getBufferIndex());
+            } else {
+                sqe.opcode = read ? IORING_OP_READV : IORING_OP_WRITEV;
+                sqe.addr = reinterpret_cast<uint64_t>(query.getIovec());
+                sqe.len = 1;
+            }
+            break;
+        }
+        case IoOp::Fsync:
+            sqe.opcode = IORING_OP_FSYNC;
+            break;
+        case IoOp::Fdatasync:
+            sqe.opcode = IORING_OP_FSYNC;
+            sqe.fsync_flags = IORING_FSYNC_DATASYNC;
+            break;
+        }
+    }
+
+    static bool isEnterFailure(int result) noexcept
+    { return result < 0 && result != -EINTR && result != -EBUSY && result != -EAGAIN; }
+
+    /*
+     * Delivers completions which have already arrived and completes
+     * the rest of queries in flight with -errno of the failed io_uring_enter()
+     */
+    void failInFlight(int error)
+    {
+        ring.reap([&](uint64_t tag, int res) {
+            if (tag != pollTag)
+                completeSlot(static_cast<unsigned int>(tag), res);
+        });
+        for (unsigned int slot = 1; slot <= inFlight.size(); slot++)
+            if (inFlight[slot - 1])
+                completeSlot(slot, error);
+    }
+
+    void completeSlot(unsigned int slot, int res)
+    {
+        QueryTypePtr query = std::move(inFlight[slot - 1]);
+        freeSlots.push_back(slot);
+        query->complete(res);
+    }
+
+    IoUring ring;
+    /// Queries submitted to the kernel, indexed by slot - 1
+    std::vector<QueryTypePtr> inFlight;
+    std::vector<unsigned int> freeSlots;
+};
+
+#endif //THREADING_HAS_IO_URING
+
+#endif //THREADING_QUERYTHREADIOURING_H
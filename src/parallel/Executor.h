@@ -0,0 +1,266 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_EXECUTOR_H
+#define THREADING_EXECUTOR_H
+
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "query_thread/QueryBase.h"
+#include "query_thread/QueryQueueBase.h"
+#include "query_thread/QueryThreadPool.h"
+#include "query_thread/QueryWorker.h"
+#include "utils/UniqueFunction.h"
+
+/**
+ * @class RunnableQuery
+ * @brief Query that carries a function to run
+ *
+ * Queues complete queries they drop with cancel() or setOverloaded(),
+ * which RunnableQuery hides to tell derived queries they will not run.
+ */
+class RunnableQuery : public QueryBase<void> {
+public:
+    explicit RunnableQuery(UniqueFunction<void()> function) : function(std::move(function)) { }
+
+    virtual void run()
+    { function(); }
+
+    void cancel()
+    {
+        if (isCompleted())
+            return;
+        QueryBase<void>::cancel();
+        onDropped(false);
+    }
+
+    void setOverloaded()
+    {
+        if (isCompleted())
+            return;
+        QueryBase<void>::setOverloaded();
+        onDropped(true);
+    }
+
+protected:
+    RunnableQuery() = default;
+
+    /**
+     * @brief Called when the query is dropped instead of being run
+     * @param overloaded true if it is dropped by a full or overloaded queue
+     */
+    virtual void onDropped(bool /*overloaded*/) { }
+
+private:
+    UniqueFunction<void()> function;
+};
+
+/**
+ * @class ExecutorFuture
+ * @brief Result of the function submitted to Executor
+ *
+ * Like std::future, get() can be called once. Future is a thin handle
+ * over the query holding the result, so it is cheap to move.
+ */
+template<typename _ResultType>
+class ExecutorFuture {
+public:
+    typedef _ResultType ResultType;
+    typedef std::shared_ptr<QueryBase<ResultType>> QueryTypePtr;
+
+    ExecutorFuture() = default;
+
+    explicit ExecutorFuture(QueryTypePtr query) : query(std::move(query)) { }
+
+    /**
+     * @return false if the future is default constructed or get() was called
+     */
+    bool valid() const noexcept
+    { return query != nullptr; }
+
+    bool isReady() const noexcept
+    { return query && query->isCompleted(); }
+
+    /**
+     * @brief Waits until the function has returned or thrown
+     */
+    void wait() const
+    { query->waitForResult(); }
+
+    /**
+     * @return true if the function has returned or thrown within @p timeout
+     */
+    bool waitFor(std::chrono::milliseconds timeout) const
+    { return query->waitForResult(timeout); }
+
+    /**
+     * @brief Waits for the result and moves it out
+     *
+     * Throws the exception thrown by the function, or QueryCancelledError
+     * if the executor was stopped before the function was run.
+     */
+    ResultType get()
+    {
+        QueryTypePtr q = std::move(query);
+        return q->getResult();
+    }
+
+    /**
+     * @return query holding the result, e.g. to attach completion handlers
+     */
+    const QueryTypePtr& getQuery() const noexcept
+    { return query; }
+
+private:
+    QueryTypePtr query;
+};
+
+/**
+ * @struct RunnableHandler
+ * @brief Handler of Executor threads: runs the function and completes the query
+ *
+ * Exception escaping the function completes the query with it, so it does not
+ * terminate the thread.
+ */
+struct RunnableHandler {
+    void operator()(std::shared_ptr<RunnableQuery> query) const
+    {
+        try {
+            query->run();
+        } catch (...) {
+            query->setException(std::current_exception());
+            return;
+        }
+        query->setResult();
+    }
+};
+
+/**
+ * @class Executor
+ * @brief Thread pool that runs arbitrary callables
+ *
+ * Unlike other query pools, it needs neither a query nor a thread subclass:
+ * @code
+ * Executor executor(4);
+ * executor.startThreads();
+ * ExecutorFuture<int> sum = executor.submit([](int a, int b) { return a + b; }, 1, 2);
+ * executor.post([] { std::cout << "fire and forget" << std::endl; });
+ * std::cout << sum.get() << std::endl;
+ * @endcode
+ * Callables are kept in UniqueFunction, so they may be move-only and
+ * small ones are stored inside the query without an extra allocation.
+ * Threads call RunnableHandler directly, without virtual dispatch.
+ */
+class Executor : public QueryThreadPool<QueryWorker<QueryQueueBase<RunnableQuery>, RunnableHandler,
+                                                   DynamicWait, NoTimeout, 1, HelpWhileWaiting>> {
+    typedef QueryThreadPool<QueryWorker<QueryQueueBase<RunnableQuery>, RunnableHandler,
+                                        DynamicWait, NoTimeout, 1, HelpWhileWaiting>> Base;
+public:
+    explicit Executor(unsigned int poolSize)
+            : Base(poolSize, std::make_shared<QueueType>(), RunnableHandler()) { }
+
+    /**
+     * @param queue queue to take functions from, e.g. a bounded one
+     */
+    Executor(unsigned int poolSize, const QueueTypePtr& queue)
+            : Base(poolSize, queue, RunnableHandler()) { }
+
+    ~Executor() override
+    {
+        stopThreads();
+        joinThreads();
+    }
+
+    /**
+     * @brief Runs @p function on one of the pool threads, does not wait for it
+     *
+     * Exception thrown by the function is ignored.
+     */
+    PushStatus post(UniqueFunction<void()> function)
+    { return putQuery(std::make_shared<RunnableQuery>(std::move(function))); }
+
+    /**
+     * @brief Runs @p function with @p args on one of the pool threads
+     *
+     * Function and arguments are decay-copied, i.e. moved or copied into the task.
+     * If the queue rejects the task or the executor is stopped before running it,
+     * the future throws QueryOverloadedError or QueryCancelledError.
+     * @return future of the value returned by @p function
+     */
+    template<typename _Function, typename... _Args,
+             typename _ResultType = typename std::result_of<
+                     typename std::decay<_Function>::type(typename std::decay<_Args>::type...)>::type>
+    ExecutorFuture<_ResultType> submit(_Function&& function, _Args&&... args)
+    {
+        typedef SubmittedQuery<_ResultType, typename std::decay<_Function>::type,
+                               typename std::decay<_Args>::type...> Submitted;
+        auto query = std::make_shared<Submitted>(std::forward<_Function>(function), std::forward<_Args>(args)...);
+        // Future shares ownership of the one allocation holding both the call and its result
+        std::shared_ptr<QueryBase<_ResultType>> result(query, &query->getResultQuery());
+        PushStatus status = putQuery(query);
+        if (status == PushStatus::Rejected || status == PushStatus::TimedOut)
+            query->setOverloaded();
+        return ExecutorFuture<_ResultType>(std::move(result));
+    }
+
+private:
+    /**
+     * @brief Callable bound to its arguments, completes the query of the future
+     *
+     * If the queue drops it instead of running it, the future's query is completed
+     * with QueryOverloadedError or QueryCancelledError, so it does not wait forever.
+     */
+    template<typename _ResultType, typename _Function, typename... _Args>
+    class SubmittedQuery : public RunnableQuery {
+    public:
+        template<typename _F, typename... _A>
+        explicit SubmittedQuery(_F&& function, _A&&... args)
+                : function(std::forward<_F>(function))
+                , args(std::forward<_A>(args)...) { }
+
+        QueryBase<_ResultType>& getResultQuery() noexcept
+        { return result; }
+
+        void run() override
+        {
+            try {
+                complete(std::is_void<_ResultType>(), std::index_sequence_for<_Args...>());
+            } catch (...) {
+                result.trySetException(std::current_exception());
+            }
+        }
+
+    protected:
+        void onDropped(bool overloaded) override
+        {
+            if (overloaded)
+                result.setOverloaded();
+            else
+                result.trySetException(std::make_exception_ptr(QueryCancelledError()));
+        }
+
+    private:
+        template<std::size_t... I>
+        void complete(std::false_type, std::index_sequence<I...>)
+        { result.tryEmplaceResult(function(std::move(std::get<I>(args))...)); }
+
+        template<std::size_t... I>
+        void complete(std::true_type, std::index_sequence<I...>)
+        {
+            function(std::move(std::get<I>(args))...);
+            result.trySetResult();
+        }
+
+        QueryBase<_ResultType> result;
+        _Function function;
+        std::tuple<_Args...> args;
+    };
+};
+
+#endif //THREADING_EXECUTOR_H
@@ -0,0 +1,21 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_FORKJOINPOOL_H
+#define THREADING_FORKJOINPOOL_H
+
+#include "Executor.h"
+
+/**
+ * @brief Thread pool running the chunks of parallel algorithms and TaskGraph nodes
+ *
+ * It is Executor: its threads help while waiting, so nested fork/join calls
+ * do not deadlock, and an exception escaping a posted function completes
+ * its query instead of terminating the thread.
+ * Like any thread pool it must be started with startThreads().
+ * @sa ParallelAlgorithms.h
+ */
+typedef Executor ForkJoinPool;
+
+#endif //THREADING_FORKJOINPOOL_H
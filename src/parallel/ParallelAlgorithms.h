@@ -0,0 +1,243 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_PARALLELALGORITHMS_H
+#define THREADING_PARALLELALGORITHMS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "ForkJoinPool.h"
+#include "utils/CountDownLatch.h"
+
+/*
+ * Fork/join algorithms running on Executor (ForkJoinPool is its alias).
+ *
+ * Range is split into chunks of grain elements. If grain is 0 it is chosen
+ * so that every thread gets several chunks, which evens out the load.
+ * Chunks are claimed from a shared counter by pool threads and by the calling
+ * thread, which works too instead of just waiting, so the algorithms can be
+ * called from a pool thread without deadlock. Completion is tracked by one
+ * latch for the whole call. The first exception thrown by the body is
+ * rethrown to the caller after all chunks have finished.
+ */
+
+/**
+ * @class ForkJoinJob
+ * @brief Range split into chunks, executed by whoever claims them
+ */
+class ForkJoinJob {
+public:
+    /// Called with chunk index and [begin, end) offsets of the chunk
+    typedef std::function<void(size_t chunk, size_t begin, size_t end)> Body;
+
+    ForkJoinJob(size_t count, size_t grain, Body body)
+            : count(count)
+            , grain(grain)
+            , chunks((count + grain - 1) / grain)
+            , body(std::move(body))
+            , nextChunk(0)
+            , done(chunks) { }
+
+    /**
+     * @brief Picks grain so that each of @p threads gets several chunks
+     */
+    static size_t autoGrain(size_t count, size_t threads)
+    {
+        const size_t chunksPerThread = 4;
+        size_t target = threads * chunksPerThread;
+        return std::max<size_t>(1, (count + target - 1) / target);
+    }
+
+    size_t getChunks() const
+    { return chunks; }
+
+    /**
+     * @brief Runs chunks until none is left to claim
+     */
+    void runChunks()
+    {
+        while (true) {
+            size_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= chunks)
+                return;
+            if (!failed.load(std::memory_order_relaxed)) {
+                size_t begin = chunk * grain;
+                try {
+                    body(chunk, begin, std::min(count, begin + grain));
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error)
+                        error = std::current_exception();
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            }
+            done.countDown();
+        }
+    }
+
+    /**
+     * @brief Waits for all chunks and rethrows the first failure
+     */
+    void wait()
+    {
+        done.wait();
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+private:
+    const size_t count;
+    const size_t grain;
+    const size_t chunks;
+    Body body;
+    std::atomic<size_t> nextChunk;
+    CountDownLatch done;
+    std::atomic<bool> failed{false};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+};
+
+/**
+ * @brief Splits [0, count) into chunks and runs @p body on them in parallel
+ * @param grain chunk size, 0 to choose automatically
+ */
+inline void forkJoin(Executor& pool, size_t count, size_t grain, ForkJoinJob::Body body)
+{
+    if (count == 0)
+        return;
+    if (grain == 0)
+        grain = ForkJoinJob::autoGrain(count, pool.getPoolSize() + 1);
+
+    auto job = std::make_shared<ForkJoinJob>(count, grain, std::move(body));
+    size_t helpers = std::min<size_t>(pool.getPoolSize(), job->getChunks() - 1);
+    for (size_t i = 0; i < helpers; i++)
+        pool.post([job] { job->runChunks(); });
+
+    job->runChunks();
+    job->wait();
+}
+
+/**
+ * @brief Calls body(i) for every i in [first, last)
+ */
+template<typename Index, typename Body>
+void parallelFor(Executor& pool, Index first, Index last, Body body, size_t grain = 0)
+{
+    if (!(first < last))
+        return;
+    forkJoin(pool, static_cast<size_t>(last - first), grain,
+             [&](size_t, size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++)
+                     body(static_cast<Index>(first + i));
+             });
+}
+
+/**
+ * @brief Reduces map(i) for every i in [first, last) with @p reduce
+ *
+ * Partial results are combined in index order, so @p reduce has to be
+ * associative but not necessarily commutative.
+ * @param identity initial value of every partial result
+ */
+template<typename Index, typename T, typename MapOp, typename ReduceOp>
+T parallelReduce(Executor& pool, Index first, Index last, T identity,
+                 MapOp map, ReduceOp reduce, size_t grain = 0)
+{
+    if (!(first < last))
+        return identity;
+    size_t count = static_cast<size_t>(last - first);
+    if (grain == 0)
+        grain = ForkJoinJob::autoGrain(count, pool.getPoolSize() + 1);
+
+    std::vector<T> partial((count + grain - 1) / grain, identity);
+    forkJoin(pool, count, grain,
+             [&](size_t chunk, size_t begin, size_t end) {
+                 T acc = identity;
+                 for (size_t i = begin; i < end; i++)
+                     acc = reduce(std::move(acc), map(static_cast<Index>(first + i)));
+                 partial[chunk] = std::move(acc);
+             });
+
+    T result = identity;
+    for (auto& value : partial)
+        result = reduce(std::move(result), std::move(value));
+    return result;
+}
+
+/**
+ * @brief Writes op(*(first + i)) to *(out + i) for every element in [first, last)
+ *
+ * Both iterators must be random access.
+ * @return iterator past the last written element
+ */
+template<typename InputIt, typename OutputIt, typename UnaryOp>
+OutputIt parallelTransform(Executor& pool, InputIt first, InputIt last, OutputIt out,
+                           UnaryOp op, size_t grain = 0)
+{
+    size_t count = static_cast<size_t>(std::distance(first, last));
+    forkJoin(pool, count, grain,
+             [&](size_t, size_t begin, size_t end) {
+                 std::transform(first + begin, first + end, out + begin, op);
+             });
+    return out + count;
+}
+
+/**
+ * @brief Sorts [first, last) with @p comp
+ *
+ * Chunks are sorted in parallel and then merged pairwise,
+ * each merge pass runs in parallel as well. The sort is not stable.
+ */
+template<typename RandomIt, typename Compare,
+         typename = typename std::enable_if<!std::is_integral<Compare>::value>::type>
+void parallelSort(Executor& pool, RandomIt first, RandomIt last, Compare comp, size_t grain = 0)
+{
+    size_t count = static_cast<size_t>(std::distance(first, last));
+    if (grain == 0)
+        grain = std::max<size_t>(2048, ForkJoinJob::autoGrain(count, pool.getPoolSize() + 1));
+    if (count <= grain) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    size_t chunks = (count + grain - 1) / grain;
+    forkJoin(pool, chunks, 1,
+             [&](size_t chunk, size_t, size_t) {
+                 std::sort(first + chunk * grain,
+                           first + std::min(count, (chunk + 1) * grain), comp);
+             });
+
+    for (size_t width = grain; width < count; width *= 2) {
+        size_t pairs = (count + 2 * width - 1) / (2 * width);
+        forkJoin(pool, pairs, 1,
+                 [&](size_t pair, size_t, size_t) {
+                     size_t begin = pair * 2 * width;
+                     size_t middle = std::min(count, begin + width);
+                     size_t end = std::min(count, begin + 2 * width);
+                     if (middle < end)
+                         std::inplace_merge(first + begin, first + middle, first + end, comp);
+                 });
+    }
+}
+
+/**
+ * @brief Sorts [first, last) in ascending order
+ */
+template<typename RandomIt>
+void parallelSort(Executor& pool, RandomIt first, RandomIt last, size_t grain = 0)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type ValueType;
+    parallelSort(pool, first, last, std::less<ValueType>(), grain);
+}
+
+#endif //THREADING_PARALLELALGORITHMS_H
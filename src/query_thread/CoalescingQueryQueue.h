@@ -0,0 +1,131 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_COALESCINGQUERYQUEUE_H
+#define THREADING_COALESCINGQUERYQUEUE_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "QueryQueueBase.h"
+
+/**
+ * @class CoalescingQueryQueue
+ * @brief Query queue that runs identical queries once (single flight)
+ *
+ * Query type must declare KeyType and provide
+ * @code KeyType getKey() const @endcode
+ * Queries with equal keys must produce equal results.
+ * While a query with some key is queued or being processed, queries pushed
+ * with the same key are not queued, they are attached to it as followers and
+ * get a copy of its result (or exception) when it completes,
+ * pushQuery() returns PushStatus::Coalesced for them.
+ * If the queue is bounded and rejects a query that followers could attach to,
+ * the query is completed with QueryOverloadedError, so followers never hang.
+ * Followers of a query removed by removeIf() are completed with QueryCancelledError,
+ * the removed query itself is left untouched.
+ *
+ * Use it with QueryThreadPool or query threads in place of QueryQueueBase.
+ * @tparam _Hash hash of KeyType
+ */
+template<typename _QueryType, typename _Hash = std::hash<typename _QueryType::KeyType>>
+class CoalescingQueryQueue : public QueryQueueBase<_QueryType> {
+    typedef QueryQueueBase<_QueryType> Base;
+public:
+    typedef typename Base::QueryType QueryType;
+    typedef typename Base::QueryTypePtr QueryTypePtr;
+    typedef typename QueryType::KeyType KeyType;
+
+    CoalescingQueryQueue() : inFlight(std::make_shared<InFlight>()) { }
+
+    using Base::pushQuery;
+
+    PushStatus pushQuery(QueryTypePtr &&query) override
+    { return pushCoalesced(std::move(query), false); }
+
+    /**
+     * @brief Coalesces like pushQuery(), but never blocks on a full bounded queue
+     *
+     * Rejected query is completed with QueryOverloadedError,
+     * as queries may already be attached to it.
+     */
+    PushStatus tryPushQuery(QueryTypePtr query) override
+    { return pushCoalesced(std::move(query), true); }
+
+    /**
+     * @return number of queries attached to identical queries instead of being queued
+     */
+    uint64_t getCoalescedCount() const
+    { return coalescedCount.load(std::memory_order_relaxed); }
+
+protected:
+    /*
+     * Query left the queue unprocessed, e.g. removeIf() took it without completing it.
+     * Entry is erased first, so no follower attaches after the followers are taken.
+     */
+    void queryDropped(const QueryTypePtr& query) override
+    {
+        inFlight->remove(query->getKey(), query.get());
+        for (auto& follower : query->detachFollowers())
+            follower->cancel();
+    }
+
+private:
+    PushStatus pushCoalesced(QueryTypePtr&& query, bool tryOnly)
+    {
+        KeyType key = query->getKey();
+        {
+            std::lock_guard<std::mutex> lock(inFlight->mutex);
+            auto it = inFlight->queries.find(key);
+            if (it != inFlight->queries.end() && it->second->attachFollower(query)) {
+                coalescedCount.fetch_add(1, std::memory_order_relaxed);
+                return PushStatus::Coalesced;
+            }
+            inFlight->queries[key] = query;
+        }
+
+        /*
+         * Handler holds the map, not the queue, so it is safe
+         * to complete the query after the queue is destroyed
+         */
+        std::weak_ptr<InFlight> weakInFlight(inFlight);
+        const QueryType* leader = query.get();
+        query->addCompletionHandler([weakInFlight, key, leader] {
+            if (auto state = weakInFlight.lock())
+                state->remove(key, leader);
+        });
+
+        QueryTypePtr keep(query);
+        PushStatus status;
+        // Base::tryPushQuery() of unbounded queue calls pushQuery(), which would coalesce again
+        if (tryOnly && this->bounded)
+            status = this->pushBounded(std::move(query), OverflowPolicy::Reject);
+        else
+            status = Base::pushQuery(std::move(query));
+        if (status == PushStatus::Rejected || status == PushStatus::TimedOut)
+            keep->setOverloaded();
+        return status;
+    }
+
+    struct InFlight {
+        std::mutex mutex;
+        std::unordered_map<KeyType, QueryTypePtr, _Hash> queries;
+
+        void remove(const KeyType& key, const QueryType* leader)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = queries.find(key);
+            if (it != queries.end() && it->second.get() == leader)
+                queries.erase(it);
+        }
+    };
+
+    std::shared_ptr<InFlight> inFlight;
+    std::atomic<uint64_t> coalescedCount{0};
+};
+
+#endif //THREADING_COALESCINGQUERYQUEUE_H
@@ -0,0 +1,82 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_EVENTFDQUERYQUEUE_H
+#define THREADING_EVENTFDQUERYQUEUE_H
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "QueryQueueBase.h"
+
+/**
+ * @class EventFdQueryQueue
+ * @brief Query queue which signals pushed queries through an eventfd (Linux only)
+ *
+ * The eventfd becomes readable when a query is pushed, so a consumer can
+ * wait for queries together with other file descriptors in epoll or poll.
+ * The eventfd is written only once until the consumer calls consumeNotification(),
+ * so pushes to a busy queue do not cost a syscall each.
+ * hasQueryCondition is notified as well, so the queue works with regular query threads too.
+ */
+template<typename _QueryType>
+class EventFdQueryQueue : public QueryQueueBase<_QueryType> {
+    typedef QueryQueueBase<_QueryType> Base;
+public:
+    EventFdQueryQueue() : eventFd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), pending(false)
+    {
+        if (eventFd < 0)
+            throw std::system_error(errno, std::system_category(), "eventfd");
+    }
+
+    ~EventFdQueryQueue() override
+    { ::close(eventFd); }
+
+    /**
+     * @return non-blocking eventfd which is readable while the queue has been signalled
+     */
+    int getEventFd() const noexcept
+    { return eventFd; }
+
+    /**
+     * @brief Resets the eventfd, must be called by the consumer before it drains the queue.
+     *
+     * Queries pushed after this call signal the eventfd again.
+     */
+    void consumeNotification()
+    {
+        uint64_t value;
+        while (::read(eventFd, &value, sizeof(value)) < 0 && errno == EINTR) { }
+        // Pairs with exchange in notifyQueryAvailable, makes pushed queries visible
+        pending.exchange(false, std::memory_order_acq_rel);
+    }
+
+    /**
+     * @brief Makes the eventfd readable without pushing a query, e.g. to wake the consumer up
+     */
+    void signal()
+    {
+        uint64_t value = 1;
+        while (::write(eventFd, &value, sizeof(value)) < 0 && errno == EINTR) { }
+    }
+
+protected:
+    void notifyQueryAvailable() override
+    {
+        if (!pending.exchange(true, std::memory_order_acq_rel))
+            signal();
+    }
+
+private:
+    const int eventFd;
+    /// Set while eventfd is signalled and the consumer has not consumed it yet
+    std::atomic<bool> pending;
+};
+
+#endif //THREADING_EVENTFDQUERYQUEUE_H
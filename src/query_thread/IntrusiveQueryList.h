@@ -0,0 +1,226 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_INTRUSIVEQUERYLIST_H
+#define THREADING_INTRUSIVEQUERYLIST_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "utils/LockPolicy.h"
+
+/**
+ * @struct IntrusiveQueryHook
+ * @brief Link of IntrusiveQueryList, embedded into queries by IntrusiveQueryHookBase
+ *
+ * While the query is queued, the hook holds the reference the queue owns,
+ * so linking it allocates nothing.
+ */
+struct IntrusiveQueryHook {
+    typedef std::shared_ptr<void> OwnerPtr;
+
+    IntrusiveQueryHook() noexcept : next(nullptr), linked(false) { }
+    IntrusiveQueryHook(const IntrusiveQueryHook&) = delete;
+    IntrusiveQueryHook& operator=(const IntrusiveQueryHook&) = delete;
+
+    /// Next query in the list, points to the query object itself
+    void* next;
+    /// shared_ptr of the concrete query type, constructed by the list while linked
+    typename std::aligned_storage<sizeof(OwnerPtr), alignof(OwnerPtr)>::type owner;
+    bool linked;
+};
+
+/**
+ * @class IntrusiveQueryHookBase
+ * @brief Mixin that gives a query the hook IntrusiveQueryList links it through
+ *
+ * Only queries meant for IntrusiveQueryList inherit it, other queries
+ * do not pay for the hook:
+ * @code struct MyQuery : QueryBase<int>, IntrusiveQueryHookBase { ... }; @endcode
+ */
+class IntrusiveQueryHookBase {
+public:
+    /**
+     * @return link used by IntrusiveQueryList while the query is queued
+     */
+    IntrusiveQueryHook& getQueueHook() noexcept
+    {
+        return queueHook;
+    }
+
+protected:
+    IntrusiveQueryHookBase() = default;
+    ~IntrusiveQueryHookBase() = default;
+
+private:
+    IntrusiveQueryHook queueHook;
+};
+
+/**
+ * @class IntrusiveQueryList
+ * @brief Thread safe FIFO of queries linked through their IntrusiveQueryHook
+ *
+ * Drop-in replacement of GuardedDeque for QueryQueueBase:
+ * @code QueryQueueBase<MyQuery, IntrusiveQueryList<MyQuery>> @endcode
+ * The queue never allocates, and the pushed shared_ptr is moved into the query
+ * and back out of it, so push and pop do not touch the reference count.
+ * A query can be in one intrusive list at a time, pushing a queued one throws.
+ * @tparam _QueryType query type derived from QueryBase and IntrusiveQueryHookBase
+ * @tparam _Lock lock type, see LockPolicy.h, critical sections are
+ *         a few pointer updates so SpinMutex or TicketLock fit well
+ */
+template<typename _QueryType, typename _Lock = std::mutex>
+class IntrusiveQueryList final {
+public:
+    typedef std::shared_ptr<_QueryType> QueryTypePtr;
+
+    static_assert(std::is_base_of<IntrusiveQueryHookBase, _QueryType>::value,
+                  "Query must inherit IntrusiveQueryHookBase");
+    static_assert(sizeof(QueryTypePtr) == sizeof(IntrusiveQueryHook::OwnerPtr) &&
+                  alignof(QueryTypePtr) == alignof(IntrusiveQueryHook::OwnerPtr),
+                  "shared_ptr of query must fit into the hook");
+
+    IntrusiveQueryList() : head(nullptr), tail(nullptr), count(0) { }
+
+    ~IntrusiveQueryList()
+    {
+        clear();
+    }
+
+    IntrusiveQueryList(const IntrusiveQueryList&) = delete;
+    IntrusiveQueryList& operator=(const IntrusiveQueryList&) = delete;
+
+    IntrusiveQueryList(IntrusiveQueryList&& other) = delete;
+    IntrusiveQueryList& operator=(IntrusiveQueryList&& other) = delete;
+
+    /**
+     * @throws std::logic_error if the query is already in an intrusive list
+     */
+    void pushBack(QueryTypePtr&& query)
+    {
+        _QueryType* raw = query.get();
+        IntrusiveQueryHook& hook = raw->getQueueHook();
+        std::lock_guard<_Lock> lg(mutex);
+        if (hook.linked)
+            throw std::logic_error("Query is already queued");
+        new (&hook.owner) QueryTypePtr(std::move(query));
+        hook.linked = true;
+        hook.next = nullptr;
+        if (tail)
+            tail->getQueueHook().next = raw;
+        else
+            head = raw;
+        tail = raw;
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void pushBack(const QueryTypePtr& query)
+    {
+        pushBack(QueryTypePtr(query));
+    }
+
+    /**
+     * @brief Removes the first query and returns it
+     * @throws std::runtime_error if the list is empty
+     */
+    QueryTypePtr getFront()
+    {
+        std::lock_guard<_Lock> lg(mutex);
+        if (!head)
+            throw std::runtime_error("Deque is empty");
+        return unlinkHead();
+    }
+
+    /**
+     * @brief Reference to the first query, valid until it is removed
+     * @throws std::runtime_error if the list is empty
+     */
+    const QueryTypePtr& front()
+    {
+        std::lock_guard<_Lock> lg(mutex);
+        if (!head)
+            throw std::runtime_error("Deque is empty");
+        return owner(*head);
+    }
+
+    bool empty() const noexcept
+    { return count.load(std::memory_order_relaxed) == 0; }
+
+    size_t size() const noexcept
+    { return count.load(std::memory_order_relaxed); }
+
+    void clear()
+    {
+        std::lock_guard<_Lock> lg(mutex);
+        while (head)
+            unlinkHead();
+    }
+
+    template <class Predicate>
+    void removeIf(Predicate p)
+    {
+        std::lock_guard<_Lock> lg(mutex);
+        _QueryType* prev = nullptr;
+        _QueryType* current = head;
+        while (current) {
+            IntrusiveQueryHook& hook = current->getQueueHook();
+            _QueryType* next = static_cast<_QueryType*>(hook.next);
+            if (!p(static_cast<const QueryTypePtr&>(owner(*current)))) {
+                prev = current;
+                current = next;
+                continue;
+            }
+            if (prev)
+                prev->getQueueHook().next = next;
+            else
+                head = next;
+            if (tail == current)
+                tail = prev;
+            // Releasing the reference may destroy the query, so it is the last access
+            unlink(*current);
+            current = next;
+        }
+    }
+
+private:
+    static QueryTypePtr& owner(_QueryType& query) noexcept
+    { return *reinterpret_cast<QueryTypePtr*>(&query.getQueueHook().owner); }
+
+    QueryTypePtr unlinkHead()
+    {
+        _QueryType* first = head;
+        head = static_cast<_QueryType*>(first->getQueueHook().next);
+        if (!head)
+            tail = nullptr;
+        return unlink(*first);
+    }
+
+    /**
+     * @brief Takes the queue's reference out of the hook, the query must be already unlinked
+     */
+    QueryTypePtr unlink(_QueryType& query)
+    {
+        IntrusiveQueryHook& hook = query.getQueueHook();
+        QueryTypePtr& ref = owner(query);
+        QueryTypePtr result = std::move(ref);
+        ref.~QueryTypePtr();
+        hook.next = nullptr;
+        hook.linked = false;
+        count.store(count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        return result;
+    }
+
+    _QueryType* head;
+    _QueryType* tail;
+    std::atomic<size_t> count;
+    _Lock mutex;
+};
+
+#endif //THREADING_INTRUSIVEQUERYLIST_H
@@ -0,0 +1,195 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_KEYEDSTRANDQUEUE_H
+#define THREADING_KEYEDSTRANDQUEUE_H
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "QueryQueueBase.h"
+
+/**
+ * @class KeyedStrandQueue
+ * @brief Query queue which runs queries with equal keys one at a time in FIFO order
+ *
+ * Query type must declare KeyType and provide
+ * @code KeyType getKey() const @endcode
+ * Every key with queued queries has a strand. Only the head of each strand
+ * is in the shared queue, so queries of distinct keys are processed by all
+ * threads in parallel, while the rest of a strand waits until its head is processed.
+ * When a thread finishes a query whose strand has more queries, it continues
+ * with the next one itself, up to maxRunLength in a row, so a hot key stays
+ * on one core and its data stays in that core's cache. After that the next
+ * query goes to the back of the shared queue, so other keys are not starved.
+ *
+ * Use it with QueryThreadPool or query threads in place of QueryQueueBase.
+ * Limits count waiting queries as well, a query pushed behind a strand head
+ * takes room with the overflow policy like any other; DropOldest drops
+ * strand heads only. CoDel and size() apply to strand heads only.
+ * @tparam _Hash hash of KeyType
+ */
+template<typename _QueryType, typename _Hash = std::hash<typename _QueryType::KeyType>>
+class KeyedStrandQueue : public QueryQueueBase<_QueryType> {
+    typedef QueryQueueBase<_QueryType> Base;
+public:
+    typedef typename Base::QueryType QueryType;
+    typedef typename Base::QueryTypePtr QueryTypePtr;
+    typedef typename QueryType::KeyType KeyType;
+
+    /**
+     * @param maxRunLength how many queries of one strand a thread processes in a row
+     */
+    explicit KeyedStrandQueue(unsigned int maxRunLength = 16) : maxRunLength(maxRunLength)
+    {
+        Base::trackProcessing();
+    }
+
+    ~KeyedStrandQueue() override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& strand : strands) {
+            for (auto& query : strand.second.waiting) {
+                query->cancel();
+                query->invalidate();
+            }
+        }
+    }
+
+    using Base::pushQuery;
+
+    PushStatus pushQuery(QueryTypePtr &&query) override
+    { return push(std::move(query), false); }
+
+    PushStatus tryPushQuery(QueryTypePtr query) override
+    { return push(std::move(query), true); }
+
+    QueryTypePtr queryProcessed(const QueryTypePtr& query) override
+    {
+        bool sameThread = false;
+        QueryTypePtr next = takeNext(query->getKey(), &sameThread);
+        if (next && !sameThread) {
+            Base::finishPush(std::move(next), PushStatus::Pushed);
+            return nullptr;
+        }
+        if (next)
+            // Leaves the queue for the thread without passing the shared queue
+            Base::release(*next);
+        return next;
+    }
+
+    /**
+     * @return number of keys which have queued or running queries
+     */
+    size_t getStrandCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return strands.size();
+    }
+
+protected:
+    void queryDropped(const QueryTypePtr& query) override
+    {
+        QueryTypePtr next = takeNext(query->getKey(), nullptr);
+        if (next)
+            Base::finishPush(std::move(next), PushStatus::Pushed);
+    }
+
+private:
+    struct Strand {
+        /// Queries behind the one in the shared queue or running
+        std::deque<QueryTypePtr> waiting;
+        /// Queries processed in a row by one thread
+        unsigned int runLength = 0;
+    };
+
+    PushStatus push(QueryTypePtr&& query, bool tryOnly)
+    {
+        KeyType key = query->getKey();
+        if (!createStrand(key))
+            return pushWaiting(std::move(query), key, tryOnly);
+
+        PushStatus status = tryOnly ? Base::tryPushQuery(std::move(query))
+                                    : Base::pushQuery(std::move(query));
+        if (!isAccepted(status)) {
+            // Query did not become the head, queries pushed behind it meanwhile take its place
+            QueryTypePtr next = takeNext(key, nullptr);
+            if (next)
+                Base::finishPush(std::move(next), PushStatus::Pushed);
+        }
+        return status;
+    }
+
+    /*
+     * Takes room for a query behind the strand head, then appends it to the strand.
+     * Room is taken without the lock, as the policy may block.
+     */
+    PushStatus pushWaiting(QueryTypePtr&& query, const KeyType& key, bool tryOnly)
+    {
+        PushStatus status = PushStatus::Pushed;
+        if (Base::bounded) {
+            status = Base::reserveRoom(*query, tryOnly ? OverflowPolicy::Reject : Base::limits.policy);
+            if (!isAccepted(status))
+                return status;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = strands.find(key);
+            if (it != strands.end()) {
+                it->second.waiting.push_back(std::move(query));
+                return status;
+            }
+            strands.emplace(key, Strand());
+        }
+        // Strand has drained meanwhile, query becomes its head with the room it holds
+        return Base::finishPush(std::move(query), status);
+    }
+
+    /*
+     * @return true if the strand is created, false if the key already has one
+     */
+    bool createStrand(const KeyType& key)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return strands.emplace(key, Strand()).second;
+    }
+
+    static bool isAccepted(PushStatus status) noexcept
+    { return status == PushStatus::Pushed || status == PushStatus::DroppedOldest; }
+
+    /*
+     * Removes the next query of the strand, or the strand itself if it is empty.
+     * @p sameThread is set if the thread which processed the previous query
+     * should continue with the returned one, nullptr if no thread may continue.
+     */
+    QueryTypePtr takeNext(const KeyType& key, bool* sameThread)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = strands.find(key);
+        if (it == strands.end())
+            return nullptr;
+        Strand& strand = it->second;
+        if (strand.waiting.empty()) {
+            strands.erase(it);
+            return nullptr;
+        }
+        QueryTypePtr next = std::move(strand.waiting.front());
+        strand.waiting.pop_front();
+        if (sameThread && ++strand.runLength < maxRunLength) {
+            *sameThread = true;
+        } else {
+            strand.runLength = 0;
+        }
+        return next;
+    }
+
+    const unsigned int maxRunLength;
+    std::mutex mutex;
+    std::unordered_map<KeyType, Strand, _Hash> strands;
+};
+
+#endif //THREADING_KEYEDSTRANDQUEUE_H
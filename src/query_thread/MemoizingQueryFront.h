@@ -0,0 +1,118 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_MEMOIZINGQUERYFRONT_H
+#define THREADING_MEMOIZINGQUERYFRONT_H
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include "QueryQueueBase.h"
+#include "utils/ConcurrentLruCache.h"
+
+/**
+ * @class MemoizingQueryFront
+ * @brief Caches results of a query thread or query thread pool
+ *
+ * Query type must declare KeyType and provide
+ * @code KeyType getKey() const @endcode
+ * and its result must depend on the key only.
+ * Cached results are returned on the caller's thread without putting
+ * the query to the queue. Misses are processed by the target and their
+ * results are cached, exceptions are not cached.
+ * Concurrent misses of the same key are all processed, combine it with
+ * CoalescingQueryQueue to run them once.
+ * ResultType must be default constructible and copyable: the cache keeps
+ * a copy of every result and hands out copies of it.
+ * With capacity 0 caching is disabled and every query goes to the target.
+ *
+ * Target must outlive the front.
+ * @tparam _TargetType query thread or QueryThreadPool
+ */
+template<typename _TargetType, typename _Hash = std::hash<typename _TargetType::QueryType::KeyType>>
+class MemoizingQueryFront {
+public:
+    typedef _TargetType TargetType;
+    typedef typename TargetType::QueryType QueryType;
+    typedef typename TargetType::QueryTypePtr QueryTypePtr;
+    typedef typename QueryType::ResultType ResultType;
+    typedef typename QueryType::KeyType KeyType;
+    typedef ConcurrentLruCache<KeyType, ResultType, _Hash> CacheType;
+    typedef typename CacheType::Stats Stats;
+
+    /**
+     * @param target thread or pool that processes cache misses
+     * @param capacity maximal number of cached results, 0 disables caching
+     * @param ttl result lifetime, 0 means results do not expire
+     */
+    MemoizingQueryFront(TargetType& target, size_t capacity,
+                        std::chrono::milliseconds ttl = std::chrono::milliseconds(0))
+            : target(target), cache(capacity, ttl), cacheEnabled(capacity != 0) { }
+
+    MemoizingQueryFront(const MemoizingQueryFront&) = delete;
+    MemoizingQueryFront& operator=(const MemoizingQueryFront&) = delete;
+
+    /**
+     * @brief Returns cached result of the query or processes it by the target.
+     *
+     * On hit the query is completed with the cached result as well.
+     */
+    ResultType putQueryAndGetResult(const QueryTypePtr& query)
+    {
+        if (!cacheEnabled)
+            return process(query);
+        KeyType key = query->getKey();
+        ResultType result;
+        if (cache.get(key, result)) {
+            query->setResult(result);
+            return result;
+        }
+        result = process(query);
+        cache.put(key, result);
+        return result;
+    }
+
+    template<typename... _Args>
+    ResultType emplaceQueryAndGetResult(_Args&&... __args)
+    {
+        return putQueryAndGetResult(std::make_shared<QueryType>(std::forward<_Args>(__args)...));
+    }
+
+    /**
+     * @brief Drops cached result for @p key
+     */
+    void invalidate(const KeyType& key)
+    { cache.erase(key); }
+
+    /**
+     * @brief Drops all cached results
+     */
+    void clear()
+    { cache.clear(); }
+
+    /**
+     * @return hit, miss, eviction and expiration counters
+     */
+    Stats getStats() const
+    { return cache.getStats(); }
+
+    size_t getCachedCount()
+    { return cache.size(); }
+
+private:
+    ResultType process(const QueryTypePtr& query)
+    {
+        PushStatus status = target.putQuery(query);
+        if (status == PushStatus::Rejected || status == PushStatus::TimedOut)
+            query->setOverloaded();
+        return query->getResult();
+    }
+
+    TargetType& target;
+    CacheType cache;
+    const bool cacheEnabled;
+};
+
+#endif //THREADING_MEMOIZINGQUERYFRONT_H
@@ -5,69 +5,136 @@
 #ifndef THREADING_QUERYBASE_H
 #define THREADING_QUERYBASE_H
 
-#include <future>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <chrono>
 #include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "utils/EventCount.h"
+#include "WorkerContext.h"
 
 /**
- * @class QueryBase
- * QueryBase is designed to be the base class for query to be put into query queue
- * and to be processed by the query thread.
- * QueryBase is not copyable and not movable and so are derived classes.
- * Use shared_ptr on this class.
+ * @brief Result of the query that was dropped because its queue was overloaded
+ *
+ * Thrown by QueryBase::getResult()
+ */
+class QueryOverloadedError : public std::runtime_error {
+public:
+    QueryOverloadedError() : std::runtime_error("Query was dropped, queue is overloaded") { }
+};
+
+/**
+ * @brief Result of the query that was removed from queue without being processed
+ *
+ * Thrown by QueryBase::getResult()
+ */
+class QueryCancelledError : public std::runtime_error {
+public:
+    QueryCancelledError() : std::runtime_error("Query was cancelled") { }
+};
+
+template<typename _ResultType>
+class QueryBase;
+
+/**
+ * @class QueryBaseCommon
+ * Part of QueryBase that does not depend on whether result type is void.
+ * Holds completion state, exception, followers and completion handlers,
+ * the result itself is stored by QueryBase.
  * @tparam _ResultType The type of query's returned data
  */
 template<typename _ResultType>
-class QueryBase {
+class QueryBaseCommon {
 public:
     typedef _ResultType ResultType;
+    typedef std::shared_ptr<QueryBase<ResultType>> FollowerPtr;
 
-    QueryBase() : future(promise.get_future()), valid(true) { }
-    virtual ~QueryBase() = default;
+    QueryBaseCommon() : state(Pending), valid(true) { }
+    virtual ~QueryBaseCommon() = default;
 
-    QueryBase(const QueryBase&) = delete;
-    QueryBase& operator=(const QueryBase&) = delete;
+    QueryBaseCommon(const QueryBaseCommon&) = delete;
+    QueryBaseCommon& operator=(const QueryBaseCommon&) = delete;
 
-    QueryBase(QueryBase&& other) = delete;
-    QueryBase& operator=(QueryBase&& other) = delete;
+    QueryBaseCommon(QueryBaseCommon&& other) = delete;
+    QueryBaseCommon& operator=(QueryBaseCommon&& other) = delete;
 
     /**
-     * @brief Gets the result
-     *
-     * Returns the result immediately if result is set
-     * or waits until result is set and then returns it
-     * @return Result value copy
+     * @brief Waits until result or exception is set, does not throw the exception
      */
-    ResultType getResult()
+    void waitForResult()
     {
-        return future.get();
+        if (isCompleted())
+            return;
+        if (WorkerContext* worker = WorkerContext::current())
+            helpUntilCompleted(*worker, nullptr);
+        else
+            completeCondition.wait([this] { return isCompleted(); });
     }
 
     /**
      * @brief Waits for result to be set for specified amount of time
+     *
+     * On a pool thread that helps while waiting, the wait may last longer than @p timeout
+     * by the time of the query processed while waiting.
      * @param timeout time to wait
      * @return true if result is set
      */
     bool waitForResult(std::chrono::milliseconds timeout)
     {
-        return future.wait_for(timeout) == std::future_status::ready;
+        if (isCompleted())
+            return true;
+        if (WorkerContext* worker = WorkerContext::current()) {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            return helpUntilCompleted(*worker, &deadline);
+        }
+        return completeCondition.wait_for(timeout, [this] { return isCompleted(); });
     }
 
     /**
-     * @brief Sets the result
+     * @return true if result or exception is set
      */
-    void setResult(const ResultType& res)
+    bool isCompleted() const noexcept
     {
-        promise.set_value(res);
+        return state.load(std::memory_order_acquire) >= Value;
     }
 
     /**
-     * @brief Sets the result
+     * @brief Completes the query with exception, getResult() will throw it
+     * @throws std::logic_error if the query is already completed
      */
-    void setResult(ResultType&& res)
+    void setException(std::exception_ptr e)
+    {
+        if (!trySetException(std::move(e)))
+            throw std::logic_error("Query is already completed");
+    }
+
+    /**
+     * @brief Like setException(), but does nothing if the query is already completed
+     * @return false if the query is already completed
+     */
+    bool trySetException(std::exception_ptr e)
     {
-        promise.set_value(std::move(res));
+        if (!beginCompletion())
+            return false;
+        for (auto& follower : takeFollowers())
+            follower->trySetException(e);
+        finishWithException(std::move(e));
+        return true;
+    }
+
+    /**
+     * @brief Completes the query with QueryOverloadedError, does nothing if it is already completed
+     */
+    void setOverloaded()
+    {
+        trySetException(std::make_exception_ptr(QueryOverloadedError()));
     }
 
     /**
@@ -87,83 +154,390 @@ public:
         valid = false;
     }
 
+    /**
+     * @brief Stamps the time query was put to queue, called by the queue
+     */
+    void markEnqueued(std::chrono::steady_clock::time_point time) noexcept
+    {
+        enqueueTime = time;
+    }
+
+    /**
+     * @return time query was put to queue, valid only if queue tracks sojourn time
+     */
+    std::chrono::steady_clock::time_point getEnqueueTime() const noexcept
+    {
+        return enqueueTime;
+    }
+
+    /**
+     * @brief Makes @p follower complete with the same result as this query
+     *
+     * Follower gets a copy of the result or the exception, it must not be
+     * processed or put to a queue by itself.
+     * Move-only results can not be shared, followers are never attached then.
+     * @return false if follower is not attached, e.g. this query is already completed
+     */
+    bool attachFollower(const FollowerPtr& follower)
+    {
+        if (!resultIsCopyable())
+            return false;
+        std::lock_guard<std::mutex> lock(completionMutex);
+        if (completed)
+            return false;
+        followers.push_back(follower);
+        return true;
+    }
+
+    /**
+     * @brief Detaches followers without completing this query
+     *
+     * Used when the query leaves the queue unprocessed, e.g. removed by removeIf(),
+     * so the caller completes the followers itself.
+     * @return followers attached so far
+     */
+    std::vector<FollowerPtr> detachFollowers()
+    {
+        std::lock_guard<std::mutex> lock(completionMutex);
+        std::vector<FollowerPtr> detached;
+        detached.swap(followers);
+        return detached;
+    }
+
+    /**
+     * @brief Adds function to call after the query is completed
+     *
+     * Handler is called by the thread that completes the query,
+     * or right away if the query is already completed.
+     */
+    void addCompletionHandler(std::function<void()> handler)
+    {
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            if (!handlersRun) {
+                handlers.push_back(std::move(handler));
+                return;
+            }
+        }
+        handler();
+    }
+
+protected:
+    enum State : uint32_t {
+        Pending = 0, ///< Nothing is set
+        Setting,     ///< Result or exception is being set by the completing thread
+        Value,       ///< Result is set
+        Exception    ///< Exception is set
+    };
+
+    static constexpr bool resultIsCopyable() noexcept
+    {
+        return std::is_void<ResultType>::value ||
+               std::is_copy_constructible<typename std::conditional<
+                       std::is_void<ResultType>::value, int, ResultType>::type>::value;
+    }
+
+    /**
+     * @brief Reserves the right to complete the query
+     * @return false if the query is already completed or being completed
+     */
+    bool beginCompletion() noexcept
+    {
+        uint32_t expected = Pending;
+        return state.compare_exchange_strong(expected, Setting, std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Publishes result or exception and runs completion handlers
+     */
+    void finishCompletion(State result)
+    {
+        state.store(result, std::memory_order_release);
+        completeCondition.notify_all();
+        runCompletionHandlers();
+    }
+
+    /**
+     * @brief Waits for completion and throws the exception if one was set
+     */
+    void waitAndRethrow()
+    {
+        waitForResult();
+        if (state.load(std::memory_order_relaxed) == Exception)
+            std::rethrow_exception(error);
+    }
+
+    /**
+     * @brief Processes pending queries of the calling query thread until this query is completed
+     *
+     * Called when a query thread waits for a result, so the thread is not blocked
+     * while there is work it could do, e.g. the very query being waited for.
+     * @return false if @p deadline passed before completion
+     */
+    bool helpUntilCompleted(WorkerContext& worker, const std::chrono::steady_clock::time_point* deadline)
+    {
+        EventCount::SPtr pendingCondition = worker.getPendingQueryCondition();
+        bool notifiesWorker = false;
+        while (!isCompleted()) {
+            if (worker.runPendingQuery())
+                continue;
+            if (!notifiesWorker) {
+                // Worker sleeps on its queue condition, completion must wake it too
+                addCompletionHandler([pendingCondition] { pendingCondition->notify_all(); });
+                notifiesWorker = true;
+                continue;
+            }
+            auto wake = [this, &worker] { return isCompleted() || worker.hasPendingQuery(); };
+            if (!deadline) {
+                pendingCondition->wait(wake);
+                continue;
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (now >= *deadline)
+                return isCompleted();
+            pendingCondition->wait_for(*deadline - now, wake);
+        }
+        return true;
+    }
+
+    bool hasValue() const noexcept
+    {
+        return state.load(std::memory_order_acquire) == Value;
+    }
+
+    /**
+     * @brief Publishes exception, completion must be reserved with beginCompletion()
+     */
+    void finishWithException(std::exception_ptr e)
+    {
+        error = std::move(e);
+        finishCompletion(Exception);
+    }
+
+    /**
+     * @brief Marks the query completed and returns attached followers
+     */
+    std::vector<FollowerPtr> takeFollowers()
+    {
+        std::lock_guard<std::mutex> lock(completionMutex);
+        completed = true;
+        return std::move(followers);
+    }
+
+    void runCompletionHandlers()
+    {
+        std::vector<std::function<void()>> toRun;
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            handlersRun = true;
+            toRun.swap(handlers);
+        }
+        for (auto& handler : toRun)
+            handler();
+    }
+
 private:
-    std::promise<ResultType> promise;
-    std::future<ResultType> future;
+    std::atomic<uint32_t> state;
+    EventCount completeCondition;
+    std::exception_ptr error;
+    std::chrono::steady_clock::time_point enqueueTime;
+
+    std::mutex completionMutex;
+    bool completed = false;
+    bool handlersRun = false;
+    std::vector<FollowerPtr> followers;
+    std::vector<std::function<void()>> handlers;
 
     // Indicates if the created thread still waits for query to be processed
     std::atomic_bool valid;
 };
 
 /**
- * Explicit specialization for void result type
+ * @class QueryBase
+ * QueryBase is designed to be the base class for query to be put into query queue
+ * and to be processed by the query thread.
+ * QueryBase is not copyable and not movable and so are derived classes.
+ * Use shared_ptr on this class.
+ * The result is stored inside the query, so it may be a move-only type
+ * and it is not copied on its way to the waiting thread.
+ * If the result is waited for on a query thread, e.g. by a handler that put
+ * sub-queries to its own pool, the thread processes pending queries
+ * of its queue while waiting instead of blocking.
+ * @tparam _ResultType The type of query's returned data
  */
-template<>
-class QueryBase<void> {
+template<typename _ResultType>
+class QueryBase : public QueryBaseCommon<_ResultType> {
+    typedef QueryBaseCommon<_ResultType> Base;
 public:
-    typedef void ResultType;
-
-    QueryBase() : future(promise.get_future()), valid(true) { }
-    virtual ~QueryBase() = default;
+    typedef _ResultType ResultType;
 
-    QueryBase(const QueryBase&) = delete;
-    QueryBase& operator=(const QueryBase&) = delete;
-    QueryBase(QueryBase&& other) = delete;
-    QueryBase& operator=(QueryBase&& other) = delete;
+    ~QueryBase() override
+    {
+        if (this->hasValue())
+            value().~ResultType();
+    }
 
     /**
      * @brief Gets the result
      *
      * Returns the result immediately if result is set
-     * or waits until result is set and then returns it
-     * @return Result value copy
+     * or waits until result is set and then returns it.
+     * Throws the exception if one was set instead of result.
+     * The result is moved out of the query, so like std::future::get()
+     * it must be called once, use getResultRef() to read it several times.
+     * @return Result value
      */
     ResultType getResult()
     {
-        return future.get();
+        this->waitAndRethrow();
+        return std::move(value());
     }
 
     /**
-     * @brief Waits for result to be set for specified amount of time
-     * @param timeout time to wait
-     * @return true if result is set
+     * @brief Waits like getResult() and returns reference to the result stored in the query
      */
-    bool waitForResult(std::chrono::milliseconds timeout)
+    const ResultType& getResultRef()
     {
-        return future.wait_for(timeout) == std::future_status::ready;
+        this->waitAndRethrow();
+        return value();
     }
 
     /**
      * @brief Sets the result
+     * @throws std::logic_error if the query is already completed
      */
-    void setResult()
+    void setResult(const ResultType& res)
     {
-        promise.set_value();
+        emplaceResult(res);
     }
 
     /**
-     *
-     * @return true if someone else is still waiting for query to be processed
+     * @brief Sets the result
+     * @throws std::logic_error if the query is already completed
      */
-    bool isValid()
+    void setResult(ResultType&& res)
     {
-        return valid.load(std::memory_order_relaxed);
+        emplaceResult(std::move(res));
     }
 
     /**
-     * @brief Call it to set that query does not need to be processed anymore
+     * @brief Constructs the result in place from @p __args
+     * @throws std::logic_error if the query is already completed
      */
-    void invalidate()
+    template<typename... _Args>
+    void emplaceResult(_Args&&... __args)
     {
-        valid = false;
+        if (!tryEmplaceResult(std::forward<_Args>(__args)...))
+            throw std::logic_error("Query is already completed");
+    }
+
+    /**
+     * @brief Like emplaceResult(), but does nothing if the query is already completed
+     * @return false if the query is already completed
+     */
+    template<typename... _Args>
+    bool tryEmplaceResult(_Args&&... __args)
+    {
+        if (!this->beginCompletion())
+            return false;
+        try {
+            new (&storage) ResultType(std::forward<_Args>(__args)...);
+        } catch (...) {
+            // Result could not be constructed, complete with the reason instead
+            for (auto& follower : this->takeFollowers())
+                follower->trySetException(std::current_exception());
+            this->finishWithException(std::current_exception());
+            return true;
+        }
+        copyToFollowers(std::integral_constant<bool, Base::resultIsCopyable()>());
+        this->finishCompletion(Base::Value);
+        return true;
+    }
+
+    /**
+     * @brief Completes query that will not be processed with QueryCancelledError,
+     * does nothing if it is already completed
+     */
+    void cancel()
+    {
+        this->trySetException(std::make_exception_ptr(QueryCancelledError()));
     }
 
 private:
-    std::promise<ResultType> promise;
-    std::future<ResultType> future;
+    ResultType& value() noexcept
+    {
+        return *reinterpret_cast<ResultType*>(&storage);
+    }
 
-    // Indicates if the created thread still waits for query to be processed
-    std::atomic_bool valid;
+    /// Followers may have been cancelled meanwhile, they are skipped then
+    void copyToFollowers(std::true_type)
+    {
+        for (auto& follower : this->takeFollowers())
+            follower->tryEmplaceResult(static_cast<const ResultType&>(value()));
+    }
+
+    void copyToFollowers(std::false_type)
+    {
+        this->takeFollowers();
+    }
+
+    typename std::aligned_storage<sizeof(ResultType), alignof(ResultType)>::type storage;
+};
+
+/**
+ * Explicit specialization for void result type
+ */
+template<>
+class QueryBase<void> : public QueryBaseCommon<void> {
+public:
+    typedef void ResultType;
+
+    /**
+     * @brief Waits until the query is completed, throws the exception if one was set
+     */
+    void getResult()
+    {
+        waitAndRethrow();
+    }
+
+    /**
+     * @brief Sets the result
+     * @throws std::logic_error if the query is already completed
+     */
+    void setResult()
+    {
+        if (!trySetResult())
+            throw std::logic_error("Query is already completed");
+    }
+
+    /**
+     * @brief Like setResult(), but does nothing if the query is already completed
+     * @return false if the query is already completed
+     */
+    bool trySetResult()
+    {
+        if (!beginCompletion())
+            return false;
+        for (auto& follower : takeFollowers())
+            follower->trySetResult();
+        finishCompletion(Value);
+        return true;
+    }
+
+    /**
+     * @brief Completes query that will not be processed.
+     *
+     * Void queries are completed normally, waiter just stops waiting.
+     * Does nothing if the query is already completed.
+     */
+    void cancel()
+    {
+        if (!beginCompletion())
+            return;
+        for (auto& follower : takeFollowers())
+            follower->cancel();
+        finishCompletion(Value);
+    }
 };
 
 #endif //THREADING_QUERYBASE_H
@@ -7,16 +7,74 @@
 
 #include <memory>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <stdexcept>
 
-#include "utils/Condition.h"
+#include "utils/EventCount.h"
 #include "utils/GuardedDeque.h"
+#include "IntrusiveQueryList.h"
+
+/**
+ * @enum OverflowPolicy
+ * @brief What pushQuery() does when bounded queue is full
+ */
+enum class OverflowPolicy {
+    Block = 0,        ///< Waits until there is room for the query
+    BlockWithTimeout, ///< Waits for QueueLimits::timeout, then gives up
+    Reject,           ///< Returns PushStatus::Rejected right away, query is left untouched
+    DropOldest,       ///< Completes the oldest queued queries with QueryOverloadedError to make room
+    DropNewest        ///< Completes the pushed query with QueryOverloadedError
+};
+
+/**
+ * @enum PushStatus
+ * @brief Outcome of pushing query to the queue
+ */
+enum class PushStatus {
+    Pushed = 0,    ///< Query is queued
+    Rejected,      ///< Query is not queued because queue is full
+    TimedOut,      ///< Query is not queued, no room appeared within timeout
+    DroppedOldest, ///< Query is queued, older queries were dropped to make room
+    DroppedNewest, ///< Query is not queued and was completed with QueryOverloadedError
+    Coalesced      ///< Query is attached to identical query in flight and completes with its result
+};
+
+/**
+ * @brief Capacity limits of QueryQueueBase, 0 means no limit
+ */
+struct QueueLimits {
+    /// Maximal number of queued queries
+    size_t maxCount = 0;
+    /// Maximal estimated size of queued queries in bytes
+    size_t maxBytes = 0;
+    OverflowPolicy policy = OverflowPolicy::Block;
+    /// How long OverflowPolicy::BlockWithTimeout waits
+    std::chrono::milliseconds timeout{0};
+};
+
+/**
+ * @brief Parameters of controlled delay (CoDel) load shedding
+ */
+struct CoDelParams {
+    /// Acceptable standing queue delay
+    std::chrono::microseconds target{5000};
+    /// Sojourn time must stay above target this long before shedding starts
+    std::chrono::microseconds interval{100000};
+};
 
 /**
  *
  * @tparam _QueryType The type of query that queue will hold. Just type, not shared_ptr on type.
+ * @tparam _Container thread safe FIFO of query pointers with the interface of GuardedDeque,
+ *         e.g. IntrusiveQueryList that links queries through themselves and never allocates
  * QueryQueue is neither copyable nor movable.
+ * The queue is unbounded unless limits are set with setLimits().
  */
-template<typename _QueryType>
+template<typename _QueryType, typename _Container = GuardedDeque<std::shared_ptr<_QueryType>>>
 class QueryQueueBase {
 public:
     /*
@@ -25,9 +83,11 @@ public:
     typedef _QueryType QueryType;
     typedef std::shared_ptr<QueryType> QueryTypePtr;
     typedef typename QueryType::ResultType ResultType;
-    typedef typename QueryType::ResultTypePtr ResultTypePtr;
+    typedef std::function<size_t(const QueryType&)> SizeEstimator;
+    typedef _Container ContainerType;
 
-    QueryQueueBase() : hasQueryCondition(Condition::create()) { }
+    QueryQueueBase() : hasQueryCondition(EventCount::create()),
+                       queuedCount(0), queuedBytes(0) { }
     virtual ~QueryQueueBase() {
         clear();
     }
@@ -36,23 +96,82 @@ public:
     QueryQueueBase(QueryQueueBase&& other) = delete;
     QueryQueueBase& operator=(QueryQueueBase&& other) = delete;
 
-    virtual void pushQuery(const QueryTypePtr &query)
+    /**
+     * @brief Sets capacity limits and overflow policy.
+     *
+     * Must be called before the queue is used.
+     * @param estimator returns estimated size of query in bytes for QueueLimits::maxBytes,
+     *        sizeof(QueryType) is used if not set
+     */
+    void setLimits(const QueueLimits& queueLimits, SizeEstimator estimator = SizeEstimator())
     {
-        queryDeque.pushBack(query);
-        hasQueryCondition->notify_one();
+        limits = queueLimits;
+        sizeEstimator = std::move(estimator);
+        bounded = limits.maxCount != 0 || limits.maxBytes != 0;
     }
 
-    virtual void pushQuery(QueryTypePtr &&query)
+    const QueueLimits& getLimits() const
+    { return limits; }
+
+    /**
+     * @brief Enables controlled delay load shedding.
+     *
+     * Queue stamps every query with enqueue time. When the minimal time queries
+     * spent in the queue during @p params.interval stays above @p params.target,
+     * the queue is considered overloaded and getQuery() drops queries at the head
+     * which have waited longer than twice the target, completing them with
+     * QueryOverloadedError without processing. Overload state is re-evaluated every
+     * interval. This is the server variant of controlled delay (Nichols & Jacobson):
+     * a standing queue is not built up under overload, while short bursts,
+     * which drain within an interval, are queued normally.
+     * Must be called before the queue is used.
+     */
+    void enableCoDel(const CoDelParams& params)
     {
-        queryDeque.pushBack(std::move(query));
-        hasQueryCondition->notify_one();
+        codelParams = params;
+        codelEnabled = true;
+    }
+
+    /**
+     * @return number of queries dropped by CoDel
+     */
+    uint64_t getShedCount() const
+    { return shedCount.load(std::memory_order_relaxed); }
+
+    virtual PushStatus pushQuery(const QueryTypePtr &query)
+    {
+        QueryTypePtr copy(query);
+        return pushQuery(std::move(copy));
+    }
+
+    virtual PushStatus pushQuery(QueryTypePtr &&query)
+    {
+        if (!bounded) {
+            if (codelEnabled)
+                query->markEnqueued(std::chrono::steady_clock::now());
+            queryDeque.pushBack(std::move(query));
+            hasQueryCondition->notify_one();
+            notifyQueryAvailable();
+            return PushStatus::Pushed;
+        }
+        return pushBounded(std::move(query), limits.policy);
+    }
+
+    /**
+     * @brief Pushes query only if there is room for it, never blocks or drops queries
+     * @return PushStatus::Pushed or PushStatus::Rejected
+     */
+    virtual PushStatus tryPushQuery(QueryTypePtr query)
+    {
+        if (!bounded)
+            return pushQuery(std::move(query));
+        return pushBounded(std::move(query), OverflowPolicy::Reject);
     }
 
     template<typename... _Args>
-    void emplaceQuery(_Args&&... __args)
+    PushStatus emplaceQuery(_Args&&... __args)
     {
-        queryDeque.emplaceBack(std::make_shared<QueryType>(std::forward<_Args>(__args)...));
-        hasQueryCondition->notify_one();
+        return pushQuery(std::make_shared<QueryType>(std::forward<_Args>(__args)...));
     }
 
     /**
@@ -60,15 +179,19 @@ public:
      * If queue is empty it throws std::runtime_error
      */
     virtual QueryTypePtr getQuery()
-    { return queryDeque.getFront(); }
+    {
+        if (codelEnabled)
+            return takeFrontCoDel();
+        return takeFront();
+    }
 
     virtual const QueryTypePtr& frontQuery()
     { return queryDeque.front(); }
 
     virtual void popQuery()
-    { queryDeque.popFront(); }
+    { getQuery(); }
 
-    Condition::SPtr
+    EventCount::SPtr
     getHasQueryCondition() const
     { return hasQueryCondition; }
 
@@ -79,24 +202,291 @@ public:
     { return queryDeque.size(); }
 
     /**
-     * Clears the queue and sets result for all queries
+     * @return true if threads must call queryProcessed() after they process a query
+     */
+    bool tracksProcessing() const noexcept
+    { return processingTracked; }
+
+    /**
+     * @brief Called by the thread after it has processed @p query taken from this queue,
+     * only if tracksProcessing() returns true
+     * @return query the same thread must process next, or nullptr
      */
-    void clear()
+    virtual QueryTypePtr queryProcessed(const QueryTypePtr& /*query*/)
+    { return nullptr; }
+
+    /**
+     * @return estimated size of queued queries in bytes, tracked only if queue is bounded
+     */
+    size_t getQueuedBytes() const
+    { return queuedBytes.load(std::memory_order_relaxed); }
+
+    /**
+     * Clears the queue and cancels all queries
+     */
+    virtual void clear()
     {
         while (!queryDeque.empty()) {
-            QueryTypePtr p = queryDeque.getFront();
-            p->setResult();
+            QueryTypePtr p;
+            try {
+                p = takeFront();
+            } catch (std::runtime_error& e) {
+                // Another thread has taken the query
+                break;
+            }
+            p->cancel();
             p->invalidate();
+            queryDropped(p);
         }
     }
 
+    /**
+     * @brief Removes queries matching @p p without completing them
+     */
     template <class Predicate>
     void removeIf(Predicate p)
-    { queryDeque.removeIf(p); }
+    {
+        std::vector<QueryTypePtr> removed;
+        queryDeque.removeIf([&](const QueryTypePtr& query) {
+            if (!p(query))
+                return false;
+            release(*query);
+            removed.push_back(query);
+            return true;
+        });
+        for (const auto& query : removed)
+            queryDropped(query);
+    }
 
 protected:
-    Condition::SPtr hasQueryCondition;
-    GuardedDeque<QueryTypePtr> queryDeque;
+    /**
+     * @brief Called after a query is pushed and hasQueryCondition is notified.
+     *
+     * Lets derived queues wake consumers which do not wait on the condition,
+     * e.g. threads blocked in epoll. Default implementation does nothing.
+     */
+    virtual void notifyQueryAvailable() {}
+
+    /**
+     * @brief Called after a queued query has left the queue without being processed
+     *
+     * E.g. it was shed, dropped by DropOldest, cancelled by clear() or removed by removeIf().
+     * Default implementation does nothing.
+     */
+    virtual void queryDropped(const QueryTypePtr& /*query*/) {}
+
+    /**
+     * @brief Makes threads call queryProcessed(), must be called by derived constructor
+     */
+    void trackProcessing() noexcept
+    { processingTracked = true; }
+
+    /**
+     * @brief Pushes query ignoring limits, for queries the queue has already accepted once
+     */
+    PushStatus pushForced(QueryTypePtr&& query)
+    {
+        if (bounded) {
+            queuedCount.fetch_add(1, std::memory_order_relaxed);
+            if (limits.maxBytes != 0)
+                queuedBytes.fetch_add(estimate(*query), std::memory_order_relaxed);
+        }
+        return finishPush(std::move(query), PushStatus::Pushed);
+    }
+
+    QueryTypePtr takeFront()
+    {
+        QueryTypePtr query = queryDeque.getFront();
+        release(*query);
+        return query;
+    }
+
+    /*
+     * Drops queries at the head while queue is overloaded and they have waited
+     * longer than twice the target, returns the first query worth processing
+     */
+    QueryTypePtr takeFrontCoDel()
+    {
+        std::lock_guard<std::mutex> lock(codelMutex);
+        while (true) {
+            QueryTypePtr query = takeFront();
+            auto now = std::chrono::steady_clock::now();
+            if (!shouldShed(now - query->getEnqueueTime(), now))
+                return query;
+            shed(query);
+        }
+    }
+
+    /*
+     * Overload is decided once per interval: queue is overloaded if even
+     * the shortest sojourn time seen during the last interval exceeded target
+     */
+    bool shouldShed(std::chrono::steady_clock::duration sojourn,
+                    std::chrono::steady_clock::time_point now)
+    {
+        if (now >= codel.intervalEnd) {
+            codel.overloaded = codel.minSojourn > codelParams.target;
+            codel.minSojourn = sojourn;
+            codel.intervalEnd = now + codelParams.interval;
+        } else if (sojourn < codel.minSojourn) {
+            codel.minSojourn = sojourn;
+        }
+        return codel.overloaded && sojourn > 2 * codelParams.target;
+    }
+
+    void shed(const QueryTypePtr& query)
+    {
+        query->setOverloaded();
+        query->invalidate();
+        shedCount.fetch_add(1, std::memory_order_relaxed);
+        queryDropped(query);
+    }
+
+    PushStatus pushBounded(QueryTypePtr&& query, OverflowPolicy policy)
+    {
+        PushStatus status = reserveRoom(*query, policy);
+        if (status != PushStatus::Pushed && status != PushStatus::DroppedOldest)
+            return status;
+        return finishPush(std::move(query), status);
+    }
+
+    /**
+     * @brief Takes room for @p query in a bounded queue, as @p policy says to when it is full
+     *
+     * Room taken is returned by release(), a query holding it is put
+     * to the queue with finishPush().
+     * @return PushStatus::Pushed or PushStatus::DroppedOldest if room is taken
+     */
+    PushStatus reserveRoom(QueryType& query, OverflowPolicy policy)
+    {
+        const size_t bytes = estimate(query);
+        PushStatus status = PushStatus::Pushed;
+        auto deadline = std::chrono::steady_clock::now() + limits.timeout;
+
+        while (!tryReserve(bytes)) {
+            switch (policy) {
+            case OverflowPolicy::Reject:
+                return PushStatus::Rejected;
+            case OverflowPolicy::DropNewest:
+                query.setOverloaded();
+                return PushStatus::DroppedNewest;
+            case OverflowPolicy::DropOldest:
+                try {
+                    QueryTypePtr oldest = takeFront();
+                    oldest->setOverloaded();
+                    oldest->invalidate();
+                    queryDropped(oldest);
+                    status = PushStatus::DroppedOldest;
+                } catch (std::runtime_error& e) {
+                    // Consumers have emptied the queue meanwhile
+                }
+                break;
+            case OverflowPolicy::Block:
+            case OverflowPolicy::BlockWithTimeout: {
+                EventCount::Key key = notFullCondition.prepareWait();
+                if (tryReserve(bytes)) {
+                    notFullCondition.cancelWait();
+                    return status;
+                }
+                if (policy == OverflowPolicy::Block) {
+                    notFullCondition.commitWait(key);
+                    break;
+                }
+                auto now = std::chrono::steady_clock::now();
+                if (now >= deadline) {
+                    notFullCondition.cancelWait();
+                    return PushStatus::TimedOut;
+                }
+                notFullCondition.commitWaitFor(key, deadline - now);
+                break;
+            }
+            }
+        }
+        return status;
+    }
+
+    PushStatus finishPush(QueryTypePtr&& query, PushStatus status)
+    {
+        if (codelEnabled)
+            query->markEnqueued(std::chrono::steady_clock::now());
+        queryDeque.pushBack(std::move(query));
+        hasQueryCondition->notify_one();
+        notifyQueryAvailable();
+        return status;
+    }
+
+    size_t estimate(const QueryType& query) const
+    {
+        if (limits.maxBytes == 0)
+            return 0;
+        return sizeEstimator ? sizeEstimator(query) : sizeof(QueryType);
+    }
+
+    /*
+     * Takes room for one query. Query bigger than maxBytes
+     * is still accepted when nothing else is queued.
+     */
+    bool tryReserve(size_t bytes)
+    {
+        size_t count = queuedCount.load(std::memory_order_relaxed);
+        do {
+            if (limits.maxCount != 0 && count >= limits.maxCount)
+                return false;
+        } while (!queuedCount.compare_exchange_weak(count, count + 1, std::memory_order_relaxed));
+
+        if (limits.maxBytes != 0) {
+            size_t before = queuedBytes.fetch_add(bytes, std::memory_order_relaxed);
+            if (before != 0 && before + bytes > limits.maxBytes) {
+                queuedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+                queuedCount.fetch_sub(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+     * Returns room taken by query that has left the queue
+     */
+    void release(const QueryType& query)
+    {
+        if (!bounded)
+            return;
+        queuedCount.fetch_sub(1, std::memory_order_relaxed);
+        if (limits.maxBytes != 0)
+            queuedBytes.fetch_sub(estimate(query), std::memory_order_relaxed);
+        notFullCondition.notify_one();
+    }
+
+    /// Notified on every push, notification is free while no worker waits
+    EventCount::SPtr hasQueryCondition;
+    ContainerType queryDeque;
+
+    QueueLimits limits;
+    SizeEstimator sizeEstimator;
+    bool bounded = false;
+    bool processingTracked = false;
+    /// Room taken by queued queries, tracked only if queue is bounded
+    std::atomic<size_t> queuedCount;
+    std::atomic<size_t> queuedBytes;
+    /// Notified whenever room is returned, producers blocked by full queue wait on it
+    EventCount notFullCondition;
+
+    /**
+     * @brief State of CoDel algorithm
+     */
+    struct CoDelState {
+        std::chrono::steady_clock::time_point intervalEnd;
+        std::chrono::steady_clock::duration minSojourn = std::chrono::steady_clock::duration::zero();
+        bool overloaded = false;
+    };
+
+    bool codelEnabled = false;
+    CoDelParams codelParams;
+    CoDelState codel;
+    /// Serializes consumers while CoDel state is updated
+    std::mutex codelMutex;
+    std::atomic<uint64_t> shedCount{0};
 };
 
 #endif //THREADING_QUERYQUEUEBASE_H
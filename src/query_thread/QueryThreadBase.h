@@ -7,9 +7,13 @@
 
 #include <string>
 #include <memory>
+#include <typeinfo>
 
-#include "utils/Condition.h"
+#include "utils/EventCount.h"
+#include "utils/MonotonicArena.h"
+#include "watchdog/Heartbeat.h"
 #include "../ThreadBase.h"
+#include "QueryQueueBase.h"
 
  /**
   * QueryThreadBase is neither copyable nor movable.
@@ -23,7 +27,6 @@ public:
     typedef typename QueueType::QueryType QueryType;
     typedef typename QueueType::QueryTypePtr QueryTypePtr;
     typedef typename QueryType::ResultType ResultType;
-    typedef typename QueryType::ResultTypePtr ResultTypePtr;
 
     explicit QueryThreadBase(const QueueTypePtr& queue) :
             queryQueue(queue),
@@ -56,38 +59,130 @@ public:
         return queryQueue->size();
     };
 
-    Condition::SPtr getHasQueryCondition() const {
+    EventCount::SPtr getHasQueryCondition() const {
         return queueCondition;
     }
 
-    void putQuery(QueryTypePtr&& query) {
-        queryQueue->pushQuery(std::move(query));
+    /**
+     * @brief Attaches heartbeat the thread updates around every query, see Watchdog.
+     *
+     * Must be called before startThread()
+     */
+    void setHeartbeat(const Heartbeat::SPtr& threadHeartbeat) {
+        heartbeat = threadHeartbeat;
     }
 
-    void putQuery(const QueryTypePtr& query) {
-        queryQueue->pushQuery(query);
+    /**
+     * @return peak usage of the scratch arena of this thread
+     */
+    ArenaStats getArenaStats() const {
+        return arena.getStats();
     }
 
-    ResultTypePtr putQueryAndGetResult(const QueryTypePtr &query) {
-        queryQueue->pushQuery(query);
+    PushStatus putQuery(QueryTypePtr&& query) {
+        return queryQueue->pushQuery(std::move(query));
+    }
+
+    PushStatus putQuery(const QueryTypePtr& query) {
+        return queryQueue->pushQuery(query);
+    }
+
+    /**
+     * If bounded queue rejects the query, it is completed with QueryOverloadedError
+     */
+    ResultType putQueryAndGetResult(const QueryTypePtr &query) {
+        pushOrOverload(query);
         return query->getResult();
     }
 
     template<typename... _Args>
-    void emplaceQuery(_Args&&... __args) {
-        queryQueue->emplaceQuery(std::forward<_Args>(__args)...);
+    PushStatus emplaceQuery(_Args&&... __args) {
+        return queryQueue->emplaceQuery(std::forward<_Args>(__args)...);
     }
 
     template<typename... _Args>
-    ResultTypePtr emplaceQueryAndGetResult(_Args&&... __args) {
+    ResultType emplaceQueryAndGetResult(_Args&&... __args) {
         QueryTypePtr query = std::make_shared<QueryType>(std::forward<_Args>(__args)...);
-        queryQueue->pushQuery(query);
+        pushOrOverload(query);
         return query->getResult();
     }
 
 protected:
+    class NestingGuard {
+    public:
+        explicit NestingGuard(unsigned int& depth) noexcept : depth(depth)
+        { ++depth; }
+
+        ~NestingGuard()
+        { --depth; }
+
+        bool isOutermost() const noexcept
+        { return depth == 1; }
+
+    private:
+        unsigned int& depth;
+    };
+
+    /**
+     * @brief Scratch memory for onQuery, everything allocated from it is freed after onQuery returns.
+     *
+     * Use it through ArenaAllocator for temporary containers, so handlers of
+     * different threads do not contend in malloc.
+     */
+    MonotonicArena& getArena() noexcept {
+        return arena;
+    }
+
+    /**
+     * @brief Processes @p query with @p handler, then resets the arena.
+     *
+     * Heartbeat, if the thread has one, is updated around the handler.
+     * If the queue tracks processing, it is told the query is processed and
+     * queries it hands back are processed by this thread right away.
+     * Queries processed while a handler waits for a result are nested in it:
+     * they share its heartbeat and the arena is reset only after the outermost one.
+     */
+    template<typename _Handler>
+    void processQuery(QueryTypePtr&& query, _Handler handler) {
+        NestingGuard nesting(processingDepth);
+        Heartbeat* heartbeat = nesting.isOutermost() ? getHeartbeat() : nullptr;
+        while (query) {
+            QueryTypePtr processed;
+            if (queryQueue->tracksProcessing())
+                processed = query;
+            if (heartbeat)
+                heartbeat->begin(typeid(*query).name());
+            handler(std::move(query));
+            if (heartbeat)
+                heartbeat->end();
+            if (nesting.isOutermost())
+                arena.reset();
+            if (processed)
+                query = queryQueue->queryProcessed(processed);
+        }
+    }
+
+    /**
+     * @return heartbeat to update around every query, nullptr if the thread is not watched
+     */
+    Heartbeat* getHeartbeat() const noexcept {
+        return heartbeat.get();
+    }
+
+    void pushOrOverload(const QueryTypePtr& query) {
+        PushStatus status = queryQueue->pushQuery(query);
+        if (status == PushStatus::Rejected || status == PushStatus::TimedOut)
+            query->setOverloaded();
+    }
+
     QueueTypePtr queryQueue;
-    Condition::SPtr queueCondition;
+    EventCount::SPtr queueCondition;
+    /// Number of processQuery() calls on the stack, more than one while helping
+    unsigned int processingDepth = 0;
+    /// Reset by derived threads after every onQuery
+    MonotonicArena arena;
+    /// Progress reported to Watchdog, optional
+    Heartbeat::SPtr heartbeat;
 };
 
 #endif //THREADING_QUERYTHREADBASE_H
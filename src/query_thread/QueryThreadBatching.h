@@ -0,0 +1,68 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_QUERYTHREADBATCHING_H
+#define THREADING_QUERYTHREADBATCHING_H
+
+#include <chrono>
+#include <memory>
+
+#include "QueryWorker.h"
+#include "QueryQueueBase.h"
+
+/**
+ * @class QueryThreadBatching
+ * @brief QueryWorker with BatchWindow collect policy, virtual onBatch() and its own queue by default
+ *
+ * Queries are accumulated until either maxBatchSize of them are collected
+ * or maxDelay has passed since the first query of the batch was taken,
+ * then onBatch() gets them all at once. So under light traffic a query waits
+ * at most maxDelay, and under heavy traffic batches are full.
+ * If tickPeriod is not 0, onTick() is called at that rate regardless of traffic.
+ *
+ * Queries left in the batch when the thread is stopped are still passed
+ * to onBatch(), queries left in the queue are cancelled.
+ *
+ * @tparam _QueueType queue type, QueryQueueBase or derived from it
+ */
+template<typename _QueryType, typename _QueueType = QueryQueueBase<_QueryType>>
+class QueryThreadBatching : public QueryWorker<_QueueType, VirtualBatchHandler,
+                                               DynamicWait, NoTimeout, 1, NoHelping, BatchWindow> {
+    typedef QueryWorker<_QueueType, VirtualBatchHandler,
+                        DynamicWait, NoTimeout, 1, NoHelping, BatchWindow> Base;
+public:
+    typedef typename Base::QueueType QueueType;
+    typedef typename Base::QueueTypePtr QueueTypePtr;
+    typedef typename Base::QueryType QueryType;
+    typedef typename Base::QueryTypePtr QueryTypePtr;
+    typedef typename Base::ResultType ResultType;
+    typedef typename Base::Batch Batch;
+
+    /**
+     * @param maxBatchSize batch is flushed as soon as it has this many queries
+     * @param maxDelay batch is flushed when its first query has waited this long
+     * @param tickPeriod how often to call onTick(), 0 to never call it
+     */
+    QueryThreadBatching(unsigned int maxBatchSize, std::chrono::milliseconds maxDelay,
+                        std::chrono::milliseconds tickPeriod = std::chrono::milliseconds(0)) :
+            QueryThreadBatching(maxBatchSize, maxDelay, tickPeriod, std::make_shared<QueueType>()) { }
+
+    /**
+     * @param queue queue to take queries from, e.g. a queue derived from QueryQueueBase
+     */
+    QueryThreadBatching(unsigned int maxBatchSize, std::chrono::milliseconds maxDelay,
+                        std::chrono::milliseconds tickPeriod, const QueueTypePtr& queue) :
+            Base(queue, BatchWindow(maxBatchSize, maxDelay, tickPeriod)) { }
+
+    ~QueryThreadBatching() = default;
+    QueryThreadBatching(const QueryThreadBatching&) = delete;
+    QueryThreadBatching& operator=(const QueryThreadBatching&) = delete;
+    QueryThreadBatching(QueryThreadBatching&& other) = delete;
+    QueryThreadBatching& operator=(QueryThreadBatching&& other) = delete;
+
+protected:
+    void onBatch(Batch& queries) override = 0;
+};
+
+#endif //THREADING_QUERYTHREADBATCHING_H
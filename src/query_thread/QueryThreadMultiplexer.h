@@ -0,0 +1,199 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_QUERYTHREADMULTIPLEXER_H
+#define THREADING_QUERYTHREADMULTIPLEXER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "../ThreadBase.h"
+#include "parallel/Executor.h"
+#include "utils/UniqueFunction.h"
+
+/**
+ * @class DeadlineListener
+ * @brief Receives deadlines from the timer thread of QueryThreadMultiplexer
+ */
+class DeadlineListener {
+public:
+    virtual ~DeadlineListener() = default;
+
+    /**
+     * @brief Called by the timer thread when the requested time has come
+     * @param now current time
+     * @return next time to be called at
+     */
+    virtual std::chrono::steady_clock::time_point onDeadline(std::chrono::steady_clock::time_point now) = 0;
+};
+
+/**
+ * @class QueryThreadMultiplexer
+ * @brief Shared workers and a timer thread that run many SharedQueryThread instances
+ *
+ * Logical threads are scheduled onto the workers only when they have queries
+ * or their timeout has expired, so idle ones cost neither a stack nor a wakeup.
+ * Multiplexer must outlive its logical threads and be stopped after them.
+ */
+class QueryThreadMultiplexer {
+public:
+    /**
+     * @param poolSize number of shared worker threads
+     * @param maxRunLength number of queries a logical thread processes before
+     *        it yields the worker to other logical threads
+     */
+    explicit QueryThreadMultiplexer(unsigned int poolSize, unsigned int maxRunLength = 64)
+            : executor(poolSize)
+            , maxRunLength(maxRunLength > 0 ? maxRunLength : 1) { }
+
+    ~QueryThreadMultiplexer()
+    {
+        stopThreads();
+        joinThreads();
+    }
+
+    QueryThreadMultiplexer(const QueryThreadMultiplexer&) = delete;
+    QueryThreadMultiplexer& operator=(const QueryThreadMultiplexer&) = delete;
+
+    void startThreads()
+    {
+        executor.startThreads();
+        timerThread.startThread();
+    }
+
+    void stopThreads()
+    {
+        timerThread.stopThread();
+        executor.stopThreads();
+    }
+
+    void joinThreads()
+    {
+        timerThread.joinThread();
+        executor.joinThreads();
+    }
+
+    /**
+     * @brief Sets how the workers wait for work, must be called before startThreads()
+     */
+    void setWaitStrategy(const WaitStrategy& strategy)
+    { executor.setWaitStrategy(strategy); }
+
+    /**
+     * @return workers the logical threads run on, e.g. to watch them with Watchdog
+     */
+    Executor& getExecutor() noexcept
+    { return executor; }
+
+    unsigned int getMaxRunLength() const noexcept
+    { return maxRunLength; }
+
+    /**
+     * @brief Runs @p function on one of the workers
+     */
+    void post(UniqueFunction<void()> function)
+    { executor.post(std::move(function)); }
+
+    /**
+     * @brief Makes timer thread call @p listener at @p time, replaces previous registration
+     */
+    void addDeadline(DeadlineListener* listener, std::chrono::steady_clock::time_point time)
+    { timerThread.add(listener, time); }
+
+    /**
+     * @brief Stops calling @p listener, after return it is not called anymore
+     */
+    void removeDeadline(DeadlineListener* listener)
+    { timerThread.remove(listener); }
+
+private:
+    /**
+     * @brief Calls listeners at their deadlines
+     *
+     * Registrations are versioned, so a stale heap entry left by
+     * remove() or repeated add() is recognized and skipped.
+     */
+    class TimerThread : public ThreadBase {
+    public:
+        ~TimerThread() override
+        {
+            stopThread();
+            joinThread();
+        }
+
+        void stopThread() override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ThreadBase::stopThread();
+            condition.notify_all();
+        }
+
+        void add(DeadlineListener* listener, std::chrono::steady_clock::time_point time)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            uint64_t version = ++lastVersion;
+            versions[listener] = version;
+            timers.push({time, listener, version});
+            condition.notify_all();
+        }
+
+        void remove(DeadlineListener* listener)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            versions.erase(listener);
+        }
+
+    protected:
+        void threadFunction() override
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (isRunning()) {
+                if (timers.empty()) {
+                    condition.wait(lock);
+                    continue;
+                }
+                Entry top = timers.top();
+                auto now = std::chrono::steady_clock::now();
+                if (top.time > now) {
+                    condition.wait_until(lock, top.time);
+                    continue;
+                }
+                timers.pop();
+                auto it = versions.find(top.listener);
+                if (it == versions.end() || it->second != top.version)
+                    continue;
+                // Called under the lock, so remove() waits for it to return
+                top.time = top.listener->onDeadline(now);
+                timers.push(top);
+            }
+        }
+
+    private:
+        struct Entry {
+            std::chrono::steady_clock::time_point time;
+            DeadlineListener* listener;
+            uint64_t version;
+
+            bool operator>(const Entry& other) const noexcept
+            { return time > other.time; }
+        };
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> timers;
+        std::unordered_map<DeadlineListener*, uint64_t> versions;
+        uint64_t lastVersion = 0;
+    };
+
+    Executor executor;
+    TimerThread timerThread;
+    unsigned int maxRunLength;
+};
+
+#endif //THREADING_QUERYTHREADMULTIPLEXER_H
@@ -6,9 +6,12 @@
 #define THREADING_QUERYTHREADPOOLHANDLER_H
 
 #include <memory>
+#include <vector>
 
 #include "../ThreadPoolBase.h"
-#include "../utils/Condition.h"
+#include "QueryQueueBase.h"
+#include "../utils/EventCount.h"
+#include "../utils/MonotonicArena.h"
 
 template<typename _QueryThreadType>
 class QueryThreadPool : public ThreadPoolBase<_QueryThreadType> {
@@ -21,15 +24,13 @@ public:
     typedef typename QueryThreadType::QueryType QueryType;
     typedef typename QueryThreadType::QueryTypePtr QueryTypePtr;
     typedef typename QueryThreadType::ResultType ResultType;
-    typedef typename QueryThreadType::ResultTypePtr ResultTypePtr;
 
     /**
-     * Derived class constructor must create number of custom type threads,
-     * pass queue to their constructors and push them to vector
+     * Creates @p poolSize threads, each constructed from the queue and copies of @p args
      */
     template<typename... Args>
-    explicit QueryThreadPool(unsigned int poolSize, QueueTypePtr queue, Args&&... args)
-            : Base(poolSize, queue, std::forward<Args>(args)...)
+    explicit QueryThreadPool(unsigned int poolSize, QueueTypePtr queue, const Args&... args)
+            : Base(poolSize, queue, args...)
             , queryQueue(queue)
             , queueCondition(queryQueue->getHasQueryCondition()) {}
 
@@ -56,41 +57,78 @@ public:
         return queryQueue->size();
     };
 
-    Condition::SPtr getHasQueryCondition() const {
+    EventCount::SPtr getHasQueryCondition() const {
         return queueCondition;
     }
 
-    void putQuery(QueryTypePtr&& query) {
-        queryQueue->pushQuery(std::move(query));
+    /**
+     * @return scratch arena usage of every thread in the pool
+     */
+    std::vector<ArenaStats> getArenaStats() const {
+        std::vector<ArenaStats> stats;
+        std::lock_guard<std::mutex> lock(Base::threadsMutex);
+        for (const auto& thread : Base::threads)
+            stats.push_back(thread->getArenaStats());
+        return stats;
     }
 
-    void putQuery(const QueryTypePtr& query) {
-        queryQueue->pushQuery(query);
+    /**
+     * @brief Adds thread taking queries from the pool's queue, e.g. to replace a stalled one
+     * @param args arguments passed to thread constructor after the queue
+     */
+    template<typename... Args>
+    ThreadTypePtr addThread(Args&&... args) {
+        return Base::addThread(queryQueue, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Like addThread(), but calls @p configure with the thread before it is started
+     */
+    template<typename Configure, typename... Args>
+    ThreadTypePtr addConfiguredThread(Configure configure, Args&&... args) {
+        return Base::addConfiguredThread(std::move(configure), queryQueue, std::forward<Args>(args)...);
     }
 
-    ResultTypePtr putQueryAndGetResult(const QueryTypePtr &query) {
-        queryQueue->pushQuery(query);
+    PushStatus putQuery(QueryTypePtr&& query) {
+        return queryQueue->pushQuery(std::move(query));
+    }
+
+    PushStatus putQuery(const QueryTypePtr& query) {
+        return queryQueue->pushQuery(query);
+    }
+
+    /**
+     * If bounded queue rejects the query, it is completed with QueryOverloadedError
+     */
+    ResultType putQueryAndGetResult(const QueryTypePtr &query) {
+        pushOrOverload(query);
         return query->getResult();
     }
 
     template<typename... _Args>
-    void emplaceQuery(_Args&&... __args) {
-        queryQueue->emplaceQuery(std::forward<_Args>(__args)...);
+    PushStatus emplaceQuery(_Args&&... __args) {
+        return queryQueue->emplaceQuery(std::forward<_Args>(__args)...);
     }
 
     template<typename... _Args>
-    ResultTypePtr emplaceQueryAndGetResult(_Args&&... __args) {
+    ResultType emplaceQueryAndGetResult(_Args&&... __args) {
         QueryTypePtr query = std::make_shared<QueryType>(std::forward<_Args>(__args)...);
-        queryQueue->pushQuery(query);
+        pushOrOverload(query);
         return query->getResult();
     }
 
 protected:
+    void pushOrOverload(const QueryTypePtr& query) {
+        PushStatus status = queryQueue->pushQuery(query);
+        if (status == PushStatus::Rejected || status == PushStatus::TimedOut)
+            query->setOverloaded();
+    }
+
     /**
      * Query queue connected with thread to put queries to
      */
     QueueTypePtr queryQueue;
-    Condition::SPtr queueCondition;
+    EventCount::SPtr queueCondition;
 };
 
 
@@ -8,19 +8,28 @@
 #include <string>
 #include <memory>
 
-#include "QueryThreadBase.h"
+#include "QueryWorker.h"
 #include "QueryQueueBase.h"
 
-template<typename _QueryType>
-class QueryThreadPoolThread : public QueryThreadBase<QueryQueueBase<_QueryType>> {
-    typedef QueryThreadBase<QueryQueueBase<_QueryType>> Base;
+/**
+ * @brief QueryWorker with virtual onQuery() sharing the queue of QueryThreadPool
+ *
+ * While onQuery() waits for a query result, the thread processes other
+ * queries of the pool, so onQuery() may be re-entered.
+ *
+ * @tparam _QueueType type of the queue shared by the pool
+ */
+template<typename _QueryType, typename _QueueType = QueryQueueBase<_QueryType>>
+class QueryThreadPoolThread : public QueryWorker<_QueueType, VirtualQueryHandler,
+                                                 DynamicWait, NoTimeout, 1, HelpWhileWaiting> {
+    typedef QueryWorker<_QueueType, VirtualQueryHandler,
+                        DynamicWait, NoTimeout, 1, HelpWhileWaiting> Base;
 public :
     typedef typename Base::QueueType QueueType;
     typedef typename Base::QueueTypePtr QueueTypePtr;
     typedef typename Base::QueryType QueryType;
     typedef typename Base::QueryTypePtr QueryTypePtr;
     typedef typename Base::ResultType ResultType;
-    typedef typename Base::ResultTypePtr ResultTypePtr;
 
     explicit QueryThreadPoolThread(const QueueTypePtr& queue) :
             Base(queue) { }
@@ -30,40 +39,8 @@ public :
     QueryThreadPoolThread(QueryThreadPoolThread&& other) = delete;
     QueryThreadPoolThread& operator=(QueryThreadPoolThread&& other) = delete;
 
-private:
-    void beforeThreadLoop() override {}
-    void afterThreadLoop() override {}
-    void threadFunction() override
-    {
-        beforeThreadLoop();
-        while (Base::isRunning())
-        {
-            QueryTypePtr query;
-            if (Base::queryQueue->isEmpty())
-            {
-                Base::queueCondition->wait(
-                            WAKE_IF(!Base::queryQueue->isEmpty() ||
-                                    Base::isStopped()));
-            }
-
-            if (Base::isStopped())
-                break;
-
-            try {
-                query = Base::queryQueue->getQuery();
-            } catch (std::runtime_error& e) {
-                // Another thread has taken the query
-                continue;
-            }
-
-            onQuery(std::move(query));
-        }
-        Base::queryQueue->clear();
-        afterThreadLoop();
-    }
-
 protected:
-    virtual void onQuery(QueryTypePtr query) = 0;
+    void onQuery(QueryTypePtr query) override = 0;
 };
 
 
@@ -0,0 +1,326 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_QUERYTHREADREACTOR_H
+#define THREADING_QUERYTHREADREACTOR_H
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "QueryThreadBase.h"
+#include "EventFdQueryQueue.h"
+
+/**
+ * @class QueryThreadReactor
+ * @brief Query thread which also services file descriptors and timers (Linux only)
+ *
+ * The thread blocks in epoll_wait() on the queue eventfd, registered file
+ * descriptors and timerfd timers at once and dispatches every readiness
+ * event to its handler on the thread itself, so socket or timer work does
+ * not need a second thread and a hand-off.
+ * Queries are processed by onQuery() in batches of at most getQueryBatch()
+ * per wakeup, so a busy queue does not starve file descriptors.
+ *
+ * Descriptors and timers can be added and removed from any thread, handlers
+ * are always called on the reactor thread. A handler may still be called
+ * once after it was removed from another thread.
+ * WaitStrategy is not used, the thread always blocks in epoll_wait().
+ * Errors of epoll, eventfd and timerfd in the constructor and in the calls above
+ * are reported with std::system_error. If epoll_wait() itself fails, the thread
+ * cannot throw: it calls fail(), cancels queued queries and returns,
+ * isFailed() is true then and getWaitError() tells the reason.
+ */
+template<typename _QueryType>
+class QueryThreadReactor : public QueryThreadBase<EventFdQueryQueue<_QueryType>> {
+    typedef QueryThreadBase<EventFdQueryQueue<_QueryType>> Base;
+public:
+    typedef typename Base::QueueType QueueType;
+    typedef typename Base::QueueTypePtr QueueTypePtr;
+    typedef typename Base::QueryType QueryType;
+    typedef typename Base::QueryTypePtr QueryTypePtr;
+    typedef typename Base::ResultType ResultType;
+
+    /// Receives epoll events (EPOLLIN, EPOLLOUT, EPOLLERR...) of a descriptor
+    typedef std::function<void(uint32_t events)> FdHandler;
+    typedef std::function<void()> TimerHandler;
+    /// Timer identifier, it is the timerfd of the timer
+    typedef int TimerId;
+
+    explicit QueryThreadReactor(unsigned int queryBatch = 64) :
+            QueryThreadReactor(std::make_shared<QueueType>(), queryBatch) { }
+
+    explicit QueryThreadReactor(const QueueTypePtr& queue, unsigned int queryBatch = 64) :
+            Base(queue), epollFd(::epoll_create1(EPOLL_CLOEXEC)), queryBatch(queryBatch)
+    {
+        if (epollFd < 0)
+            throw std::system_error(errno, std::system_category(), "epoll_create1");
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = Base::queryQueue->getEventFd();
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, event.data.fd, &event) < 0) {
+            int error = errno;
+            ::close(epollFd);
+            throw std::system_error(error, std::system_category(), "epoll_ctl");
+        }
+    }
+
+    ~QueryThreadReactor() override
+    {
+        // Handlers and descriptors must outlive the thread, the eventfd wakes it from epoll_wait()
+        stopThread();
+        Base::joinThread();
+        for (auto& entry : handlers)
+            if (entry.second->isTimer)
+                ::close(entry.first);
+        closeRemovedTimers();
+        ::close(epollFd);
+    }
+
+    QueryThreadReactor(const QueryThreadReactor&) = delete;
+    QueryThreadReactor& operator=(const QueryThreadReactor&) = delete;
+    QueryThreadReactor(QueryThreadReactor&& other) = delete;
+    QueryThreadReactor& operator=(QueryThreadReactor&& other) = delete;
+
+    void stopThread() override
+    {
+        Base::stopThread();
+        Base::queryQueue->signal();
+    }
+
+    /**
+     * @brief Starts watching @p fd, the reactor does not own the descriptor
+     * @param events epoll events to watch, e.g. EPOLLIN | EPOLLOUT, EPOLLET is allowed
+     */
+    void addFd(int fd, uint32_t events, FdHandler handler)
+    {
+        std::shared_ptr<Handler> entry = std::make_shared<Handler>();
+        entry->onEvents = std::move(handler);
+        {
+            std::lock_guard<std::mutex> lock(handlersMutex);
+            handlers[fd] = std::move(entry);
+        }
+        control(EPOLL_CTL_ADD, fd, events, [this, fd] { eraseHandler(fd); });
+    }
+
+    /**
+     * @brief Changes watched events of @p fd
+     */
+    void modifyFd(int fd, uint32_t events)
+    { control(EPOLL_CTL_MOD, fd, events, [] { }); }
+
+    /**
+     * @brief Stops watching @p fd, must be called before the descriptor is closed
+     */
+    void removeFd(int fd)
+    {
+        ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        eraseHandler(fd);
+    }
+
+    /**
+     * @brief Starts a timer
+     * @param initial delay before the first expiration, must be positive
+     * @param interval period of further expirations, 0 for a one shot timer
+     * @return identifier to remove the timer with, one shot timers must be removed too
+     */
+    TimerId addTimer(std::chrono::nanoseconds initial, std::chrono::nanoseconds interval,
+                     TimerHandler handler)
+    {
+        int fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (fd < 0)
+            throw std::system_error(errno, std::system_category(), "timerfd_create");
+        itimerspec spec{};
+        spec.it_value = toTimespec(initial);
+        spec.it_interval = toTimespec(interval);
+        if (::timerfd_settime(fd, 0, &spec, nullptr) < 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::system_category(), "timerfd_settime");
+        }
+
+        std::shared_ptr<Handler> entry = std::make_shared<Handler>();
+        entry->onTimer = std::move(handler);
+        entry->isTimer = true;
+        {
+            std::lock_guard<std::mutex> lock(handlersMutex);
+            handlers[fd] = std::move(entry);
+        }
+        control(EPOLL_CTL_ADD, fd, EPOLLIN, [this, fd] {
+            eraseHandler(fd);
+            ::close(fd);
+        });
+        return fd;
+    }
+
+    /**
+     * @brief Stops and destroys the timer
+     *
+     * The timerfd is closed by the reactor thread before it waits for events again,
+     * so a concurrent dispatch never reads a closed or reused descriptor.
+     */
+    void removeTimer(TimerId timer)
+    {
+        ::epoll_ctl(epollFd, EPOLL_CTL_DEL, timer, nullptr);
+        {
+            std::lock_guard<std::mutex> lock(handlersMutex);
+            if (handlers.erase(timer) == 0)
+                return;
+            removedTimers.push_back(timer);
+        }
+        Base::queryQueue->signal();
+    }
+
+    unsigned int getQueryBatch() const noexcept
+    { return queryBatch; }
+
+    /**
+     * @return error of epoll_wait() which made the thread fail, empty if it has not failed
+     */
+    std::error_code getWaitError() const noexcept
+    { return std::error_code(waitError.load(std::memory_order_relaxed), std::system_category()); }
+
+protected:
+    virtual void onQuery(QueryTypePtr query) = 0;
+
+private:
+    struct Handler {
+        FdHandler onEvents;
+        TimerHandler onTimer;
+        bool isTimer = false;
+    };
+
+    static timespec toTimespec(std::chrono::nanoseconds time)
+    {
+        timespec spec{};
+        spec.tv_sec = static_cast<time_t>(time.count() / 1000000000);
+        spec.tv_nsec = static_cast<long>(time.count() % 1000000000);
+        return spec;
+    }
+
+    template<typename _Rollback>
+    void control(int operation, int fd, uint32_t events, _Rollback rollback)
+    {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        if (::epoll_ctl(epollFd, operation, fd, &event) < 0) {
+            int error = errno;
+            rollback();
+            throw std::system_error(error, std::system_category(), "epoll_ctl");
+        }
+    }
+
+    bool eraseHandler(int fd)
+    {
+        std::lock_guard<std::mutex> lock(handlersMutex);
+        return handlers.erase(fd) != 0;
+    }
+
+    /*
+     * Called by the reactor thread between epoll_wait() batches, when no event
+     * of a removed timer can be dispatched anymore, or after the thread is joined
+     */
+    void closeRemovedTimers()
+    {
+        std::vector<int> timers;
+        {
+            std::lock_guard<std::mutex> lock(handlersMutex);
+            timers.swap(removedTimers);
+        }
+        for (int timer : timers)
+            ::close(timer);
+    }
+
+    void threadFunction() override
+    {
+        const int maxEvents = 64;
+        epoll_event events[maxEvents];
+        const int queueFd = Base::queryQueue->getEventFd();
+
+        Base::beforeThreadLoop();
+        while (Base::isRunning())
+        {
+            closeRemovedTimers();
+            int count = ::epoll_wait(epollFd, events, maxEvents, -1);
+            if (count < 0) {
+                if (errno == EINTR)
+                    continue;
+                waitError.store(errno, std::memory_order_relaxed);
+                Base::fail();
+                break;
+            }
+
+            for (int i = 0; i < count && Base::isRunning(); i++) {
+                if (events[i].data.fd == queueFd)
+                    processQueries();
+                else
+                    dispatch(events[i].data.fd, events[i].events);
+            }
+        }
+        Base::queryQueue->clear();
+        Base::afterThreadLoop();
+    }
+
+    void processQueries()
+    {
+        Base::queryQueue->consumeNotification();
+        for (unsigned int i = 0; i < queryBatch; i++) {
+            if (!Base::isRunning())
+                return;
+            QueryTypePtr query;
+            try {
+                query = Base::queryQueue->getQuery();
+            } catch (std::runtime_error& e) {
+                // Queue is empty or has shed all its queries
+                return;
+            }
+            Base::processQuery(std::move(query), [this](QueryTypePtr q) { onQuery(std::move(q)); });
+        }
+        // Batch is exhausted, come back after other ready descriptors
+        if (!Base::queryQueue->isEmpty())
+            Base::queryQueue->signal();
+    }
+
+    void dispatch(int fd, uint32_t events)
+    {
+        std::shared_ptr<Handler> handler;
+        {
+            std::lock_guard<std::mutex> lock(handlersMutex);
+            auto it = handlers.find(fd);
+            if (it == handlers.end())
+                return;
+            handler = it->second;
+        }
+
+        if (!handler->isTimer) {
+            handler->onEvents(events);
+            return;
+        }
+        uint64_t expirations;
+        if (::read(fd, &expirations, sizeof(expirations)) == sizeof(expirations))
+            handler->onTimer();
+    }
+
+    const int epollFd;
+    const unsigned int queryBatch;
+    std::mutex handlersMutex;
+    std::unordered_map<int, std::shared_ptr<Handler>> handlers;
+    /// Timerfds removed from epoll and waiting to be closed by the reactor thread
+    std::vector<int> removedTimers;
+    std::atomic<int> waitError{0};
+};
+
+#endif //THREADING_QUERYTHREADREACTOR_H
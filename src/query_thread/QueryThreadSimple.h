@@ -8,55 +8,39 @@
 #include <string>
 #include <memory>
 
-#include "QueryThreadBase.h"
+#include "QueryWorker.h"
 #include "QueryQueueBase.h"
 
-template<typename _QueryType>
-class QueryThreadSimple : public QueryThreadBase<QueryQueueBase<_QueryType>> {
-    typedef QueryThreadBase<QueryQueueBase<_QueryType>> Base;
+/**
+ * @brief QueryWorker with virtual onQuery() and its own queue by default
+ * @tparam _QueueType queue to take queries from, QueryQueueBase or a queue derived from it,
+ *         e.g. QueryQueueBase<_QueryType, IntrusiveQueryList<_QueryType>>
+ */
+template<typename _QueryType, typename _QueueType = QueryQueueBase<_QueryType>>
+class QueryThreadSimple : public QueryWorker<_QueueType> {
+    typedef QueryWorker<_QueueType> Base;
 public :
     typedef typename Base::QueueType QueueType;
     typedef typename Base::QueueTypePtr QueueTypePtr;
     typedef typename Base::QueryType QueryType;
     typedef typename Base::QueryTypePtr QueryTypePtr;
     typedef typename Base::ResultType ResultType;
-    typedef typename Base::ResultTypePtr ResultTypePtr;
 
     QueryThreadSimple() :
-            Base(QueueType::create()) { }
+            Base(std::make_shared<QueueType>()) { }
+    /**
+     * @param queue queue to take queries from, e.g. a queue derived from QueryQueueBase
+     */
+    explicit QueryThreadSimple(const QueueTypePtr& queue) :
+            Base(queue) { }
     ~QueryThreadSimple() = default;
     QueryThreadSimple(const QueryThreadSimple&) = delete;
     QueryThreadSimple& operator=(const QueryThreadSimple&) = delete;
     QueryThreadSimple(QueryThreadSimple&& other) = delete;
     QueryThreadSimple& operator=(QueryThreadSimple&& other) = delete;
 
-private:
-    void beforeThreadLoop() override {}
-    void afterThreadLoop() override {}
-    void threadFunction() override
-    {
-        beforeThreadLoop();
-        while (Base::isRunning())
-        {
-            if (Base::queryQueue->isEmpty())
-            {
-                Base::queueCondition->wait(
-                            WAKE_IF(!Base::queryQueue->isEmpty() ||
-                                      Base::isStopped()));
-            }
-
-            if (Base::isStopped())
-                break;
-
-            auto query = Base::queryQueue->getQuery();
-            onQuery(std::move(query));
-        }
-        Base::queryQueue->clear();
-        afterThreadLoop();
-    }
-
 protected:
-    virtual void onQuery(QueryTypePtr query) = 0;
+    void onQuery(QueryTypePtr query) override = 0;
 };
 
 
@@ -8,12 +8,17 @@
 #include <string>
 #include <memory>
 
-#include "QueryThreadBase.h"
+#include "QueryWorker.h"
 #include "QueryQueueBase.h"
 
-template<typename _QueryType>
-class QueryThreadTimeout : public QueryThreadBase<QueryQueueBase<_QueryType>> {
-    typedef QueryThreadBase<QueryQueueBase<_QueryType>> Base;
+/**
+ * @brief QueryWorker with virtual onQuery() and onTimeout() called when no query arrives within the timeout
+ * @tparam _QueueType queue type, as for QueryThreadSimple
+ */
+template<typename _QueryType, typename _QueueType = QueryQueueBase<_QueryType>>
+class QueryThreadTimeout
+        : public QueryWorker<_QueueType, VirtualQueryHandler, DynamicWait, WithTimeout> {
+    typedef QueryWorker<_QueueType, VirtualQueryHandler, DynamicWait, WithTimeout> Base;
 public:
     typedef typename Base::QueueType QueueType;
     typedef typename Base::QueueTypePtr QueueTypePtr;
@@ -22,56 +27,24 @@ public:
     typedef typename Base::ResultType ResultType;
 
     explicit QueryThreadTimeout(std::chrono::milliseconds timeoutMs) :
-            Base(QueueType::create()),
-            timeout(timeoutMs) { }
+            Base(std::make_shared<QueueType>(), WithTimeout(timeoutMs)) { }
+    /**
+     * @param queue queue to take queries from, e.g. a queue derived from QueryQueueBase
+     */
+    QueryThreadTimeout(std::chrono::milliseconds timeoutMs, const QueueTypePtr& queue) :
+            Base(queue, WithTimeout(timeoutMs)) { }
     ~QueryThreadTimeout() = default;
     QueryThreadTimeout(const QueryThreadTimeout&) = delete;
     QueryThreadTimeout& operator=(const QueryThreadTimeout&) = delete;
     QueryThreadTimeout(QueryThreadTimeout&& other) = delete;
     QueryThreadTimeout& operator=(QueryThreadTimeout&& other) = delete;
 
-private:
-    std::chrono::milliseconds timeout;
-
-    void beforeThreadLoop() override {}
-    void afterThreadLoop() override {}
-    void threadFunction() override
-    {
-        beforeThreadLoop();
-        bool wakenOnSignal = true;
-        while (Base::isRunning())
-        {
-            if (Base::queryQueue->isEmpty())
-            {
-                    wakenOnSignal = Base::queueCondition->wait_for(timeout,
-                                                                WAKE_IF(!Base::queryQueue->isEmpty() ||
-                                                                        Base::isStopped()));
-            }
-            else
-            {
-                wakenOnSignal = true;
-            }
-
-            if (Base::isStopped())
-                break;
-
-            if (wakenOnSignal)
-            {
-                auto query = Base::queryQueue->getQuery();
-                onQuery(std::move(query));
-            } else
-                onTimeout();
-        }
-        Base::queryQueue->clear();
-        afterThreadLoop();
-    }
-
 protected:
     /**
      * Overriding function must set result to query.
      */
-    virtual void onQuery(QueryTypePtr query) = 0;
-    virtual void onTimeout() = 0;
+    void onQuery(QueryTypePtr query) override = 0;
+    void onTimeout() override = 0;
 };
 
 
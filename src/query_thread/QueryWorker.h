@@ -0,0 +1,546 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_QUERYWORKER_H
+#define THREADING_QUERYWORKER_H
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include "QueryThreadBase.h"
+#include "QueryQueueBase.h"
+#include "WorkerContext.h"
+#include "utils/MonotonicArena.h"
+#include "utils/WaitStrategy.h"
+
+/**
+ * @struct VirtualQueryHandler
+ * @brief Handler policy of QueryWorker which calls virtual onQuery() and onTimeout()
+ *
+ * Used by QueryThreadSimple, QueryThreadTimeout and QueryThreadPoolThread,
+ * which are subclassed to handle queries.
+ */
+struct VirtualQueryHandler { };
+
+/**
+ * @struct VirtualBatchHandler
+ * @brief Handler policy of a batching QueryWorker which calls virtual onBatch() and onTick()
+ *
+ * Used by QueryThreadBatching.
+ */
+struct VirtualBatchHandler { };
+
+/**
+ * @struct HandlerTakesArena
+ * @brief Tells whether handler is called as @code handler(query, arena) @endcode
+ * or @code handler(batch, arena) @endcode
+ */
+template<typename _Handler, typename _Arg, typename = void>
+struct HandlerTakesArena : std::false_type { };
+
+template<typename _Handler, typename _Arg>
+struct HandlerTakesArena<_Handler, _Arg, decltype(void(std::declval<_Handler&>()(
+        std::declval<_Arg>(), std::declval<MonotonicArena&>())))> : std::true_type { };
+
+/**
+ * @struct HandlerHasTick
+ * @brief Tells whether handler provides @code void onTick() @endcode
+ */
+template<typename _Handler, typename = void>
+struct HandlerHasTick : std::false_type { };
+
+template<typename _Handler>
+struct HandlerHasTick<_Handler, decltype(void(std::declval<_Handler&>().onTick()))> : std::true_type { };
+
+/**
+ * @class QueryHandlerHolder
+ * @brief Stores handler functor of QueryWorker and calls it
+ *
+ * Handler must provide @code void operator()(QueryTypePtr query) @endcode
+ * or, to allocate scratch memory from the worker's arena,
+ * @code void operator()(QueryTypePtr query, MonotonicArena& arena) @endcode
+ * and, if the worker has a timeout, @code void onTimeout() @endcode
+ * Handler of a batching worker provides
+ * @code void operator()(std::vector<QueryTypePtr>& batch) @endcode
+ * (optionally with the arena) and, optionally, @code void onTick() @endcode
+ * Every thread of a pool gets its own copy of the handler.
+ */
+template<typename _QueryTypePtr, typename _Handler>
+class QueryHandlerHolder {
+public:
+    explicit QueryHandlerHolder(_Handler handler = _Handler()) : handler(std::move(handler)) { }
+
+    _Handler& getHandler() noexcept
+    { return handler; }
+
+protected:
+    void handleQuery(_QueryTypePtr&& query, MonotonicArena& arena)
+    { call(std::move(query), arena, HandlerTakesArena<_Handler, _QueryTypePtr>()); }
+
+    void handleTimeout()
+    { handler.onTimeout(); }
+
+    void handleBatch(std::vector<_QueryTypePtr>& batch, MonotonicArena& arena)
+    { call(batch, arena, HandlerTakesArena<_Handler, std::vector<_QueryTypePtr>&>()); }
+
+    void handleTick()
+    { tick(HandlerHasTick<_Handler>()); }
+
+private:
+    void tick(std::false_type) { }
+
+    void tick(std::true_type)
+    { handler.onTick(); }
+
+    template<typename _Arg>
+    void call(_Arg&& arg, MonotonicArena&, std::false_type)
+    { handler(std::forward<_Arg>(arg)); }
+
+    template<typename _Arg>
+    void call(_Arg&& arg, MonotonicArena& arena, std::true_type)
+    { handler(std::forward<_Arg>(arg), arena); }
+
+    _Handler handler;
+};
+
+template<typename _QueryTypePtr>
+class QueryHandlerHolder<_QueryTypePtr, VirtualQueryHandler> {
+public:
+    virtual ~QueryHandlerHolder() = default;
+
+protected:
+    /**
+     * Overriding function must set result to query.
+     */
+    virtual void onQuery(_QueryTypePtr query) = 0;
+
+    /**
+     * Called when no query arrives within the timeout, if the worker has one
+     */
+    virtual void onTimeout() {}
+
+    /// onQuery() reaches the arena through getArena()
+    void handleQuery(_QueryTypePtr&& query, MonotonicArena&)
+    { onQuery(std::move(query)); }
+
+    void handleTimeout()
+    { onTimeout(); }
+};
+
+template<typename _QueryTypePtr>
+class QueryHandlerHolder<_QueryTypePtr, VirtualBatchHandler> {
+public:
+    virtual ~QueryHandlerHolder() = default;
+
+protected:
+    /**
+     * Overriding function must set result to every query of the batch.
+     * Batch is cleared after it returns.
+     */
+    virtual void onBatch(std::vector<_QueryTypePtr>& queries) = 0;
+
+    /**
+     * Called every tick period of the worker if it is not 0
+     */
+    virtual void onTick() {}
+
+    /// onBatch() reaches the arena through getArena()
+    void handleBatch(std::vector<_QueryTypePtr>& batch, MonotonicArena&)
+    { onBatch(batch); }
+
+    void handleTick()
+    { onTick(); }
+};
+
+/**
+ * @struct NoTimeout
+ * @brief Timeout policy of QueryWorker: waits for queries without a time limit
+ */
+struct NoTimeout {
+    enum : bool { enabled = false };
+
+    template<typename _WaitPolicy, typename ConditionType, typename Predicate>
+    bool wait(WaitStrategy& strategy, ConditionType& cond, Predicate p) const
+    {
+        _WaitPolicy::wait(strategy, cond, p);
+        return true;
+    }
+};
+
+/**
+ * @struct WithTimeout
+ * @brief Timeout policy of QueryWorker: handler's onTimeout() is called
+ * when no query arrives within the timeout
+ */
+struct WithTimeout {
+    enum : bool { enabled = true };
+
+    explicit WithTimeout(std::chrono::milliseconds timeout) : timeout(timeout) { }
+
+    template<typename _WaitPolicy, typename ConditionType, typename Predicate>
+    bool wait(WaitStrategy& strategy, ConditionType& cond, Predicate p) const
+    { return _WaitPolicy::waitFor(strategy, cond, timeout, p); }
+
+    std::chrono::milliseconds timeout;
+};
+
+/**
+ * @struct NoHelping
+ * @brief Help policy of QueryWorker: a handler waiting for a result just blocks
+ *
+ * Keeps a serial thread serial: its queries are never processed nested in each other.
+ */
+struct NoHelping {
+    enum : bool { enabled = false };
+};
+
+/**
+ * @struct HelpWhileWaiting
+ * @brief Help policy of QueryWorker: while a handler waits for a query result,
+ * the worker processes other queries of its queue, see WorkerContext
+ *
+ * Meant for pool workers running nested fork-join work, whose handlers must
+ * tolerate being re-entered by another query of the queue.
+ */
+struct HelpWhileWaiting {
+    enum : bool { enabled = true };
+};
+
+/**
+ * @struct ProcessEach
+ * @brief Collect policy of QueryWorker: every query is handled as soon as it is taken
+ */
+struct ProcessEach {
+    enum : bool { batching = false };
+};
+
+/**
+ * @struct BatchWindow
+ * @brief Collect policy of QueryWorker: queries are handed to the handler in batches
+ *
+ * Queries are accumulated until either maxBatchSize of them are collected
+ * or maxDelay has passed since the first query of the batch was taken,
+ * then the handler gets them all at once. So under light traffic a query waits
+ * at most maxDelay, and under heavy traffic batches are full.
+ * If tickPeriod is not 0, handler's onTick() is called at that rate regardless of traffic.
+ * Queries left in the batch when the worker is stopped are still handled.
+ */
+struct BatchWindow {
+    enum : bool { batching = true };
+
+    /**
+     * @param maxBatchSize batch is flushed as soon as it has this many queries
+     * @param maxDelay batch is flushed when its first query has waited this long
+     * @param tickPeriod how often to call onTick(), 0 to never call it
+     */
+    BatchWindow(unsigned int maxBatchSize, std::chrono::milliseconds maxDelay,
+                std::chrono::milliseconds tickPeriod = std::chrono::milliseconds(0)) :
+            maxBatchSize(std::max(1u, maxBatchSize)), maxDelay(maxDelay), tickPeriod(tickPeriod) { }
+
+    bool hasTick() const noexcept
+    { return tickPeriod.count() > 0; }
+
+    unsigned int maxBatchSize;
+    std::chrono::milliseconds maxDelay;
+    std::chrono::milliseconds tickPeriod;
+};
+
+/**
+ * @class QueryWorker
+ * @brief Query thread assembled from compile-time policies
+ *
+ * @tparam _QueueType queue to take queries from; if it is a final class,
+ *         the compiler can resolve its virtual calls statically
+ * @tparam _Handler functor handling queries, stored by value and called directly,
+ *         or VirtualQueryHandler to override onQuery()
+ * @tparam _WaitPolicy DynamicWait, BlockingWait or SpinningWait
+ * @tparam _TimeoutPolicy NoTimeout or WithTimeout
+ * @tparam _BatchSize maximal number of queries processed after one wake up
+ *         without checking whether the thread is stopped
+ * @tparam _HelpPolicy NoHelping or HelpWhileWaiting
+ * @tparam _CollectPolicy ProcessEach or BatchWindow; a batching worker takes
+ *         no timeout and does not help, its handler gets whole batches
+ *
+ * With a functor handler the whole loop is instantiated for the handler type,
+ * so handling a query costs no virtual call. Use it directly or in QueryThreadPool:
+ * @code QueryThreadPool<QueryWorker<QueryQueueBase<MyQuery>, MyHandler>> pool(4, queue, MyHandler()); @endcode
+ */
+template<typename _QueueType,
+         typename _Handler = VirtualQueryHandler,
+         typename _WaitPolicy = DynamicWait,
+         typename _TimeoutPolicy = NoTimeout,
+         unsigned int _BatchSize = 1,
+         typename _HelpPolicy = NoHelping,
+         typename _CollectPolicy = ProcessEach>
+class QueryWorker : public QueryThreadBase<_QueueType>,
+                    public QueryHandlerHolder<typename _QueueType::QueryTypePtr, _Handler>,
+                    public WorkerContext {
+    typedef QueryThreadBase<_QueueType> Base;
+    typedef QueryHandlerHolder<typename _QueueType::QueryTypePtr, _Handler> HandlerBase;
+    typedef std::integral_constant<bool, _CollectPolicy::batching> Batching;
+    static_assert(_BatchSize > 0, "Batch size must be positive");
+    static_assert(!_CollectPolicy::batching || (!_TimeoutPolicy::enabled && !_HelpPolicy::enabled),
+                  "Batching worker ticks instead of timing out and does not help");
+public:
+    typedef typename Base::QueueType QueueType;
+    typedef typename Base::QueueTypePtr QueueTypePtr;
+    typedef typename Base::QueryType QueryType;
+    typedef typename Base::QueryTypePtr QueryTypePtr;
+    typedef typename Base::ResultType ResultType;
+    typedef _Handler HandlerType;
+    typedef _TimeoutPolicy TimeoutPolicy;
+    typedef _CollectPolicy CollectPolicy;
+    typedef std::vector<QueryTypePtr> Batch;
+
+    explicit QueryWorker(const QueueTypePtr& queue) :
+            Base(queue) { }
+
+    QueryWorker(const QueueTypePtr& queue, _TimeoutPolicy timeoutPolicy) :
+            Base(queue), timeoutPolicy(timeoutPolicy) { }
+
+    QueryWorker(const QueueTypePtr& queue, _CollectPolicy collectPolicy) :
+            Base(queue), collectPolicy(collectPolicy) { }
+
+    template<typename _H = _Handler,
+             typename = typename std::enable_if<!std::is_same<_H, VirtualQueryHandler>::value
+                                                && !std::is_same<_H, VirtualBatchHandler>::value>::type>
+    QueryWorker(const QueueTypePtr& queue, _H handler, _TimeoutPolicy timeoutPolicy = _TimeoutPolicy(),
+                _CollectPolicy collectPolicy = _CollectPolicy()) :
+            Base(queue), HandlerBase(std::move(handler)),
+            timeoutPolicy(timeoutPolicy), collectPolicy(collectPolicy) { }
+
+    ~QueryWorker() override = default;
+    QueryWorker(const QueryWorker&) = delete;
+    QueryWorker& operator=(const QueryWorker&) = delete;
+    QueryWorker(QueryWorker&& other) = delete;
+    QueryWorker& operator=(QueryWorker&& other) = delete;
+
+protected:
+    void threadFunction() override
+    {
+        WorkerContext::Scope context(_HelpPolicy::enabled ? this : nullptr);
+        this->beforeThreadLoop();
+        startCollecting(Batching());
+        while (Base::isRunning())
+        {
+            bool hasQuery = true;
+            if (Base::queryQueue->isEmpty())
+                hasQuery = waitForQuery(Batching());
+
+            if (Base::isStopped())
+                break;
+
+            if (!hasQuery) {
+                processTimeout(std::integral_constant<bool, _TimeoutPolicy::enabled>());
+                continue;
+            }
+
+            processQueries(Batching());
+        }
+        finishCollecting(Batching());
+        Base::queryQueue->clear();
+        this->afterThreadLoop();
+    }
+
+    /**
+     * @brief Processes one query of the queue while a handler waits for a result
+     */
+    bool runPendingQuery() override
+    { return runPendingQuery(Batching()); }
+
+    bool hasPendingQuery() override
+    { return !Base::queryQueue->isEmpty(); }
+
+    EventCount::SPtr getPendingQueryCondition() override
+    { return Base::queueCondition; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void startCollecting(std::false_type) { }
+
+    bool waitForQuery(std::false_type)
+    {
+        return timeoutPolicy.template wait<_WaitPolicy>(
+                Base::getWaitStrategy(), *Base::queueCondition,
+                WAKE_IF(!Base::queryQueue->isEmpty() || Base::isStopped()));
+    }
+
+    void processQueries(std::false_type)
+    {
+        for (unsigned int i = 0; i < _BatchSize; i++) {
+            QueryTypePtr query;
+            try {
+                query = Base::queryQueue->getQuery();
+            } catch (std::runtime_error& e) {
+                // Another thread has taken the query or queue has shed it
+                break;
+            }
+            Base::processQuery(std::move(query), [this](QueryTypePtr q) {
+                this->handleQuery(std::move(q), Base::arena);
+            });
+            if (_BatchSize > 1 && (Base::isStopped() || Base::queryQueue->isEmpty()))
+                break;
+        }
+    }
+
+    void finishCollecting(std::false_type) { }
+
+    bool runPendingQuery(std::false_type)
+    {
+        if (Base::queryQueue->isEmpty())
+            return false;
+        QueryTypePtr query;
+        try {
+            query = Base::queryQueue->getQuery();
+        } catch (std::runtime_error& e) {
+            return false;
+        }
+        Base::processQuery(std::move(query), [this](QueryTypePtr q) {
+            this->handleQuery(std::move(q), Base::arena);
+        });
+        return true;
+    }
+
+    /// Batching worker never helps
+    bool runPendingQuery(std::true_type)
+    { return false; }
+
+    void startCollecting(std::true_type)
+    {
+        batch.reserve(collectPolicy.maxBatchSize);
+        nextTick = Clock::now() + collectPolicy.tickPeriod;
+    }
+
+    /**
+     * @brief Waits until a query arrives or the batch or the tick is due
+     */
+    bool waitForQuery(std::true_type)
+    {
+        if (batch.empty() && !collectPolicy.hasTick()) {
+            _WaitPolicy::wait(Base::getWaitStrategy(), *Base::queueCondition,
+                        WAKE_IF(!Base::queryQueue->isEmpty() || Base::isStopped()));
+            return true;
+        }
+        Clock::time_point deadline = Clock::time_point::max();
+        if (!batch.empty())
+            deadline = batchDeadline;
+        if (collectPolicy.hasTick())
+            deadline = std::min(deadline, nextTick);
+        Clock::time_point now = Clock::now();
+        if (deadline > now)
+            _WaitPolicy::waitFor(Base::getWaitStrategy(), *Base::queueCondition, deadline - now,
+                        WAKE_IF(!Base::queryQueue->isEmpty() || Base::isStopped()));
+        return true;
+    }
+
+    /**
+     * @brief Moves queries from the queue to the batch, then flushes and ticks what is due
+     */
+    void processQueries(std::true_type)
+    {
+        while (batch.size() < collectPolicy.maxBatchSize && !Base::queryQueue->isEmpty()) {
+            QueryTypePtr query;
+            try {
+                query = Base::queryQueue->getQuery();
+            } catch (std::runtime_error& e) {
+                // Another thread has taken the query or queue has shed it
+                break;
+            }
+            addToBatch(std::move(query));
+        }
+
+        Clock::time_point now = Clock::now();
+        if (batch.size() >= collectPolicy.maxBatchSize || (!batch.empty() && now >= batchDeadline))
+            flushBatch();
+        if (collectPolicy.hasTick() && now >= nextTick) {
+            tick();
+            nextTick += collectPolicy.tickPeriod;
+            // Missed ticks are skipped rather than run back to back
+            if (nextTick <= now)
+                nextTick = now + collectPolicy.tickPeriod;
+        }
+    }
+
+    void finishCollecting(std::true_type)
+    {
+        while (!batch.empty())
+            flushBatch();
+    }
+
+    void addToBatch(QueryTypePtr&& query)
+    {
+        if (batch.empty())
+            batchDeadline = Clock::now() + collectPolicy.maxDelay;
+        batch.push_back(std::move(query));
+    }
+
+    /*
+     * Hands the batch to the handler. If the queue tracks processing,
+     * queries it hands back start the next batch.
+     */
+    void flushBatch()
+    {
+        Heartbeat* heartbeat = Base::getHeartbeat();
+        if (heartbeat)
+            heartbeat->begin(typeid(*batch.front()).name());
+        this->handleBatch(batch, Base::arena);
+        if (heartbeat)
+            heartbeat->end();
+        Base::arena.reset();
+
+        if (!Base::queryQueue->tracksProcessing()) {
+            batch.clear();
+            return;
+        }
+        Batch processed;
+        processed.swap(batch);
+        batch.reserve(collectPolicy.maxBatchSize);
+        for (const auto& query : processed) {
+            QueryTypePtr next = Base::queryQueue->queryProcessed(query);
+            if (next)
+                addToBatch(std::move(next));
+        }
+    }
+
+    void tick()
+    {
+        Heartbeat* heartbeat = Base::getHeartbeat();
+        if (heartbeat)
+            heartbeat->begin(typeid(*this).name());
+        this->handleTick();
+        if (heartbeat)
+            heartbeat->end();
+        Base::arena.reset();
+    }
+
+    /// NoTimeout never times out, so handler does not need onTimeout()
+    void processTimeout(std::false_type) { }
+
+    void processTimeout(std::true_type)
+    {
+        Heartbeat* heartbeat = Base::getHeartbeat();
+        if (heartbeat)
+            heartbeat->begin(typeid(*this).name());
+        this->handleTimeout();
+        if (heartbeat)
+            heartbeat->end();
+        Base::arena.reset();
+    }
+
+    _TimeoutPolicy timeoutPolicy;
+    _CollectPolicy collectPolicy;
+    /// Collected queries of a batching worker, reused between batches
+    Batch batch;
+    Clock::time_point batchDeadline;
+    Clock::time_point nextTick;
+};
+
+#endif //THREADING_QUERYWORKER_H
@@ -0,0 +1,229 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_SHAREDQUERYTHREAD_H
+#define THREADING_SHAREDQUERYTHREAD_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <typeinfo>
+
+#include "QueryThreadBase.h"
+#include "QueryQueueBase.h"
+#include "QueryThreadMultiplexer.h"
+#include "utils/UniqueFunction.h"
+
+/**
+ * @class SharedQueryQueue
+ * @brief Queue of SharedQueryThread, schedules its thread when a query is pushed
+ */
+template<typename _QueryType>
+class SharedQueryQueue : public QueryQueueBase<_QueryType> {
+public:
+    explicit SharedQueryQueue(UniqueFunction<void()> onQueryAvailable)
+            : onQueryAvailable(std::move(onQueryAvailable)) { }
+
+protected:
+    void notifyQueryAvailable() override
+    { onQueryAvailable(); }
+
+private:
+    UniqueFunction<void()> onQueryAvailable;
+};
+
+/**
+ * @class SharedQueryThread
+ * @brief Logical query thread run by the workers of QueryThreadMultiplexer
+ *
+ * Has the interface and semantics of QueryThreadSimple, or of QueryThreadTimeout
+ * if constructed with a timeout: its own queue, queries processed one at a time
+ * in queue order, onTimeout() called when no query arrives within the timeout.
+ * It does not own an OS thread, a worker runs it only while it has work,
+ * at most getMaxRunLength() queries at a time, so hundreds of mostly idle
+ * logical threads can share a few workers.
+ *
+ * Consecutive queries may be processed by different workers, so handlers
+ * must not rely on thread local state.
+ */
+template<typename _QueryType>
+class SharedQueryThread : public QueryThreadBase<SharedQueryQueue<_QueryType>>, private DeadlineListener {
+    typedef QueryThreadBase<SharedQueryQueue<_QueryType>> Base;
+public:
+    typedef typename Base::QueueType QueueType;
+    typedef typename Base::QueueTypePtr QueueTypePtr;
+    typedef typename Base::QueryType QueryType;
+    typedef typename Base::QueryTypePtr QueryTypePtr;
+    typedef typename Base::ResultType ResultType;
+
+    /**
+     * @param multiplexer workers to run on, must outlive this thread
+     * @param timeout if not 0, onTimeout() is called when no query arrives within it
+     */
+    explicit SharedQueryThread(QueryThreadMultiplexer& multiplexer,
+                               std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) :
+            Base(std::make_shared<QueueType>([this] { schedule(); })),
+            multiplexer(multiplexer),
+            timeout(timeout),
+            scheduled(false),
+            timeoutPending(false),
+            lastActivityNs(0) { }
+
+    ~SharedQueryThread() override
+    {
+        stopThread();
+        joinThread();
+    }
+
+    SharedQueryThread(const SharedQueryThread&) = delete;
+    SharedQueryThread& operator=(const SharedQueryThread&) = delete;
+    SharedQueryThread(SharedQueryThread&& other) = delete;
+    SharedQueryThread& operator=(SharedQueryThread&& other) = delete;
+
+    void stopThread() override
+    {
+        Base::stopThread();
+        if (hasTimeout())
+            multiplexer.removeDeadline(this);
+    }
+
+    /**
+     * @brief Waits until a worker is done with this thread and cancels queries left in the queue
+     */
+    void joinThread() override
+    {
+        {
+            std::unique_lock<std::mutex> lock(idleMutex);
+            idleCondition.wait(lock, [this] { return !scheduled.load(std::memory_order_acquire); });
+        }
+        Base::queryQueue->clear();
+        Base::joinThread();
+    }
+
+protected:
+    /**
+     * Overriding function must set result to query.
+     */
+    virtual void onQuery(QueryTypePtr query) = 0;
+
+    /**
+     * Called when no query arrives within the timeout, if the thread has one
+     */
+    virtual void onTimeout() {}
+
+    void launchThread() override
+    {
+        touch();
+        if (hasTimeout())
+            multiplexer.addDeadline(this, getDeadline());
+        if (!Base::queryQueue->isEmpty())
+            schedule();
+    }
+
+private:
+    bool hasTimeout() const noexcept
+    { return timeout.count() > 0; }
+
+    /**
+     * @brief Makes a worker run this thread unless it is already scheduled or running
+     */
+    void schedule()
+    {
+        if (!Base::isRunning())
+            return;
+        if (!scheduled.exchange(true, std::memory_order_acq_rel))
+            multiplexer.post([this] { run(); });
+    }
+
+    void run()
+    {
+        unsigned int processed = 0;
+        while (Base::isRunning() && processed < multiplexer.getMaxRunLength()) {
+            if (Base::queryQueue->isEmpty()) {
+                if (!timeoutPending.exchange(false, std::memory_order_acq_rel))
+                    break;
+                // The timeout is stale if a query has been processed since it expired
+                if (getDeadline() <= std::chrono::steady_clock::now()) {
+                    processTimeout();
+                    processed++;
+                }
+                continue;
+            }
+            QueryTypePtr query;
+            try {
+                query = Base::queryQueue->getQuery();
+            } catch (std::runtime_error& e) {
+                // Queue has shed all its queries
+                continue;
+            }
+            Base::processQuery(std::move(query), [this](QueryTypePtr q) { onQuery(std::move(q)); });
+            processed++;
+            touch();
+        }
+
+        /*
+         * Done under the lock: once joinThread() sees the flag cleared
+         * it may destroy the thread, so it must not be touched after that
+         */
+        std::lock_guard<std::mutex> lock(idleMutex);
+        scheduled.store(false, std::memory_order_seq_cst);
+        // Query pushed while the flag was set did not schedule the thread
+        if (!Base::queryQueue->isEmpty() || timeoutPending.load(std::memory_order_acquire))
+            schedule();
+        idleCondition.notify_all();
+    }
+
+    void processTimeout()
+    {
+        Heartbeat* heartbeat = Base::getHeartbeat();
+        if (heartbeat)
+            heartbeat->begin(typeid(*this).name());
+        onTimeout();
+        if (heartbeat)
+            heartbeat->end();
+        Base::arena.reset();
+        touch();
+    }
+
+    /**
+     * Timer thread asks to run onTimeout() once the thread has been idle for the timeout
+     */
+    std::chrono::steady_clock::time_point onDeadline(std::chrono::steady_clock::time_point now) override
+    {
+        auto deadline = getDeadline();
+        if (deadline > now)
+            return deadline;
+        timeoutPending.store(true, std::memory_order_release);
+        schedule();
+        return now + timeout;
+    }
+
+    void touch() noexcept
+    {
+        lastActivityNs.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                             std::memory_order_relaxed);
+    }
+
+    std::chrono::steady_clock::time_point getDeadline() const noexcept
+    {
+        return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(
+                lastActivityNs.load(std::memory_order_relaxed))) + timeout;
+    }
+
+    QueryThreadMultiplexer& multiplexer;
+    std::chrono::milliseconds timeout;
+    /// Set while the thread is posted to or run by a worker
+    std::atomic<bool> scheduled;
+    std::atomic<bool> timeoutPending;
+    std::atomic<int64_t> lastActivityNs;
+    /// Guards clearing of the scheduled flag, joinThread() waits on idleCondition for it
+    std::mutex idleMutex;
+    std::condition_variable idleCondition;
+};
+
+#endif //THREADING_SHAREDQUERYTHREAD_H
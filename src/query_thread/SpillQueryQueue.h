@@ -0,0 +1,423 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_SPILLQUERYQUEUE_H
+#define THREADING_SPILLQUERYQUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "QueryQueueBase.h"
+
+/**
+ * @brief Parameters of SpillQueryQueue
+ */
+struct SpillParams {
+    /// Directory on local disk the segment files are created in
+    std::string directory = "/tmp";
+    /// Number of queries kept in memory, queries pushed above it go to disk,
+    /// except those pinned by other references, see SpillQueryQueue
+    size_t memoryWatermark = 4096;
+    /// Size of a segment file, a bigger query gets a segment of its own
+    size_t segmentSize = 64 << 20;
+    /// Consumed segments kept for reuse instead of being unmapped
+    unsigned int maxFreeSegments = 2;
+};
+
+/**
+ * @class SpillQueryQueue
+ * @brief Query queue that spills queries above an in-memory watermark to disk
+ *
+ * Query type must provide
+ * @code void serialize(std::string& out) const @endcode
+ * @code static std::shared_ptr<QueryType> deserialize(const char* data, size_t size) @endcode
+ * While the queue holds fewer than SpillParams::memoryWatermark queries it works
+ * like QueryQueueBase. Above it, and until everything spilled has been read back,
+ * pushed queries are appended to memory-mapped segment files, and are read back
+ * in FIFO order whenever consumers drain the memory to half the watermark.
+ *
+ * Only queries nobody else refers to are serialized, e.g. pushed with
+ * emplaceQuery() or moved in, and it is a new object that is processed.
+ * A query someone holds, e.g. to wait for its result, is pinned: it stays in memory
+ * and only a record of its place in the order is spilled.
+ * So the watermark is not a hard bound of resident memory: it is about the watermark
+ * plus two segments whatever the backlog of serialized queries is, plus every
+ * pinned query, see getPinnedCount(). Producers that keep references to the queries
+ * they push get ordering and no memory relief from spilling.
+ *
+ * Segment files are unlinked right after they are created, so nothing is left
+ * on disk once the queue is gone. Consumed segments are truncated to return
+ * their disk blocks and reused. Errors of file and mapping calls are reported
+ * with std::system_error from pushQuery().
+ *
+ * Limits set with setLimits() apply to pushes that are not spilled, tryPushQuery()
+ * spills under the same condition as pushQuery(),
+ * removeIf() sees only the queries in memory, and queryDropped() is not called
+ * for serialized queries dropped by clear().
+ */
+template<typename _QueryType>
+class SpillQueryQueue : public QueryQueueBase<_QueryType> {
+    typedef QueryQueueBase<_QueryType> Base;
+public:
+    typedef typename Base::QueryType QueryType;
+    typedef typename Base::QueryTypePtr QueryTypePtr;
+
+    explicit SpillQueryQueue(const SpillParams& params = SpillParams()) :
+            params(params),
+            spilledCount(0),
+            unreadableCount(0),
+            nextPinnedId(0)
+    {
+        if (this->params.memoryWatermark == 0)
+            this->params.memoryWatermark = 1;
+        pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    ~SpillQueryQueue() override
+    {
+        clear();
+    }
+
+    SpillQueryQueue(const SpillQueryQueue&) = delete;
+    SpillQueryQueue& operator=(const SpillQueryQueue&) = delete;
+    SpillQueryQueue(SpillQueryQueue&& other) = delete;
+    SpillQueryQueue& operator=(SpillQueryQueue&& other) = delete;
+
+    using Base::pushQuery;
+
+    PushStatus pushQuery(QueryTypePtr &&query) override
+    {
+        if (spillIfNeeded(query))
+            return PushStatus::Pushed;
+        return Base::pushQuery(std::move(query));
+    }
+
+    /**
+     * Spills like pushQuery(), a query staying in memory is rejected if the bounded queue is full
+     */
+    PushStatus tryPushQuery(QueryTypePtr query) override
+    {
+        if (spillIfNeeded(query))
+            return PushStatus::Pushed;
+        if (!this->bounded)
+            return Base::pushQuery(std::move(query));
+        return this->pushBounded(std::move(query), OverflowPolicy::Reject);
+    }
+
+    QueryTypePtr getQuery() override
+    {
+        QueryTypePtr query = Base::getQuery();
+        if (spilledCount.load() != 0 && Base::size() <= params.memoryWatermark / 2) {
+            std::lock_guard<std::mutex> lock(spillMutex);
+            refill();
+        }
+        return query;
+    }
+
+    /**
+     * Clears the queue and cancels all queries, spilled ones included
+     */
+    void clear() override
+    {
+        std::vector<QueryTypePtr> dropped;
+        {
+            std::lock_guard<std::mutex> lock(spillMutex);
+            Record record;
+            while (readRecord(record)) {
+                if (record.header.kind == Pinned)
+                    dropped.push_back(takePinned(record));
+            }
+            recycleDrained();
+        }
+        Base::clear();
+        for (const auto& query : dropped) {
+            query->cancel();
+            query->invalidate();
+            Base::queryDropped(query);
+        }
+    }
+
+    /**
+     * @return number of queries waiting on disk
+     */
+    size_t getSpilledCount() const
+    { return spilledCount.load(std::memory_order_relaxed); }
+
+    /**
+     * @return number of spilled queries kept in memory because others refer to them,
+     *         they are included in getSpilledCount()
+     */
+    size_t getPinnedCount()
+    {
+        std::lock_guard<std::mutex> lock(spillMutex);
+        return pinned.size();
+    }
+
+    /**
+     * @return number of spilled queries lost because deserialize() threw
+     */
+    uint64_t getUnreadableCount() const
+    { return unreadableCount.load(std::memory_order_relaxed); }
+
+    /**
+     * @return number of mapped segments, in use or kept for reuse
+     */
+    size_t getSegmentCount()
+    {
+        std::lock_guard<std::mutex> lock(spillMutex);
+        return segments.size() + freeSegments.size();
+    }
+
+private:
+    enum RecordKind : uint32_t {
+        Serialized = 0, ///< Query serialized into the record
+        Pinned          ///< Id of a query kept in memory
+    };
+
+    struct RecordHeader {
+        uint32_t size;
+        uint32_t kind;
+    };
+
+    struct Record {
+        RecordHeader header;
+        const char* data;
+    };
+
+    /**
+     * @brief Segment file mapped into memory, records are appended at writeOffset and read at readOffset
+     */
+    struct Segment {
+        Segment(const std::string& directory, size_t capacity) : capacity(capacity)
+        {
+            std::string path = directory + "/query-spill-XXXXXX";
+            fd = mkstemp(&path[0]);
+            if (fd < 0)
+                throw std::system_error(errno, std::system_category(), "mkstemp");
+            unlink(path.c_str());
+            if (ftruncate(fd, static_cast<off_t>(capacity)) != 0) {
+                int error = errno;
+                close(fd);
+                throw std::system_error(error, std::system_category(), "ftruncate");
+            }
+            void* mapped = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (mapped == MAP_FAILED) {
+                int error = errno;
+                close(fd);
+                throw std::system_error(error, std::system_category(), "mmap");
+            }
+            data = static_cast<char*>(mapped);
+        }
+
+        ~Segment()
+        {
+            munmap(data, capacity);
+            close(fd);
+        }
+
+        Segment(const Segment&) = delete;
+        Segment& operator=(const Segment&) = delete;
+
+        /**
+         * @brief Drops the contents, truncating the file returns its blocks and cached pages
+         */
+        void reset()
+        {
+            writeOffset = 0;
+            readOffset = 0;
+            if (ftruncate(fd, 0) != 0 || ftruncate(fd, static_cast<off_t>(capacity)) != 0)
+                throw std::system_error(errno, std::system_category(), "ftruncate");
+        }
+
+        /**
+         * @brief Called once nothing more is written, pages stay in the file and leave the process
+         */
+        void seal() noexcept
+        { madvise(data, capacity, MADV_DONTNEED); }
+
+        bool isConsumed() const noexcept
+        { return readOffset == writeOffset; }
+
+        int fd;
+        char* data;
+        size_t capacity;
+        size_t writeOffset = 0;
+        size_t readOffset = 0;
+    };
+
+    typedef std::unique_ptr<Segment> SegmentPtr;
+
+    static size_t alignUp(size_t size, size_t alignment) noexcept
+    { return (size + alignment - 1) / alignment * alignment; }
+
+    /**
+     * @brief Spills the query if the memory is full or queries are already spilled
+     * @return true if @p query is taken
+     */
+    bool spillIfNeeded(QueryTypePtr& query)
+    {
+        std::lock_guard<std::mutex> lock(spillMutex);
+        // Once spilling, queries keep going to disk until it is read back, to keep the order
+        if (spilledCount.load() == 0 && Base::size() < params.memoryWatermark)
+            return false;
+        spill(std::move(query));
+        // Consumers may have drained the memory before the record was written
+        if (Base::isEmpty())
+            refill();
+        return true;
+    }
+
+    void spill(QueryTypePtr&& query)
+    {
+        if (query.use_count() > 1) {
+            uint64_t id = nextPinnedId++;
+            append(Pinned, reinterpret_cast<const char*>(&id), sizeof(id));
+            pinned.emplace(id, std::move(query));
+        } else {
+            buffer.clear();
+            query->serialize(buffer);
+            append(Serialized, buffer.data(), buffer.size());
+        }
+        spilledCount.fetch_add(1);
+    }
+
+    void append(RecordKind kind, const char* data, size_t size)
+    {
+        if (size > UINT32_MAX)
+            throw std::length_error("Serialized query is too big");
+        const size_t recordSize = alignUp(sizeof(RecordHeader) + size, alignof(uint64_t));
+        if (segments.empty() || segments.back()->capacity - segments.back()->writeOffset < recordSize) {
+            SegmentPtr segment = acquireSegment(recordSize);
+            if (!segments.empty())
+                segments.back()->seal();
+            segments.push_back(std::move(segment));
+        }
+        Segment& segment = *segments.back();
+        RecordHeader header{static_cast<uint32_t>(size), kind};
+        std::memcpy(segment.data + segment.writeOffset, &header, sizeof(header));
+        std::memcpy(segment.data + segment.writeOffset + sizeof(header), data, size);
+        segment.writeOffset += recordSize;
+    }
+
+    /**
+     * @brief Reads the oldest spilled record, segments it leaves consumed are recycled
+     * @return false if nothing is spilled
+     */
+    bool readRecord(Record& record)
+    {
+        if (spilledCount.load(std::memory_order_relaxed) == 0)
+            return false;
+        while (segments.front()->isConsumed())
+            recycle();
+        Segment& segment = *segments.front();
+        std::memcpy(&record.header, segment.data + segment.readOffset, sizeof(record.header));
+        record.data = segment.data + segment.readOffset + sizeof(record.header);
+        segment.readOffset += alignUp(sizeof(RecordHeader) + record.header.size, alignof(uint64_t));
+        spilledCount.fetch_sub(1);
+        return true;
+    }
+
+    /**
+     * @brief Moves spilled queries back to memory until it reaches the watermark
+     */
+    void refill()
+    {
+        Record record;
+        while (Base::size() < params.memoryWatermark && readRecord(record)) {
+            QueryTypePtr query;
+            if (record.header.kind == Pinned) {
+                query = takePinned(record);
+            } else {
+                try {
+                    query = QueryType::deserialize(record.data, record.header.size);
+                } catch (std::exception& e) {
+                    query = nullptr;
+                }
+                if (!query) {
+                    unreadableCount.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+            }
+            Base::pushForced(std::move(query));
+        }
+        recycleDrained();
+    }
+
+    /**
+     * @brief Recycles the last segment once the whole backlog is read back
+     */
+    void recycleDrained()
+    {
+        if (spilledCount.load(std::memory_order_relaxed) == 0 && !segments.empty())
+            recycle();
+    }
+
+    QueryTypePtr takePinned(const Record& record)
+    {
+        uint64_t id;
+        std::memcpy(&id, record.data, sizeof(id));
+        auto it = pinned.find(id);
+        QueryTypePtr query = std::move(it->second);
+        pinned.erase(it);
+        return query;
+    }
+
+    SegmentPtr acquireSegment(size_t recordSize)
+    {
+        if (recordSize <= params.segmentSize && !freeSegments.empty()) {
+            SegmentPtr segment = std::move(freeSegments.back());
+            freeSegments.pop_back();
+            return segment;
+        }
+        return SegmentPtr(new Segment(params.directory,
+                                      alignUp(std::max(params.segmentSize, recordSize), pageSize)));
+    }
+
+    /**
+     * @brief Takes the consumed front segment off the list, keeps it for reuse if there is room
+     */
+    void recycle()
+    {
+        SegmentPtr segment = std::move(segments.front());
+        segments.pop_front();
+        if (freeSegments.size() >= params.maxFreeSegments ||
+            segment->capacity != alignUp(params.segmentSize, pageSize))
+            return;
+        segment->reset();
+        freeSegments.push_back(std::move(segment));
+    }
+
+    SpillParams params;
+    size_t pageSize;
+    /// Guards the segments, pinned queries and the decision whether a push is spilled
+    std::mutex spillMutex;
+    /// Front is read, back is written
+    std::deque<SegmentPtr> segments;
+    std::vector<SegmentPtr> freeSegments;
+    /// Queries spilled by their place in the order only
+    std::unordered_map<uint64_t, QueryTypePtr> pinned;
+    /// Reused for serializing queries
+    std::string buffer;
+    std::atomic<size_t> spilledCount;
+    std::atomic<uint64_t> unreadableCount;
+    uint64_t nextPinnedId;
+};
+
+#endif //THREADING_SPILLQUERYQUEUE_H
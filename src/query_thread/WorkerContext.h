@@ -0,0 +1,72 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_WORKERCONTEXT_H
+#define THREADING_WORKERCONTEXT_H
+
+#include "utils/EventCount.h"
+
+/**
+ * @class WorkerContext
+ * @brief Lets a query thread run pending queries while it waits for a result
+ *
+ * Query threads register themselves as the context of their OS thread.
+ * When a handler waits for the result of a query, e.g. a sub-query it has put
+ * to the same pool, QueryBase asks the context to process other pending
+ * queries instead of blocking, so nested fork-join never runs out of threads.
+ */
+class WorkerContext {
+public:
+    virtual ~WorkerContext() = default;
+
+    /**
+     * @brief Takes one pending query and processes it on the calling thread
+     * @return false if there was no query to process
+     */
+    virtual bool runPendingQuery() = 0;
+
+    /**
+     * @return true if runPendingQuery() is likely to find a query
+     */
+    virtual bool hasPendingQuery() = 0;
+
+    /**
+     * @return condition notified when a query is put to the queue
+     */
+    virtual EventCount::SPtr getPendingQueryCondition() = 0;
+
+    /**
+     * @return context of the calling thread, nullptr if it is not a query thread
+     */
+    static WorkerContext* current() noexcept
+    { return currentRef(); }
+
+    /**
+     * @class Scope
+     * @brief Makes the context current for the calling thread until destroyed
+     */
+    class Scope {
+    public:
+        explicit Scope(WorkerContext* context) noexcept : previous(currentRef())
+        { currentRef() = context; }
+
+        ~Scope()
+        { currentRef() = previous; }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        WorkerContext* previous;
+    };
+
+private:
+    static WorkerContext*& currentRef() noexcept
+    {
+        static thread_local WorkerContext* context = nullptr;
+        return context;
+    }
+};
+
+#endif //THREADING_WORKERCONTEXT_H
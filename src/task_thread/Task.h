@@ -6,8 +6,8 @@
 #define THREADING_TASK_H
 
 #include <chrono>
-#include <functional>
 #include "ITask.h"
+#include "utils/UniqueFunction.h"
 #include "utils/SPtrFactoryBase.h"
 
 /**
@@ -21,11 +21,12 @@ public:
     /**
      * @brief Task constructor
      * @param taskFunction task to execute
-     *        User can use std::bind to pass custom parameters to taskFunction
+     *        User can use std::bind or a lambda to pass custom parameters to taskFunction,
+     *        it may be move-only, small callables are stored without allocation
      * @param repetitionPeriod how often to run this task,
      *        if 0 - task will be performed on each thread wakeup
      */
-    explicit Task(std::function<void()> taskFunction,
+    explicit Task(UniqueFunction<void()> taskFunction,
          std::chrono::milliseconds repetitionPeriod = std::chrono::milliseconds(0))
         : repetitionPeriod(repetitionPeriod)
         , nextInvocation(std::chrono::steady_clock::now() + repetitionPeriod)
@@ -52,7 +53,7 @@ public:
 protected:
     std::chrono::milliseconds repetitionPeriod;
     std::chrono::steady_clock::time_point nextInvocation;
-    std::function<void()> taskFunction;
+    UniqueFunction<void()> taskFunction;
 };
 
 #endif //THREADING_TASK_H
@@ -0,0 +1,311 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_TASKGRAPH_H
+#define THREADING_TASKGRAPH_H
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "ITask.h"
+#include "parallel/ForkJoinPool.h"
+#include "utils/CountDownLatch.h"
+#include "utils/SPtrFactoryBase.h"
+
+class TaskGraph;
+
+/**
+ * @class TaskGraphRun
+ * @brief Completion handle of one TaskGraph execution
+ *
+ * Holds per-run state, so the graph can be run again while
+ * the previous run is still in progress.
+ */
+class TaskGraphRun : public PtrDeclBase<TaskGraphRun> {
+    friend class TaskGraph;
+public:
+    TaskGraphRun(const TaskGraphRun&) = delete;
+    TaskGraphRun& operator=(const TaskGraphRun&) = delete;
+
+    /**
+     * @return true if all nodes have finished
+     */
+    bool isDone() const noexcept
+    { return done.isReady(); }
+
+    /**
+     * @brief Waits until all nodes have finished
+     *
+     * Rethrows the first exception thrown by a node. Nodes depending on the
+     * failed one, directly or transitively, are not executed, independent nodes are.
+     * A node the pool drops instead of running it, e.g. because the pool is
+     * stopped or its bounded queue is full, fails with QueryCancelledError
+     * or QueryOverloadedError.
+     */
+    void wait()
+    {
+        done.wait();
+        rethrowIfFailed();
+    }
+
+    /**
+     * @brief Waits until all nodes have finished or timeout expires
+     * @return true if the run has finished
+     */
+    template<typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& time)
+    {
+        if (!done.waitFor(time))
+            return false;
+        rethrowIfFailed();
+        return true;
+    }
+
+private:
+    TaskGraphRun(std::shared_ptr<const TaskGraph> graph, size_t nodes)
+            : graph(std::move(graph))
+            , pending(new std::atomic<size_t>[nodes])
+            , skipped(new std::atomic<bool>[nodes])
+            , done(nodes) { }
+
+    void rethrowIfFailed()
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    std::shared_ptr<const TaskGraph> graph;
+    /// Unfinished predecessors of every node
+    std::unique_ptr<std::atomic<size_t>[]> pending;
+    /// Set for nodes a predecessor of which has failed or was skipped
+    std::unique_ptr<std::atomic<bool>[]> skipped;
+    /// Counts finished (or skipped) nodes
+    CountDownLatch done;
+    std::mutex errorMutex;
+    std::exception_ptr error;
+};
+
+/**
+ * @class TaskGraph
+ * @brief Directed acyclic graph of tasks executed on ForkJoinPool
+ *
+ * Nodes are added with addNode() and ordered with addDependency().
+ * After validate() the graph is immutable and can be run any number of times.
+ * Every run executes each node exactly once via ITask::execute(),
+ * ITask::isTimeToExecute() is not consulted.
+ * A node becomes ready as soon as its last predecessor finishes: predecessor
+ * counters are atomic and the thread finishing a node schedules its ready
+ * successors, running one of them itself, so there is no central lock.
+ *
+ * Graph must be owned by shared_ptr, runs keep it alive.
+ */
+class TaskGraph : public SPtrFactoryBase<TaskGraph>, public std::enable_shared_from_this<TaskGraph> {
+public:
+    typedef size_t NodeId;
+
+    TaskGraph() = default;
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    /**
+     * @brief Adds task to the graph
+     * @return id to refer to the node in addDependency()
+     */
+    NodeId addNode(std::shared_ptr<ITask> task)
+    {
+        throwIfValidated();
+        nodes.emplace_back();
+        nodes.back().task = std::move(task);
+        return nodes.size() - 1;
+    }
+
+    /**
+     * @brief Makes node @p after wait until node @p before has finished
+     */
+    void addDependency(NodeId before, NodeId after)
+    {
+        throwIfValidated();
+        if (before >= nodes.size() || after >= nodes.size() || before == after)
+            throw std::invalid_argument("Invalid task graph dependency");
+        nodes[before].successors.push_back(after);
+        nodes[after].predecessors++;
+    }
+
+    /**
+     * @brief Checks that graph has no cycles and freezes it
+     *
+     * Throws std::logic_error if the graph has a cycle.
+     */
+    void validate()
+    {
+        if (validated)
+            return;
+        std::vector<size_t> pending(nodes.size());
+        std::vector<NodeId> ready;
+        for (NodeId id = 0; id < nodes.size(); id++) {
+            pending[id] = nodes[id].predecessors;
+            if (pending[id] == 0)
+                ready.push_back(id);
+        }
+        roots = ready;
+
+        size_t visited = 0;
+        while (!ready.empty()) {
+            NodeId id = ready.back();
+            ready.pop_back();
+            visited++;
+            for (NodeId next : nodes[id].successors)
+                if (--pending[next] == 0)
+                    ready.push_back(next);
+        }
+        if (visited != nodes.size())
+            throw std::logic_error("Task graph has a cycle");
+        validated = true;
+    }
+
+    size_t size() const noexcept
+    { return nodes.size(); }
+
+    /**
+     * @brief Starts execution of the graph on @p pool, validating it first if needed
+     * @return handle to wait for completion
+     */
+    TaskGraphRun::SPtr run(ForkJoinPool& pool)
+    {
+        validate();
+        TaskGraphRun::SPtr state(new TaskGraphRun(shared_from_this(), nodes.size()));
+        for (NodeId id = 0; id < nodes.size(); id++) {
+            state->pending[id].store(nodes[id].predecessors, std::memory_order_relaxed);
+            state->skipped[id].store(false, std::memory_order_relaxed);
+        }
+
+        for (NodeId id : roots)
+            schedule(pool, state, id);
+        return state;
+    }
+
+private:
+    struct Node {
+        std::shared_ptr<ITask> task;
+        std::vector<NodeId> successors;
+        size_t predecessors = 0;
+    };
+
+    void throwIfValidated() const
+    {
+        if (validated)
+            throw std::logic_error("Task graph can not be modified after validation");
+    }
+
+    /**
+     * @brief Node posted to the pool, tells the graph if the pool drops it
+     */
+    class NodeQuery : public RunnableQuery {
+    public:
+        NodeQuery(const TaskGraph& graph, ForkJoinPool& pool, const TaskGraphRun::SPtr& state, NodeId id)
+                : graph(graph), pool(pool), state(state), id(id) { }
+
+        void run() override
+        { graph.runNode(pool, state, id); }
+
+    protected:
+        void onDropped(bool overloaded) override
+        { graph.dropNode(state, id, overloaded); }
+
+    private:
+        const TaskGraph& graph;
+        ForkJoinPool& pool;
+        TaskGraphRun::SPtr state;
+        NodeId id;
+    };
+
+    void schedule(ForkJoinPool& pool, const TaskGraphRun::SPtr& state, NodeId id) const
+    {
+        auto query = std::make_shared<NodeQuery>(*this, pool, state, id);
+        PushStatus status = pool.putQuery(query);
+        if (status == PushStatus::Rejected || status == PushStatus::TimedOut)
+            query->setOverloaded();
+    }
+
+    /*
+     * Fails a node the pool has dropped and finishes everything depending on it
+     * as skipped. Skipped nodes are not run, so they are finished right here
+     * instead of being posted to the pool, which may be stopping.
+     */
+    void dropNode(const TaskGraphRun::SPtr& state, NodeId id, bool overloaded) const
+    {
+        {
+            std::lock_guard<std::mutex> lock(state->errorMutex);
+            if (!state->error) {
+                state->error = overloaded ? std::make_exception_ptr(QueryOverloadedError())
+                                          : std::make_exception_ptr(QueryCancelledError());
+            }
+        }
+        std::vector<NodeId> finished{id};
+        while (!finished.empty()) {
+            NodeId node = finished.back();
+            finished.pop_back();
+            for (NodeId successor : nodes[node].successors) {
+                state->skipped[successor].store(true, std::memory_order_relaxed);
+                if (state->pending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    finished.push_back(successor);
+            }
+            state->done.countDown();
+        }
+    }
+
+    /*
+     * Runs node and continues with one of the successors it made ready
+     * on the same thread, the rest are posted to the pool.
+     * A failed or skipped node makes its successors skipped before releasing them,
+     * the release of the predecessor counter publishes the flag.
+     */
+    void runNode(ForkJoinPool& pool, const TaskGraphRun::SPtr& state, NodeId id) const
+    {
+        while (true) {
+            bool failed = state->skipped[id].load(std::memory_order_relaxed);
+            if (!failed) {
+                try {
+                    nodes[id].task->execute();
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(state->errorMutex);
+                    if (!state->error)
+                        state->error = std::current_exception();
+                    failed = true;
+                }
+            }
+
+            bool haveNext = false;
+            NodeId next = 0;
+            for (NodeId successor : nodes[id].successors) {
+                if (failed)
+                    state->skipped[successor].store(true, std::memory_order_relaxed);
+                if (state->pending[successor].fetch_sub(1, std::memory_order_acq_rel) != 1)
+                    continue;
+                if (!haveNext) {
+                    next = successor;
+                    haveNext = true;
+                } else {
+                    schedule(pool, state, successor);
+                }
+            }
+            state->done.countDown();
+            if (!haveNext)
+                return;
+            id = next;
+        }
+    }
+
+    std::vector<Node> nodes;
+    std::vector<NodeId> roots;
+    bool validated = false;
+};
+
+#endif //THREADING_TASKGRAPH_H
@@ -8,14 +8,19 @@
 #include <chrono>
 #include <list>
 #include <mutex>
+#include <typeinfo>
 
 #include "Task.h"
 #include "ThreadBase.h"
 #include "utils/SPtrFactoryBase.h"
+#include "watchdog/Heartbeat.h"
 
 /**
  * @class TaskThread
  * @brief Thread that executes tasks with certain frequency
+ *
+ * Between wakeups the thread waits according to its WaitStrategy,
+ * stopping it ends the wait right away.
  */
 class TaskThread : public ThreadBase, public SPtrFactoryBase<TaskThread> {
 public:
@@ -52,9 +57,26 @@ public:
         taskList.push_back(task);
     }
 
+    /**
+     * @brief Attaches heartbeat the thread updates around every task, see Watchdog.
+     *
+     * Must be called before startThread()
+     */
+    void setHeartbeat(const Heartbeat::SPtr& threadHeartbeat)
+    { heartbeat = threadHeartbeat; }
+
 private:
     void threadIteration() override;
 
+    /**
+     * @return true once the wakeup period has passed
+     */
+    bool hasWork() override
+    { return std::chrono::steady_clock::now() >= nextWakeup; }
+
+    void waitForWork() override
+    { waitForWorkUntil(nextWakeup); }
+
     std::chrono::milliseconds wakeupPeriod;
     std::chrono::steady_clock::time_point nextWakeup;
 
@@ -64,6 +86,8 @@ private:
     std::mutex tasksListMutex;
     /// The list of tasks
     std::list<std::shared_ptr<ITask>> taskList;
+    /// Progress reported to Watchdog, optional
+    Heartbeat::SPtr heartbeat;
 
     /**
      * @brief Runs all tasks
@@ -73,8 +97,6 @@ private:
 
 void inline TaskThread::threadIteration()
 {
-    std::this_thread::sleep_for(wakeupPeriod);
-
     runTasks();
 
     nextWakeup = std::chrono::steady_clock::now() + wakeupPeriod;
@@ -84,12 +106,15 @@ void inline TaskThread::threadIteration()
 void inline TaskThread::runTasks()
 {
     std::lock_guard<std::mutex> lock(tasksListMutex);
-
     for (auto& task : taskList)
     {
         if (task->isTimeToExecute())
         {
+            if (heartbeat)
+                heartbeat->begin(typeid(*task).name());
             task->execute();
+            if (heartbeat)
+                heartbeat->end();
         }
     }
 }
@@ -0,0 +1,197 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_CONCURRENTLRUCACHE_H
+#define THREADING_CONCURRENTLRUCACHE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class ConcurrentLruCache
+ * @brief Bounded thread safe LRU cache with optional time to live
+ *
+ * Keys are spread over independently locked shards, each shard evicts its
+ * least recently used entry when it is full, so eviction order is LRU per shard.
+ * Shard capacities sum up to capacity, so the cache never holds more entries.
+ * Entries older than ttl are treated as missing and removed when looked up.
+ * Cache of capacity 0 stores nothing, every lookup is a miss.
+ * @tparam V copy assignable, get() copies the cached value out
+ * @tparam _Hash hash of K
+ */
+template<typename K, typename V, typename _Hash = std::hash<K>>
+class ConcurrentLruCache {
+public:
+    /**
+     * @brief Counters of cache activity
+     */
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t expirations = 0;
+    };
+
+    /**
+     * @param capacity maximal number of entries, 0 disables caching
+     * @param ttl entry lifetime, 0 means entries do not expire
+     * @param shardCount number of independently locked parts
+     */
+    explicit ConcurrentLruCache(size_t capacity,
+                                std::chrono::milliseconds ttl = std::chrono::milliseconds(0),
+                                size_t shardCount = 16)
+            : ttl(ttl)
+    {
+        shardCount = std::max<size_t>(1, std::min(shardCount, capacity));
+        // First shards take the remainder, so capacities sum up to capacity exactly
+        size_t perShard = capacity / shardCount;
+        size_t remainder = capacity % shardCount;
+        for (size_t i = 0; i < shardCount; i++)
+            shards.emplace_back(new Shard(perShard + (i < remainder ? 1 : 0)));
+    }
+
+    ConcurrentLruCache(const ConcurrentLruCache&) = delete;
+    ConcurrentLruCache& operator=(const ConcurrentLruCache&) = delete;
+
+    /**
+     * @brief Looks value up and marks it as recently used
+     * @return true if value is found and copied to @p value
+     */
+    bool get(const K& key, V& value)
+    {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (isExpired(*it->second)) {
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+            expirations.fetch_add(1, std::memory_order_relaxed);
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        value = it->second->value;
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Inserts or replaces value, evicting least recently used entry if shard is full
+     */
+    void put(const K& key, V value)
+    {
+        Shard& shard = shardFor(key);
+        if (shard.capacity == 0)
+            return;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            it->second->value = std::move(value);
+            it->second->created = std::chrono::steady_clock::now();
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            return;
+        }
+        if (shard.index.size() >= shard.capacity) {
+            shard.index.erase(shard.lru.back().key);
+            shard.lru.pop_back();
+            evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+        shard.lru.push_front(Entry{key, std::move(value), std::chrono::steady_clock::now()});
+        shard.index.emplace(key, shard.lru.begin());
+    }
+
+    /**
+     * @brief Removes value if it is cached
+     */
+    void erase(const K& key)
+    {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end())
+            return;
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+    }
+
+    void clear()
+    {
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->index.clear();
+            shard->lru.clear();
+        }
+    }
+
+    size_t size()
+    {
+        size_t total = 0;
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            total += shard->index.size();
+        }
+        return total;
+    }
+
+    Stats getStats() const
+    {
+        Stats stats;
+        stats.hits = hits.load(std::memory_order_relaxed);
+        stats.misses = misses.load(std::memory_order_relaxed);
+        stats.evictions = evictions.load(std::memory_order_relaxed);
+        stats.expirations = expirations.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    struct Entry {
+        K key;
+        V value;
+        std::chrono::steady_clock::time_point created;
+    };
+
+    struct Shard {
+        explicit Shard(size_t capacity) : capacity(capacity) { }
+
+        std::mutex mutex;
+        /// Most recently used entry is at the front
+        std::list<Entry> lru;
+        std::unordered_map<K, typename std::list<Entry>::iterator, _Hash> index;
+        const size_t capacity;
+    };
+
+    Shard& shardFor(const K& key)
+    {
+        // Mix the hash so that shard choice does not correlate with bucket choice
+        uint64_t h = static_cast<uint64_t>(hasher(key)) * 0x9E3779B97F4A7C15ull;
+        return *shards[(h >> 32) % shards.size()];
+    }
+
+    bool isExpired(const Entry& entry) const
+    {
+        return ttl.count() != 0 && std::chrono::steady_clock::now() - entry.created >= ttl;
+    }
+
+    const std::chrono::milliseconds ttl;
+    _Hash hasher;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<uint64_t> expirations{0};
+};
+
+#endif //THREADING_CONCURRENTLRUCACHE_H
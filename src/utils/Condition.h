@@ -32,11 +32,17 @@ public:
     Condition(const Condition&) = delete;
     const Condition &operator=(const Condition&) = delete;
 
+    /**
+     * Mutex is taken before notification so that waiter, which has evaluated
+     * its predicate but has not yet blocked, can not miss the notification
+     */
     void notify_one() {
+        std::lock_guard<std::mutex> guard(mutex);
         cond.notify_one();
     }
 
     void notify_all() {
+        std::lock_guard<std::mutex> guard(mutex);
         cond.notify_all();
     }
 
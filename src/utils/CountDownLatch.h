@@ -0,0 +1,62 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_COUNTDOWNLATCH_H
+#define THREADING_COUNTDOWNLATCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+#include "EventCount.h"
+#include "SPtrFactoryBase.h"
+
+/**
+ * @class CountDownLatch
+ * @brief Single use barrier, opens when counter reaches zero
+ */
+class CountDownLatch final : public SPtrFactoryBase<CountDownLatch> {
+public:
+    explicit CountDownLatch(size_t count) : counter(count) { }
+    CountDownLatch(const CountDownLatch&) = delete;
+    CountDownLatch& operator=(const CountDownLatch&) = delete;
+
+    /**
+     * @brief Decrements the counter, wakes up waiters when it reaches zero
+     * @return true if this call opened the latch
+     */
+    bool countDown(size_t n = 1) noexcept
+    {
+        if (counter.fetch_sub(n, std::memory_order_acq_rel) != n)
+            return false;
+        events.notify_all();
+        return true;
+    }
+
+    /**
+     * @return true if counter has reached zero
+     */
+    bool isReady() const noexcept
+    { return counter.load(std::memory_order_acquire) == 0; }
+
+    /**
+     * @brief Blocks until counter reaches zero
+     */
+    void wait()
+    { events.wait([this] { return isReady(); }); }
+
+    /**
+     * @brief Blocks until counter reaches zero or timeout expires
+     * @return true if counter has reached zero
+     */
+    template<typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& time)
+    { return events.wait_for(time, [this] { return isReady(); }); }
+
+private:
+    std::atomic<size_t> counter;
+    EventCount events;
+};
+
+#endif //THREADING_COUNTDOWNLATCH_H
@@ -0,0 +1,227 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_EVENTCOUNT_H
+#define THREADING_EVENTCOUNT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#include "SPtrFactoryBase.h"
+
+/**
+ * @class EventCount
+ * @brief Condition variable for lock-free state, notification is free when nobody waits.
+ *
+ * Waiter announces itself with prepareWait(), checks its condition and
+ * either calls cancelWait() if the condition holds or commitWait() to sleep.
+ * Notifier changes the state and calls notify_*(), which only does a syscall
+ * if some thread is between prepareWait() and the end of commitWait().
+ * Any notification issued after prepareWait() makes commitWait() return,
+ * so wakeups can not be lost.
+ *
+ * wait() and wait_for() wrap this protocol and make EventCount a drop-in
+ * replacement of Condition for predicates that do not need Condition's mutex.
+ */
+class EventCount final : public SPtrFactoryBase<EventCount> {
+public:
+    /**
+     * @brief Epoch observed by prepareWait()
+     */
+    class Key {
+        friend class EventCount;
+        explicit Key(uint32_t epoch) : epoch(epoch) { }
+        uint32_t epoch;
+    };
+
+    EventCount() : epoch(0), waiters(0) { }
+    EventCount(const EventCount&) = delete;
+    EventCount& operator=(const EventCount&) = delete;
+
+    /**
+     * @brief Registers caller as a waiter, caller must check its condition after this call
+     * @return Key to pass to commitWait()
+     */
+    Key prepareWait() noexcept
+    {
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        // Orders the condition check that follows after the waiter registration
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return Key(epoch.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @brief Unregisters the waiter, call it when condition already holds after prepareWait()
+     */
+    void cancelWait() noexcept
+    { waiters.fetch_sub(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief Sleeps until notification issued after prepareWait() that returned @p key
+     */
+    void commitWait(Key key) noexcept
+    {
+        while (epoch.load(std::memory_order_acquire) == key.epoch)
+            sleep(key.epoch, nullptr);
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Sleeps until notification issued after prepareWait() or timeout
+     * @return false if timeout expired without notification
+     */
+    template<typename Rep, typename Period>
+    bool commitWaitFor(Key key, const std::chrono::duration<Rep, Period>& time) noexcept
+    {
+        auto deadline = std::chrono::steady_clock::now() + time;
+        bool notified = true;
+        while (epoch.load(std::memory_order_acquire) == key.epoch) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                notified = false;
+                break;
+            }
+            sleep(key.epoch, &deadline);
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return notified;
+    }
+
+    /**
+     * @return number of threads between prepareWait() and the end of commitWait()
+     */
+    uint32_t getWaiterCount() const noexcept
+    { return waiters.load(std::memory_order_relaxed); }
+
+    void notify_one() noexcept
+    { notify(false); }
+
+    void notify_all() noexcept
+    { notify(true); }
+
+    /**
+     * @brief Blocks thread of execution until predicate evaluates to true
+     * @param p predicate which returns false if the waiting should be continued.
+     */
+    template<typename Predicate>
+    void wait(Predicate p)
+    {
+        while (!p()) {
+            Key key = prepareWait();
+            if (p()) {
+                cancelWait();
+                return;
+            }
+            commitWait(key);
+        }
+    }
+
+    /**
+     * @brief Blocks thread of execution for specified amount of time
+     * until predicate evaluates to true or timeout expires
+     * @return false if the predicate @p still evaluates to false
+     *         after the timeout expired, otherwise true
+     */
+    template<typename Rep, typename Period, typename Predicate>
+    bool wait_for(const std::chrono::duration<Rep, Period>& time, Predicate p)
+    {
+        auto deadline = std::chrono::steady_clock::now() + time;
+        while (!p()) {
+            Key key = prepareWait();
+            if (p()) {
+                cancelWait();
+                return true;
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                cancelWait();
+                return p();
+            }
+            if (!commitWaitFor(key, deadline - now))
+                return p();
+        }
+        return true;
+    }
+
+private:
+    void notify(bool all) noexcept
+    {
+        // Pairs with the fence in prepareWait(): either the waiter sees the new state
+        // or we see the waiter
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) == 0)
+            return;
+        epoch.fetch_add(1, std::memory_order_release);
+        wake(all);
+    }
+
+#if defined(__linux__)
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(int), "futex requires 32-bit word");
+
+    int* futexWord() noexcept
+    { return reinterpret_cast<int*>(&epoch); }
+
+    void sleep(uint32_t expected, const std::chrono::steady_clock::time_point* deadline) noexcept
+    {
+        timespec ts{};
+        timespec* timeout = nullptr;
+        if (deadline) {
+            auto left = *deadline - std::chrono::steady_clock::now();
+            if (left <= std::chrono::steady_clock::duration::zero())
+                return;
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(left).count();
+            ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+            ts.tv_nsec = static_cast<long>(ns % 1000000000);
+            timeout = &ts;
+        }
+        // Returns immediately with EAGAIN if epoch has already changed
+        syscall(SYS_futex, futexWord(), FUTEX_WAIT_PRIVATE, static_cast<int>(expected),
+                timeout, nullptr, 0);
+    }
+
+    void wake(bool all) noexcept
+    { syscall(SYS_futex, futexWord(), FUTEX_WAKE_PRIVATE, all ? INT32_MAX : 1, nullptr, nullptr, 0); }
+#else
+    void sleep(uint32_t expected, const std::chrono::steady_clock::time_point* deadline) noexcept
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto changed = [&] { return epoch.load(std::memory_order_acquire) != expected; };
+        if (deadline)
+            cond.wait_until(lock, *deadline, changed);
+        else
+            cond.wait(lock, changed);
+    }
+
+    void wake(bool all) noexcept
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (all)
+            cond.notify_all();
+        else
+            cond.notify_one();
+    }
+
+    std::mutex mutex;
+    std::condition_variable cond;
+#endif
+
+    /// Incremented by each notification that found waiters
+    std::atomic<uint32_t> epoch;
+    /// Number of threads between prepareWait() and the end of commitWait()
+    std::atomic<uint32_t> waiters;
+};
+
+#endif //THREADING_EVENTCOUNT_H
@@ -8,8 +8,15 @@
 #include <deque>
 #include <mutex>
 #include <algorithm>
+#include <stdexcept>
 
-template <class T>
+#include "LockPolicy.h"
+
+/**
+ * @tparam _Lock lock type, see LockPolicy.h; with SharedMutex
+ *         size(), empty() and const accessors take it shared
+ */
+template <class T, class _Lock = std::mutex>
 class GuardedDeque final {
 public:
     GuardedDeque() = default;
@@ -35,123 +42,123 @@ public:
 //    }
 
     void pushBack(const T& value) {
-        std::lock_guard<std::mutex> lg(mutex);
+        std::lock_guard<_Lock> lg(mutex);
         deque.push_back(value);
     }
 
     void pushBack(T&& value) {
-        std::lock_guard<std::mutex> lg(mutex);
+        std::lock_guard<_Lock> lg(mutex);
         deque.push_back(std::move(value));
     }
 
     template<typename... _Args>
     void emplaceBack(_Args&&... __args) {
-        std::lock_guard<std::mutex> lg(mutex);
+        std::lock_guard<_Lock> lg(mutex);
         deque.emplace_back(std::forward<_Args>(__args)...);
     }
 
     void pushFront(const T& value) {
-        std::lock_guard<std::mutex> lg(mutex);
+        std::lock_guard<_Lock> lg(mutex);
         deque.push_front(value);
     }
 
     void pushFront(T&& value) {
-        std::lock_guard<std::mutex> lg(mutex);
+        std::lock_guard<_Lock> lg(mutex);
         deque.push_front(std::move(value));
     }
 
     template<typename... _Args>
     void emplaceFront(_Args&&... __args) {
-        std::lock_guard<std::mutex> lg(mutex);
+        std::lock_guard<_Lock> lg(mutex);
         deque.emplace_front(std::forward<_Args>(__args)...);
     }
 
     T getFront() {
-        std::lock_guard<std::mutex> lg(mutex);
+        std::lock_guard<_Lock> lg(mutex);
         if (deque.empty())
             throw std::runtime_error("Deque is empty");
-        T value = deque.front();
+        T value = std::move(deque.front());
         deque.pop_front();
         return value;
     }
 
     T getBack() {
-        std::lock_guard<std::mutex> lg(mutex);
+        std::lock_guard<_Lock> lg(mutex);
         if (deque.empty())
             throw std::runtime_error("Deque is empty");
-        T value = deque.back();
+        T value = std::move(deque.back());
         deque.pop_back();
         return value;
     }
 
     const T& back() const {
-        std::lock_guard<std::mutex> lg(mutex);
+        SharedLockGuard<_Lock> lg(mutex);
         if (deque.empty())
             throw std::runtime_error("Deque is empty");
         return deque.back();
     }
 
     T& back() {
-        std::lock_guard<std::mutex> lg(mutex);
+        std::lock_guard<_Lock> lg(mutex);
         if (deque.empty())
             throw std::runtime_error("Deque is empty");
         return deque.back();
     }
 
     const T& front() const {
-        std::lock_guard<std::mutex> lg(mutex);
+        SharedLockGuard<_Lock> lg(mutex);
         if (deque.empty())
             throw std::runtime_error("Deque is empty");
         return deque.front();
     }
 
     T& front() {
-        std::lock_guard<std::mutex> lg(mutex);
+        std::lock_guard<_Lock> lg(mutex);
         if (deque.empty())
             throw std::runtime_error("Deque is empty");
         return deque.front();
     }
 
     void popBack() {
-        std::lock_guard<std::mutex> lg(mutex);
+        std::lock_guard<_Lock> lg(mutex);
         if (deque.empty())
             throw std::runtime_error("Deque is empty");
         deque.pop_back();
     }
 
     void popFront() {
-        std::lock_guard<std::mutex> lg(mutex);
+        std::lock_guard<_Lock> lg(mutex);
         if (deque.empty())
             throw std::runtime_error("Deque is empty");
         deque.pop_front();
     }
 
-    bool empty() {
-        std::lock_guard<std::mutex> lg(mutex);
+    bool empty() const {
+        SharedLockGuard<_Lock> lg(mutex);
         return deque.empty();
     }
 
-    size_t size() {
-        std::lock_guard<std::mutex> lg(mutex);
+    size_t size() const {
+        SharedLockGuard<_Lock> lg(mutex);
         return deque.size();
     }
 
     void clear() {
         using std::swap;
-        std::lock_guard<std::mutex> lg(mutex);
+        std::lock_guard<_Lock> lg(mutex);
         std::deque<T> empty;
         swap(deque, empty);
     }
 
     template <class Predicate>
     void removeIf(Predicate p) {
-        std::lock_guard<std::mutex> lg(mutex);
+        std::lock_guard<_Lock> lg(mutex);
         deque.erase(std::remove_if(deque.begin(), deque.end(), p), deque.end());
     }
 
 private:
     std::deque<T> deque;
-    std::mutex mutex;
+    mutable _Lock mutex;
 };
 
 #endif //THREADING_GUARDEDDEQUE_H
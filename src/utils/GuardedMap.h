@@ -8,38 +8,44 @@
 #include <map>
 #include <mutex>
 
-template <class K, class V>
+#include "LockPolicy.h"
+
+/**
+ * @tparam _Lock lock type, see LockPolicy.h; with SharedMutex
+ *         get(), empty() and size() take it shared, so readers do not block each other
+ */
+template <class K, class V, class _Lock = std::mutex>
 class GuardedMap {
 private:
     std::map<K, V> map;
-    std::mutex m;
+    mutable _Lock m;
 
 public:
     void set(const K &key, const V &value) {
-        std::lock_guard<std::mutex> lg(m);
+        std::lock_guard<_Lock> lg(m);
         map[key] = value;
     }
 
     void set(K &&key, V &&value) {
-        std::lock_guard<std::mutex> lg(m);
+        std::lock_guard<_Lock> lg(m);
         map[key] = std::move(value);
     }
 
     const V *get(const K &key) {
-        std::lock_guard<std::mutex> lg(m);
+        SharedLockGuard<_Lock> lg(m);
         auto pos = map.find(key);
         if (pos != map.end())
             return &pos->second;
         return nullptr;
     }
 
-    bool empty() {
-        std::lock_guard<std::mutex> lg(m);
+    bool empty() const {
+        SharedLockGuard<_Lock> lg(m);
         return map.empty();
     }
 
-    size_t size() {
-        std::lock_guard<std::mutex> lg(m);
+    size_t size() const {
+        SharedLockGuard<_Lock> lg(m);
         return map.size();
     }
 
@@ -0,0 +1,181 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_LOCKPOLICY_H
+#define THREADING_LOCKPOLICY_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+#include "WaitStrategy.h"
+
+/*
+ * Lock types for ThreadSafeBaseT, GuardedDeque, GuardedMap and IntrusiveQueryList.
+ *
+ * std::mutex      - general purpose, blocks in the kernel under contention
+ * SpinMutex       - tiny critical sections with low contention
+ * TicketLock      - tiny critical sections under contention, grants the lock in FIFO order
+ * SharedMutex     - read-heavy access, readers hold the lock together
+ *
+ * Every type is Lockable. Read-only paths of the containers take the lock
+ * through LockTraits, which takes it shared where the type supports that.
+ */
+
+/**
+ * @class SpinMutex
+ * @brief Test-and-test-and-set spinlock that yields the CPU if the owner is slow
+ *
+ * How long to spin before yielding adapts to the lock the way WaitStrategy::SpinPark
+ * does: the budget grows by half when spinning got the lock and halves when it
+ * did not, between minSpins and maxSpins. So a lock held for a few instructions
+ * is spun on, while a lock whose owner keeps getting preempted soon costs
+ * only a few dozen pauses before yielding.
+ */
+class SpinMutex {
+public:
+    SpinMutex() noexcept : locked(false), spinBudget(maxSpins) { }
+    SpinMutex(const SpinMutex&) = delete;
+    SpinMutex& operator=(const SpinMutex&) = delete;
+
+    void lock() noexcept
+    {
+        if (try_lock())
+            return;
+        // Racy updates of the budget only skew the estimate, so relaxed order is enough
+        const unsigned int budget = spinBudget.load(std::memory_order_relaxed);
+        for (unsigned int spins = 0; spins < budget; spins++) {
+            cpuRelax();
+            if (try_lock()) {
+                spinBudget.store(std::min<unsigned int>(maxSpins, budget + budget / 2),
+                                 std::memory_order_relaxed);
+                return;
+            }
+        }
+        spinBudget.store(std::max<unsigned int>(minSpins, budget / 2), std::memory_order_relaxed);
+        while (!try_lock())
+            std::this_thread::yield();
+    }
+
+    bool try_lock() noexcept
+    {
+        return !locked.load(std::memory_order_relaxed) &&
+               !locked.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() noexcept
+    { locked.store(false, std::memory_order_release); }
+
+    /**
+     * @return current number of spins before yielding, for tests and tuning
+     */
+    unsigned int getSpinBudget() const noexcept
+    { return spinBudget.load(std::memory_order_relaxed); }
+
+    enum : unsigned int { minSpins = 16, maxSpins = 1000 };
+
+private:
+    std::atomic<bool> locked;
+    std::atomic<unsigned int> spinBudget;
+};
+
+/**
+ * @class TicketLock
+ * @brief Fair spinlock, threads get the lock in the order they asked for it
+ *
+ * Unlike SpinMutex, no thread starves under contention,
+ * but a preempted waiter delays everyone queued after it.
+ * A waiter spins a fixed 1000 times, then yields until its turn comes.
+ */
+class TicketLock {
+public:
+    TicketLock() noexcept : nextTicket(0), nowServing(0) { }
+    TicketLock(const TicketLock&) = delete;
+    TicketLock& operator=(const TicketLock&) = delete;
+
+    void lock() noexcept
+    {
+        const uint32_t ticket = nextTicket.fetch_add(1, std::memory_order_relaxed);
+        for (unsigned int spins = 0; nowServing.load(std::memory_order_acquire) != ticket; spins++) {
+            if (spins < maxSpins)
+                cpuRelax();
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    bool try_lock() noexcept
+    {
+        uint32_t serving = nowServing.load(std::memory_order_acquire);
+        uint32_t expected = serving;
+        return nextTicket.compare_exchange_strong(expected, serving + 1, std::memory_order_acquire,
+                                                  std::memory_order_relaxed);
+    }
+
+    void unlock() noexcept
+    {
+        // Only the owner writes nowServing
+        nowServing.store(nowServing.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    enum : unsigned int { maxSpins = 1000 };
+
+    std::atomic<uint32_t> nextTicket;
+    std::atomic<uint32_t> nowServing;
+};
+
+/// Reader-writer lock, std::shared_mutex is not available in C++14
+typedef std::shared_timed_mutex SharedMutex;
+
+/**
+ * @struct LockTraits
+ * @brief Tells how to take @p _Lock for reading, exclusively unless it supports shared locking
+ */
+template<typename _Lock>
+struct LockTraits {
+    enum : bool { isShared = false };
+
+    static void lockShared(_Lock& lock)
+    { lock.lock(); }
+
+    static void unlockShared(_Lock& lock) noexcept
+    { lock.unlock(); }
+};
+
+template<>
+struct LockTraits<SharedMutex> {
+    enum : bool { isShared = true };
+
+    static void lockShared(SharedMutex& lock)
+    { lock.lock_shared(); }
+
+    static void unlockShared(SharedMutex& lock) noexcept
+    { lock.unlock_shared(); }
+};
+
+/**
+ * @class SharedLockGuard
+ * @brief Like std::lock_guard, but takes the lock for reading
+ */
+template<typename _Lock>
+class SharedLockGuard {
+public:
+    explicit SharedLockGuard(_Lock& lock) : lock(lock)
+    { LockTraits<_Lock>::lockShared(lock); }
+
+    ~SharedLockGuard()
+    { LockTraits<_Lock>::unlockShared(lock); }
+
+    SharedLockGuard(const SharedLockGuard&) = delete;
+    SharedLockGuard& operator=(const SharedLockGuard&) = delete;
+
+private:
+    _Lock& lock;
+};
+
+#endif //THREADING_LOCKPOLICY_H
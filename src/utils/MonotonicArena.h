@@ -0,0 +1,214 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_MONOTONICARENA_H
+#define THREADING_MONOTONICARENA_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+/**
+ * @class MemoryResource
+ * @brief Polymorphic memory resource with the interface of std::pmr::memory_resource
+ */
+class MemoryResource {
+public:
+    virtual ~MemoryResource() = default;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t))
+    { return do_allocate(bytes, alignment); }
+
+    void deallocate(void* p, size_t bytes, size_t alignment = alignof(std::max_align_t))
+    { do_deallocate(p, bytes, alignment); }
+
+    bool is_equal(const MemoryResource& other) const noexcept
+    { return do_is_equal(other); }
+
+protected:
+    virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+    virtual void do_deallocate(void* p, size_t bytes, size_t alignment) = 0;
+    virtual bool do_is_equal(const MemoryResource& other) const noexcept
+    { return this == &other; }
+};
+
+/**
+ * @struct ArenaStats
+ * @brief Usage of a MonotonicArena over its resets
+ */
+struct ArenaStats {
+    /// Maximal number of bytes allocated between two resets
+    size_t peakUsed = 0;
+    /// Bytes of memory currently owned by the arena
+    size_t capacity = 0;
+    /// Number of resets
+    uint64_t resets = 0;
+};
+
+/**
+ * @class MonotonicArena
+ * @brief Bump allocator which frees everything at once on reset()
+ *
+ * deallocate() does nothing, memory is reclaimed by reset() only.
+ * Memory is taken from malloc in growing chunks. On reset the arena keeps
+ * a single chunk as large as all the chunks it needed, so in a steady state
+ * it does not call malloc at all.
+ * An arena must be used by one thread at a time, getStats() may be called by any thread.
+ */
+class MonotonicArena : public MemoryResource {
+public:
+    /**
+     * @param initialSize size of the first chunk, allocated on first use
+     */
+    explicit MonotonicArena(size_t initialSize = 16 * 1024)
+            : nextChunkSize(std::max<size_t>(initialSize, 256)) { }
+
+    ~MonotonicArena() override
+    { freeChunks(); }
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    /**
+     * @brief Makes all memory allocated since previous reset available again
+     */
+    void reset()
+    {
+        size_t used = usedBytes;
+        if (used > peakUsed.load(std::memory_order_relaxed))
+            peakUsed.store(used, std::memory_order_relaxed);
+        resets.store(resets.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        usedBytes = 0;
+        if (!chunks)
+            return;
+
+        if (chunks->previous) {
+            // Several chunks were needed, replace them with one that fits them all
+            size_t total = capacityBytes.load(std::memory_order_relaxed);
+            freeChunks();
+            addChunk(total - sizeof(Chunk));
+        }
+        current = chunks->data();
+        end = current + chunks->size;
+    }
+
+    /**
+     * @return bytes allocated since previous reset
+     */
+    size_t getUsed() const noexcept
+    { return usedBytes; }
+
+    ArenaStats getStats() const noexcept
+    {
+        ArenaStats stats;
+        stats.peakUsed = peakUsed.load(std::memory_order_relaxed);
+        stats.capacity = capacityBytes.load(std::memory_order_relaxed);
+        stats.resets = resets.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        uintptr_t aligned = alignUp(reinterpret_cast<uintptr_t>(current), alignment);
+        if (!current || aligned + bytes > reinterpret_cast<uintptr_t>(end)) {
+            addChunk(std::max(nextChunkSize, bytes + alignment));
+            aligned = alignUp(reinterpret_cast<uintptr_t>(current), alignment);
+        }
+        current = reinterpret_cast<char*>(aligned + bytes);
+        usedBytes += bytes;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    void do_deallocate(void*, size_t, size_t) override { }
+
+private:
+    struct Chunk {
+        Chunk* previous;
+        size_t size;
+
+        char* data() noexcept
+        { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    static uintptr_t alignUp(uintptr_t value, size_t alignment) noexcept
+    { return (value + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1); }
+
+    void addChunk(size_t size)
+    {
+        Chunk* chunk = static_cast<Chunk*>(std::malloc(sizeof(Chunk) + size));
+        if (!chunk)
+            throw std::bad_alloc();
+        chunk->previous = chunks;
+        chunk->size = size;
+        chunks = chunk;
+        current = chunk->data();
+        end = current + size;
+        capacityBytes.store(capacityBytes.load(std::memory_order_relaxed) + sizeof(Chunk) + size,
+                            std::memory_order_relaxed);
+        nextChunkSize = std::max(nextChunkSize, size) * 2;
+    }
+
+    void freeChunks()
+    {
+        while (chunks) {
+            Chunk* previous = chunks->previous;
+            std::free(chunks);
+            chunks = previous;
+        }
+        current = end = nullptr;
+        capacityBytes.store(0, std::memory_order_relaxed);
+    }
+
+    Chunk* chunks = nullptr;
+    char* current = nullptr;
+    char* end = nullptr;
+    size_t nextChunkSize;
+    size_t usedBytes = 0;
+    std::atomic<size_t> peakUsed{0};
+    std::atomic<size_t> capacityBytes{0};
+    std::atomic<uint64_t> resets{0};
+};
+
+/**
+ * @class ArenaAllocator
+ * @brief Standard allocator over a MemoryResource, like std::pmr::polymorphic_allocator
+ *
+ * @code std::vector<int, ArenaAllocator<int>> v(ArenaAllocator<int>(&getArena())); @endcode
+ */
+template<typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(MemoryResource* resource) noexcept : resource(resource) { }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : resource(other.getResource()) { }
+
+    T* allocate(size_t n)
+    { return static_cast<T*>(resource->allocate(n * sizeof(T), alignof(T))); }
+
+    void deallocate(T* p, size_t n)
+    { resource->deallocate(p, n * sizeof(T), alignof(T)); }
+
+    MemoryResource* getResource() const noexcept
+    { return resource; }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept
+    { return resource == other.getResource() || resource->is_equal(*other.getResource()); }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept
+    { return !(*this == other); }
+
+private:
+    MemoryResource* resource;
+};
+
+#endif //THREADING_MONOTONICARENA_H
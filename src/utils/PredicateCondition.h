@@ -7,13 +7,17 @@
 
 #include <memory>
 #include <mutex>
-#include <condition_variable>
 
+#include "EventCount.h"
 #include "SPtrFactoryBase.h"
 #include "../ThreadSafeBase.h"
 
 /**
  * @brief A Condition that is initialized with predicate
+ *
+ * Predicate is evaluated under the lock, so the state it reads may be
+ * modified between acquireLock() and releaseLock(). Notification does not
+ * take the lock and costs nothing while there are no waiters.
  * @tparam Predicate Predicate
  */
 template<typename Predicate>
@@ -34,24 +38,28 @@ public:
      * @brief Notifies one thread waiting on condition variable
      */
     void notify_one() {
-        std::lock_guard<std::mutex> guard(mutex);
-        cond.notify_one();
+        eventCount.notify_one();
     }
 
     /**
      * @brief Notifies all threads waiting on condition variable
      */
     void notify_all() {
-        std::lock_guard<std::mutex> guard(mutex);
-        cond.notify_all();
+        eventCount.notify_all();
     }
 
     /**
      * @brief Blocks thread of execution until predicate evaluates to true
      */
     void wait() {
-        std::unique_lock<std::mutex> lock(mutex);
-        cond.wait(lock, predicate);
+        while (true) {
+            EventCount::Key key = eventCount.prepareWait();
+            if (check()) {
+                eventCount.cancelWait();
+                return;
+            }
+            eventCount.commitWait(key);
+        }
     }
 
     /**
@@ -63,13 +71,31 @@ public:
      */
     template<typename Rep, typename Period>
     bool wait_for(const std::chrono::duration<Rep, Period>& time) {
-        std::unique_lock<std::mutex> lock(mutex);
-        return cond.wait_for(lock, time, predicate);
+        auto deadline = std::chrono::steady_clock::now() + time;
+        while (true) {
+            EventCount::Key key = eventCount.prepareWait();
+            if (check()) {
+                eventCount.cancelWait();
+                return true;
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                eventCount.cancelWait();
+                return check();
+            }
+            if (!eventCount.commitWaitFor(key, deadline - now))
+                return check();
+        }
     }
 
 private:
+    bool check() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return predicate();
+    }
+
     Predicate predicate;
-    std::condition_variable cond;
+    EventCount eventCount;
 };
 
 #endif //THREADING_PREDICATECONDITION_H
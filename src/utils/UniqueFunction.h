@@ -0,0 +1,194 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_UNIQUEFUNCTION_H
+#define THREADING_UNIQUEFUNCTION_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template<typename _Signature, std::size_t _InlineSize = 6 * sizeof(void*)>
+class UniqueFunction;
+
+/**
+ * @class UniqueFunction
+ * @brief Move-only replacement of std::function
+ *
+ * Callables up to @p _InlineSize bytes that are nothrow move constructible are
+ * stored inside the object, larger ones are allocated on the heap.
+ * Since it is never copied, it can hold move-only callables,
+ * e.g. lambdas capturing std::unique_ptr or a query result.
+ * @tparam _InlineSize size of inline storage, by default enough
+ *         for a lambda capturing a few pointers and a shared_ptr
+ */
+template<typename _Result, typename... _Args, std::size_t _InlineSize>
+class UniqueFunction<_Result(_Args...), _InlineSize> {
+public:
+    UniqueFunction() noexcept : ops(nullptr) { }
+
+    UniqueFunction(std::nullptr_t) noexcept : ops(nullptr) { }
+
+    template<typename _Function,
+             typename _Decayed = typename std::decay<_Function>::type,
+             typename = typename std::enable_if<!std::is_same<_Decayed, UniqueFunction>::value>::type>
+    UniqueFunction(_Function&& function) : ops(nullptr)
+    {
+        if (isEmpty(function))
+            return;
+        Storage<_Decayed>::create(buffer, std::forward<_Function>(function));
+        ops = Storage<_Decayed>::operations();
+    }
+
+    UniqueFunction(UniqueFunction&& other) noexcept : ops(other.ops)
+    {
+        if (ops) {
+            ops->move(other.buffer, buffer);
+            other.ops = nullptr;
+        }
+    }
+
+    UniqueFunction& operator=(UniqueFunction&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            if (other.ops) {
+                other.ops->move(other.buffer, buffer);
+                ops = other.ops;
+                other.ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    UniqueFunction& operator=(std::nullptr_t) noexcept
+    {
+        reset();
+        return *this;
+    }
+
+    UniqueFunction(const UniqueFunction&) = delete;
+    UniqueFunction& operator=(const UniqueFunction&) = delete;
+
+    ~UniqueFunction()
+    {
+        reset();
+    }
+
+    /**
+     * @throws std::bad_function_call if the function is empty
+     */
+    _Result operator()(_Args... args)
+    {
+        if (!ops)
+            throw std::bad_function_call();
+        return ops->invoke(buffer, std::forward<_Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept
+    { return ops != nullptr; }
+
+    /**
+     * @return true if the callable is stored inline and did not allocate
+     */
+    bool isInline() const noexcept
+    { return ops && ops->isInline; }
+
+private:
+    typedef typename std::aligned_storage<_InlineSize, alignof(std::max_align_t)>::type Buffer;
+
+    /// Per callable type table of operations, the only indirection of a call
+    struct Operations {
+        _Result (*invoke)(Buffer&, _Args&&...);
+        /// Moves callable from the first buffer to the second one and destroys the source
+        void (*move)(Buffer&, Buffer&) noexcept;
+        void (*destroy)(Buffer&) noexcept;
+        bool isInline;
+    };
+
+    template<typename _Function,
+             bool = sizeof(_Function) <= _InlineSize &&
+                    alignof(_Function) <= alignof(std::max_align_t) &&
+                    std::is_nothrow_move_constructible<_Function>::value>
+    struct Storage {
+        template<typename _F>
+        static void create(Buffer& buffer, _F&& function)
+        { new (&buffer) _Function(std::forward<_F>(function)); }
+
+        static _Function& get(Buffer& buffer) noexcept
+        { return *reinterpret_cast<_Function*>(&buffer); }
+
+        static _Result invoke(Buffer& buffer, _Args&&... args)
+        { return get(buffer)(std::forward<_Args>(args)...); }
+
+        static void move(Buffer& from, Buffer& to) noexcept
+        {
+            new (&to) _Function(std::move(get(from)));
+            get(from).~_Function();
+        }
+
+        static void destroy(Buffer& buffer) noexcept
+        { get(buffer).~_Function(); }
+
+        static const Operations* operations() noexcept
+        {
+            static constexpr Operations ops = {&invoke, &move, &destroy, true};
+            return &ops;
+        }
+    };
+
+    template<typename _Function>
+    struct Storage<_Function, false> {
+        template<typename _F>
+        static void create(Buffer& buffer, _F&& function)
+        { new (&buffer) _Function*(new _Function(std::forward<_F>(function))); }
+
+        static _Function*& get(Buffer& buffer) noexcept
+        { return *reinterpret_cast<_Function**>(&buffer); }
+
+        static _Result invoke(Buffer& buffer, _Args&&... args)
+        { return (*get(buffer))(std::forward<_Args>(args)...); }
+
+        static void move(Buffer& from, Buffer& to) noexcept
+        { new (&to) _Function*(get(from)); }
+
+        static void destroy(Buffer& buffer) noexcept
+        { delete get(buffer); }
+
+        static const Operations* operations() noexcept
+        {
+            static constexpr Operations ops = {&invoke, &move, &destroy, false};
+            return &ops;
+        }
+    };
+
+    // Null function pointers and empty std::function produce empty UniqueFunction
+    template<typename _Function>
+    static bool isEmpty(_Function* function) noexcept
+    { return function == nullptr; }
+
+    template<typename _Signature>
+    static bool isEmpty(const std::function<_Signature>& function) noexcept
+    { return !function; }
+
+    template<typename _Function>
+    static bool isEmpty(const _Function&) noexcept
+    { return false; }
+
+    void reset() noexcept
+    {
+        if (ops) {
+            ops->destroy(buffer);
+            ops = nullptr;
+        }
+    }
+
+    const Operations* ops;
+    Buffer buffer;
+};
+
+#endif //THREADING_UNIQUEFUNCTION_H
@@ -0,0 +1,221 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_WAITSTRATEGY_H
+#define THREADING_WAITSTRATEGY_H
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+/**
+ * @brief Hints the CPU that the caller is spinning
+ */
+inline void cpuRelax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+/**
+ * @enum WaitPolicy
+ * @brief Describes how a thread waits for work
+ */
+enum class WaitPolicy {
+    BusySpin = 0, ///< Spins on the predicate, never yields the CPU. Lowest latency, burns a core
+    SpinYield,    ///< Spins for a while, then keeps checking the predicate calling yield()
+    SpinPark,     ///< Spins for an adaptive number of iterations, then blocks on the condition
+    Block         ///< Blocks on the condition right away
+};
+
+/**
+ * @class WaitStrategy
+ * @brief Waits until predicate becomes true according to the WaitPolicy
+ *
+ * Condition type passed to wait() must provide wait(Predicate) and
+ * wait_for(duration, Predicate), e.g. Condition or EventCount.
+ * Spinning policies do not need notification to wake up, but notifier must still
+ * notify the condition, because WaitPolicy::SpinPark may be blocked on it.
+ *
+ * WaitStrategy keeps adaptive spin state, so each thread must own its copy.
+ */
+class WaitStrategy {
+public:
+    /**
+     * @param policy how to wait
+     * @param maxSpins upper limit of spin iterations before yielding or parking
+     */
+    explicit WaitStrategy(WaitPolicy policy = WaitPolicy::Block, unsigned int maxSpins = 4000)
+            : policy(policy)
+            , maxSpins(std::max<unsigned int>(minSpins, maxSpins))
+            , spinBudget(this->maxSpins) { }
+
+    WaitPolicy getPolicy() const noexcept
+    { return policy; }
+
+    /**
+     * @brief Blocks thread of execution until predicate evaluates to true
+     */
+    template<typename ConditionType, typename Predicate>
+    void wait(ConditionType& cond, Predicate p)
+    {
+        switch (policy) {
+        case WaitPolicy::BusySpin:
+            while (!p())
+                cpuRelax();
+            return;
+        case WaitPolicy::SpinYield:
+            if (spin(maxSpins, p))
+                return;
+            while (!p())
+                std::this_thread::yield();
+            return;
+        case WaitPolicy::SpinPark:
+            if (spinAdaptive(p))
+                return;
+            cond.wait(p);
+            return;
+        case WaitPolicy::Block:
+            cond.wait(p);
+            return;
+        }
+    }
+
+    /**
+     * @brief Blocks thread of execution for specified amount of time
+     * until predicate evaluates to true or timeout expires
+     * @return false if the predicate still evaluates to false
+     *         after the timeout expired, otherwise true
+     */
+    template<typename ConditionType, typename Rep, typename Period, typename Predicate>
+    bool waitFor(ConditionType& cond, const std::chrono::duration<Rep, Period>& time, Predicate p)
+    {
+        auto deadline = std::chrono::steady_clock::now() + time;
+        switch (policy) {
+        case WaitPolicy::BusySpin:
+        case WaitPolicy::SpinYield:
+            for (unsigned int i = 0; !p(); i++) {
+                if (i >= maxSpins && policy == WaitPolicy::SpinYield)
+                    std::this_thread::yield();
+                else
+                    cpuRelax();
+                // Reading the clock is expensive, do it once per batch of spins
+                if ((i & 63) == 0 && std::chrono::steady_clock::now() >= deadline)
+                    return p();
+            }
+            return true;
+        case WaitPolicy::SpinPark:
+            if (spinAdaptive(p))
+                return true;
+            return cond.wait_for(remaining(deadline), p);
+        case WaitPolicy::Block:
+            return cond.wait_for(time, p);
+        }
+        return p();
+    }
+
+private:
+    enum : unsigned int { minSpins = 16 };
+
+    template<typename Predicate>
+    static bool spin(unsigned int spins, Predicate& p)
+    {
+        for (unsigned int i = 0; i < spins; i++) {
+            if (p())
+                return true;
+            cpuRelax();
+        }
+        return p();
+    }
+
+    /*
+     * Spin budget grows while spinning pays off and shrinks each time
+     * the thread had to park anyway, so mostly idle threads stop wasting CPU
+     */
+    template<typename Predicate>
+    bool spinAdaptive(Predicate& p)
+    {
+        if (spin(spinBudget, p)) {
+            spinBudget = std::min(maxSpins, spinBudget + spinBudget / 2);
+            return true;
+        }
+        spinBudget = std::max<unsigned int>(minSpins, spinBudget / 2);
+        return false;
+    }
+
+    static std::chrono::steady_clock::duration
+    remaining(std::chrono::steady_clock::time_point deadline)
+    {
+        auto now = std::chrono::steady_clock::now();
+        return deadline > now ? deadline - now : std::chrono::steady_clock::duration::zero();
+    }
+
+    WaitPolicy policy;
+    unsigned int maxSpins;
+    unsigned int spinBudget;
+};
+
+/**
+ * @struct DynamicWait
+ * @brief Compile-time wait policy which defers to the thread's runtime WaitStrategy
+ *
+ * Compile-time wait policies are used by QueryWorker, they provide static
+ * wait(strategy, cond, pred) and waitFor(strategy, cond, time, pred).
+ */
+struct DynamicWait {
+    template<typename ConditionType, typename Predicate>
+    static void wait(WaitStrategy& strategy, ConditionType& cond, Predicate p)
+    { strategy.wait(cond, p); }
+
+    template<typename ConditionType, typename Rep, typename Period, typename Predicate>
+    static bool waitFor(WaitStrategy& strategy, ConditionType& cond,
+                        const std::chrono::duration<Rep, Period>& time, Predicate p)
+    { return strategy.waitFor(cond, time, p); }
+};
+
+/**
+ * @struct BlockingWait
+ * @brief Compile-time wait policy which always blocks on the condition
+ */
+struct BlockingWait {
+    template<typename ConditionType, typename Predicate>
+    static void wait(WaitStrategy&, ConditionType& cond, Predicate p)
+    { cond.wait(p); }
+
+    template<typename ConditionType, typename Rep, typename Period, typename Predicate>
+    static bool waitFor(WaitStrategy&, ConditionType& cond,
+                        const std::chrono::duration<Rep, Period>& time, Predicate p)
+    { return cond.wait_for(time, p); }
+};
+
+/**
+ * @struct SpinningWait
+ * @brief Compile-time wait policy which spins on the predicate and never yields the CPU
+ */
+struct SpinningWait {
+    template<typename ConditionType, typename Predicate>
+    static void wait(WaitStrategy&, ConditionType&, Predicate p)
+    {
+        while (!p())
+            cpuRelax();
+    }
+
+    template<typename ConditionType, typename Rep, typename Period, typename Predicate>
+    static bool waitFor(WaitStrategy&, ConditionType&,
+                        const std::chrono::duration<Rep, Period>& time, Predicate p)
+    {
+        auto deadline = std::chrono::steady_clock::now() + time;
+        for (unsigned int i = 0; !p(); i++) {
+            cpuRelax();
+            if ((i & 63) == 0 && std::chrono::steady_clock::now() >= deadline)
+                return p();
+        }
+        return true;
+    }
+};
+
+#endif //THREADING_WAITSTRATEGY_H
@@ -0,0 +1,86 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_HEARTBEAT_H
+#define THREADING_HEARTBEAT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "utils/SPtrFactoryBase.h"
+
+/**
+ * @class Heartbeat
+ * @brief Progress of one worker, written by the worker and read by Watchdog
+ *
+ * Worker calls begin() before each unit of work (query, task) and end() after it.
+ * Only atomics are touched, so it costs two clock reads per unit of work.
+ */
+class Heartbeat : public SPtrFactoryBase<Heartbeat> {
+public:
+    Heartbeat() : workStartNs(0), lastBeatNs(nowNs()), work(nullptr), completed(0) { }
+
+    /**
+     * @param what name of the work, must have static storage duration, e.g. typeid(...).name()
+     */
+    void begin(const char* what) noexcept
+    {
+        int64_t now = nowNs();
+        work.store(what, std::memory_order_relaxed);
+        lastBeatNs.store(now, std::memory_order_relaxed);
+        workStartNs.store(now, std::memory_order_release);
+    }
+
+    void end() noexcept
+    {
+        workStartNs.store(0, std::memory_order_relaxed);
+        lastBeatNs.store(nowNs(), std::memory_order_relaxed);
+        completed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return time current work has been running, 0 if the worker is idle
+     */
+    std::chrono::nanoseconds getBusyTime() const noexcept
+    {
+        int64_t start = workStartNs.load(std::memory_order_acquire);
+        return std::chrono::nanoseconds(start == 0 ? 0 : nowNs() - start);
+    }
+
+    /**
+     * @return start of current work in steady clock nanoseconds, 0 if the worker is idle
+     */
+    int64_t getWorkStart() const noexcept
+    { return workStartNs.load(std::memory_order_acquire); }
+
+    /**
+     * @return name given to begin() for current or last work, nullptr if there was none
+     */
+    const char* getWork() const noexcept
+    { return work.load(std::memory_order_relaxed); }
+
+    /**
+     * @return time since the worker last began or finished work
+     */
+    std::chrono::nanoseconds getSinceLastBeat() const noexcept
+    { return std::chrono::nanoseconds(nowNs() - lastBeatNs.load(std::memory_order_relaxed)); }
+
+    uint64_t getCompleted() const noexcept
+    { return completed.load(std::memory_order_relaxed); }
+
+private:
+    static int64_t nowNs() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::atomic<int64_t> workStartNs;
+    std::atomic<int64_t> lastBeatNs;
+    std::atomic<const char*> work;
+    std::atomic<uint64_t> completed;
+};
+
+#endif //THREADING_HEARTBEAT_H
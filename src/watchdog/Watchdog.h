@@ -0,0 +1,208 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_WATCHDOG_H
+#define THREADING_WATCHDOG_H
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+#include "Heartbeat.h"
+#include "../ThreadBase.h"
+#include "utils/EventCount.h"
+#include "utils/SPtrFactoryBase.h"
+
+/**
+ * @struct StallReport
+ * @brief Worker which has been running one query or task longer than the budget
+ */
+struct StallReport {
+    /// Name the worker was registered with
+    std::string worker;
+    /// Type of the query or task being run
+    std::string work;
+    /// Time the work has been running
+    std::chrono::milliseconds elapsed;
+    /// Units of work the worker has completed before
+    uint64_t completed;
+};
+
+/**
+ * @class Watchdog
+ * @brief Thread which reports workers stuck in a query or task
+ *
+ * Workers are registered with watchThread(), which attaches a Heartbeat to them.
+ * Every check period the watchdog calls the stall handler once for every
+ * query or task that has been running longer than the budget.
+ * The handler runs on the watchdog thread, it can log the report or add
+ * watched replacement threads to a running pool with addWatchedThread().
+ */
+class Watchdog : public ThreadBase, public SPtrFactoryBase<Watchdog> {
+public:
+    typedef std::function<void(const StallReport&)> StallHandler;
+
+    /**
+     * @param budget maximal time a query or task may run
+     * @param checkPeriod how often heartbeats are checked
+     */
+    Watchdog(std::chrono::milliseconds budget, std::chrono::milliseconds checkPeriod,
+             StallHandler handler)
+            : budget(budget), checkPeriod(checkPeriod), handler(std::move(handler)) { }
+
+    ~Watchdog() override
+    {
+        stopThread();
+        joinThread();
+    }
+
+    void stopThread() override
+    {
+        ThreadBase::stopThread();
+        stopCondition.notify_all();
+    }
+
+    /**
+     * @brief Starts watching a thread with setHeartbeat(), e.g. any query thread or TaskThread.
+     *
+     * Must be called before the thread is started.
+     */
+    template<typename _ThreadType>
+    void watchThread(_ThreadType& thread, const std::string& name)
+    {
+        Heartbeat::SPtr heartbeat = Heartbeat::create();
+        thread.setHeartbeat(heartbeat);
+        watch(heartbeat, name);
+    }
+
+    /**
+     * @brief Starts watching every thread of a thread pool, must be called before the pool is started
+     */
+    template<typename _PoolType>
+    void watchPool(_PoolType& pool, const std::string& name)
+    {
+        size_t index = 0;
+        pool.forEachThread([&](const typename _PoolType::ThreadTypePtr& thread) {
+            watchThread(*thread, name + "#" + std::to_string(index++));
+        });
+    }
+
+    /**
+     * @brief Adds thread to @p pool and watches it, the heartbeat is attached before the thread starts
+     * @param args passed to the pool's addThread()
+     * @return added thread
+     */
+    template<typename _PoolType, typename... Args>
+    typename _PoolType::ThreadTypePtr addWatchedThread(_PoolType& pool, const std::string& name, Args&&... args)
+    {
+        return pool.addConfiguredThread([this, &name](typename _PoolType::ThreadType& thread) {
+            watchThread(thread, name);
+        }, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Starts watching a heartbeat updated by custom worker
+     */
+    void watch(const Heartbeat::SPtr& heartbeat, const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(watchedMutex);
+        watched.push_back(Watched{heartbeat, name, 0});
+    }
+
+    /**
+     * @brief Stops watching the heartbeat
+     */
+    void unwatch(const Heartbeat::SPtr& heartbeat)
+    {
+        std::lock_guard<std::mutex> lock(watchedMutex);
+        for (auto it = watched.begin(); it != watched.end(); ++it) {
+            if (it->heartbeat == heartbeat) {
+                watched.erase(it);
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Checks all heartbeats now, called by the watchdog thread every check period
+     * @return reports of workers over budget which were not reported yet
+     */
+    std::vector<StallReport> check()
+    {
+        std::vector<StallReport> reports;
+        std::lock_guard<std::mutex> lock(watchedMutex);
+        for (Watched& entry : watched) {
+            int64_t start = entry.heartbeat->getWorkStart();
+            if (start == 0 || start == entry.reportedStart)
+                continue;
+            std::chrono::nanoseconds busy = entry.heartbeat->getBusyTime();
+            if (busy < budget)
+                continue;
+            entry.reportedStart = start;
+            StallReport report;
+            report.worker = entry.name;
+            report.work = demangle(entry.heartbeat->getWork());
+            report.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(busy);
+            report.completed = entry.heartbeat->getCompleted();
+            reports.push_back(std::move(report));
+        }
+        return reports;
+    }
+
+private:
+    struct Watched {
+        Heartbeat::SPtr heartbeat;
+        std::string name;
+        /// Work start which was already reported, every stall is reported once
+        int64_t reportedStart;
+    };
+
+    /// The watchdog paces itself in threadIteration()
+    bool hasWork() override
+    { return true; }
+
+    void threadIteration() override
+    {
+        stopCondition.wait_for(checkPeriod, WAKE_IF(!isRunning()));
+        if (!isRunning())
+            return;
+        // Handler may call watch(), so it runs without the lock
+        for (const StallReport& report : check())
+            handler(report);
+    }
+
+    static std::string demangle(const char* name)
+    {
+        if (!name)
+            return std::string();
+#if defined(__GNUG__)
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+        if (status == 0 && demangled) {
+            std::string result(demangled);
+            std::free(demangled);
+            return result;
+        }
+#endif
+        return name;
+    }
+
+    const std::chrono::milliseconds budget;
+    const std::chrono::milliseconds checkPeriod;
+    StallHandler handler;
+    EventCount stopCondition;
+    std::mutex watchedMutex;
+    std::vector<Watched> watched;
+};
+
+#endif //THREADING_WATCHDOG_H
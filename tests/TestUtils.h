@@ -0,0 +1,123 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#ifndef THREADING_TESTUTILS_H
+#define THREADING_TESTUTILS_H
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Helpers shared by test executables: test registry, checks and a runner.
+ * Every test executable registers its tests with TEST() and calls
+ * test::runAll() from main(), ctest runs each executable.
+ */
+namespace test {
+
+/**
+ * @brief Thrown by a failed CHECK()
+ */
+class CheckFailed : public std::runtime_error {
+public:
+    explicit CheckFailed(const std::string& what) : std::runtime_error(what) { }
+};
+
+struct TestCase {
+    std::string name;
+    std::function<void()> body;
+};
+
+inline std::vector<TestCase>& registry()
+{
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+struct Registrar {
+    Registrar(const char* name, std::function<void()> body)
+    {
+        registry().push_back(TestCase{name, std::move(body)});
+    }
+};
+
+inline void fail(const char* file, int line, const std::string& message)
+{
+    std::ostringstream out;
+    out << file << ":" << line << ": " << message;
+    throw CheckFailed(out.str());
+}
+
+/**
+ * @brief Polls @p predicate until it is true or @p timeout expires
+ * @return last value of the predicate
+ */
+template<typename Predicate>
+bool waitUntil(Predicate predicate, std::chrono::milliseconds timeout = std::chrono::milliseconds(5000))
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return predicate();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+/**
+ * @brief Runs registered tests whose name contains the first argument, if given
+ * @return process exit code, 0 if all tests passed
+ */
+inline int runAll(int argc, char** argv)
+{
+    std::string filter = argc > 1 ? argv[1] : "";
+    int failed = 0;
+    for (const auto& test : registry()) {
+        if (!filter.empty() && test.name.find(filter) == std::string::npos)
+            continue;
+        try {
+            test.body();
+            std::cout << "[ OK ] " << test.name << std::endl;
+        } catch (std::exception& e) {
+            std::cout << "[FAIL] " << test.name << ": " << e.what() << std::endl;
+            failed++;
+        }
+    }
+    return failed == 0 ? 0 : 1;
+}
+
+} // namespace test
+
+#define TEST_CONCAT_IMPL(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_IMPL(a, b)
+
+/**
+ * Defines and registers a test: @code TEST(name) { CHECK(...); } @endcode
+ */
+#define TEST(name) \
+    static void name(); \
+    static test::Registrar TEST_CONCAT(registrar_, name)(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    do { if (!(condition)) test::fail(__FILE__, __LINE__, "CHECK(" #condition ") failed"); } while (false)
+
+/**
+ * Checks that @p statement throws @p exception
+ */
+#define CHECK_THROWS(statement, exception) \
+    do { \
+        bool thrown = false; \
+        try { statement; } catch (exception&) { thrown = true; } \
+        if (!thrown) test::fail(__FILE__, __LINE__, #statement " did not throw " #exception); \
+    } while (false)
+
+#endif //THREADING_TESTUTILS_H
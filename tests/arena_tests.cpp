@@ -0,0 +1,126 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "TestUtils.h"
+#include "query_thread/QueryBase.h"
+#include "query_thread/QueryQueueBase.h"
+#include "query_thread/QueryWorker.h"
+#include "utils/MonotonicArena.h"
+
+namespace {
+
+struct ValueQuery : QueryBase<int> {
+    explicit ValueQuery(int value) : value(value) { }
+    int value;
+};
+
+typedef std::shared_ptr<ValueQuery> ValueQueryPtr;
+
+/*
+ * Sums 0..value-1 in a vector allocated from the worker's arena
+ */
+struct ArenaHandler {
+    std::shared_ptr<std::atomic<size_t>> dirtyStarts = std::make_shared<std::atomic<size_t>>(0);
+
+    void operator()(ValueQueryPtr query, MonotonicArena& arena)
+    {
+        if (arena.getUsed() != 0)
+            (*dirtyStarts)++;
+        std::vector<int, ArenaAllocator<int>> values{ArenaAllocator<int>(&arena)};
+        for (int i = 0; i < query->value; i++)
+            values.push_back(i);
+        int sum = 0;
+        for (int value : values)
+            sum += value;
+        query->setResult(sum);
+    }
+};
+
+bool isAligned(const void* p, size_t alignment)
+{ return reinterpret_cast<uintptr_t>(p) % alignment == 0; }
+
+} // namespace
+
+TEST(allocationsAreAlignedAndDoNotOverlap)
+{
+    MonotonicArena arena(256);
+    std::vector<std::pair<char*, size_t>> blocks;
+    for (size_t i = 1; i < 200; i++) {
+        size_t alignment = size_t(1) << (i % 7);
+        char* p = static_cast<char*>(arena.allocate(i, alignment));
+        CHECK(isAligned(p, alignment));
+        blocks.emplace_back(p, i);
+    }
+    std::sort(blocks.begin(), blocks.end());
+    for (size_t i = 1; i < blocks.size(); i++)
+        CHECK(blocks[i - 1].first + blocks[i - 1].second <= blocks[i].first);
+    CHECK(arena.getUsed() == 199 * 200 / 2);
+}
+
+TEST(resetKeepsOneChunkFittingTheLargestRound)
+{
+    MonotonicArena arena(256);
+    for (int i = 0; i < 10; i++)
+        arena.allocate(200);
+    size_t grown = arena.getStats().capacity;
+    CHECK(grown > 2000);
+
+    arena.reset();
+    CHECK(arena.getUsed() == 0);
+    CHECK(arena.getStats().capacity == grown);
+    // Same round again fits the single chunk
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 10; i++)
+            arena.allocate(200);
+        arena.reset();
+        CHECK(arena.getStats().capacity == grown);
+    }
+    ArenaStats stats = arena.getStats();
+    CHECK(stats.resets == 4);
+    CHECK(stats.peakUsed == 2000);
+}
+
+TEST(allocatorBacksStandardContainers)
+{
+    MonotonicArena arena;
+    std::vector<int, ArenaAllocator<int>> values{ArenaAllocator<int>(&arena)};
+    for (int i = 0; i < 1000; i++)
+        values.push_back(i);
+    CHECK(values[999] == 999);
+    CHECK(arena.getUsed() >= 1000 * sizeof(int));
+
+    ArenaAllocator<long> other(values.get_allocator());
+    CHECK(other == values.get_allocator());
+    MonotonicArena second;
+    CHECK(ArenaAllocator<int>(&second) != values.get_allocator());
+}
+
+TEST(workerResetsArenaAfterEveryQuery)
+{
+    auto queue = std::make_shared<QueryQueueBase<ValueQuery>>();
+    ArenaHandler handler;
+    QueryWorker<QueryQueueBase<ValueQuery>, ArenaHandler> worker(queue, handler);
+    worker.startThread();
+    for (int i = 1; i <= 50; i++)
+        CHECK(worker.emplaceQueryAndGetResult(i * 10) == i * 10 * (i * 10 - 1) / 2);
+
+    CHECK(*handler.dirtyStarts == 0);
+    // The last reset follows the last result
+    CHECK(test::waitUntil([&] { return worker.getArenaStats().resets >= 50; }));
+    ArenaStats stats = worker.getArenaStats();
+    CHECK(stats.peakUsed >= 500 * sizeof(int));
+    CHECK(stats.capacity > 0);
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
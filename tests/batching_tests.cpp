@@ -0,0 +1,175 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "TestUtils.h"
+#include "query_thread/QueryBase.h"
+#include "query_thread/QueryQueueBase.h"
+#include "query_thread/QueryThreadBatching.h"
+#include "query_thread/QueryThreadPool.h"
+#include "query_thread/QueryWorker.h"
+
+namespace {
+
+struct ValueQuery : QueryBase<int> {
+    explicit ValueQuery(int value) : value(value) { }
+    int value;
+};
+
+typedef std::shared_ptr<ValueQuery> ValueQueryPtr;
+typedef QueryQueueBase<ValueQuery> Queue;
+
+struct BatchHandler {
+    std::shared_ptr<std::atomic<int>> batches = std::make_shared<std::atomic<int>>(0);
+
+    void operator()(std::vector<ValueQueryPtr>& batch)
+    {
+        (*batches)++;
+        for (const auto& query : batch)
+            query->setResult(query->value + 1);
+    }
+};
+
+/*
+ * Sums the batch in the worker's arena, counts ticks
+ */
+struct TickingArenaHandler {
+    std::shared_ptr<std::atomic<int>> ticks = std::make_shared<std::atomic<int>>(0);
+
+    void operator()(std::vector<ValueQueryPtr>& batch, MonotonicArena& arena)
+    {
+        int* sum = static_cast<int*>(arena.allocate(sizeof(int), alignof(int)));
+        *sum = 0;
+        for (const auto& query : batch)
+            *sum += query->value;
+        for (const auto& query : batch)
+            query->setResult(*sum);
+    }
+
+    void onTick()
+    { (*ticks)++; }
+};
+
+class CountingBatchThread : public QueryThreadBatching<ValueQuery> {
+public:
+    CountingBatchThread(unsigned int maxBatchSize = 4,
+                        std::chrono::milliseconds maxDelay = std::chrono::milliseconds(20)) :
+            QueryThreadBatching<ValueQuery>(maxBatchSize, maxDelay, std::chrono::milliseconds(5)) { }
+
+    ~CountingBatchThread()
+    {
+        stopThread();
+        joinThread();
+    }
+
+    std::atomic<int> batches{0};
+    std::atomic<int> ticks{0};
+    std::atomic<size_t> largestBatch{0};
+
+protected:
+    void onBatch(Batch& queries) override
+    {
+        batches++;
+        if (queries.size() > largestBatch)
+            largestBatch = queries.size();
+        for (const auto& query : queries)
+            query->setResult(query->value * 2);
+    }
+
+    void onTick() override
+    { ticks++; }
+};
+
+} // namespace
+
+TEST(batchingThreadFlushesBySizeDelayAndTicks)
+{
+    CountingBatchThread thread;
+    thread.startThread();
+    // A single query is flushed by the delay
+    CHECK(thread.emplaceQueryAndGetResult(3) == 6);
+
+    std::vector<ValueQueryPtr> queries;
+    for (int i = 0; i < 9; i++) {
+        queries.push_back(std::make_shared<ValueQuery>(i));
+        thread.putQuery(queries.back());
+    }
+    for (int i = 0; i < 9; i++)
+        CHECK(queries[i]->getResult() == i * 2);
+    CHECK(thread.largestBatch <= 4);
+    CHECK(test::waitUntil([&] { return thread.ticks > 0; }));
+}
+
+TEST(fullBatchIsFlushedWithoutDelay)
+{
+    CountingBatchThread thread(4, std::chrono::seconds(10));
+    std::vector<ValueQueryPtr> queries;
+    for (int i = 0; i < 8; i++) {
+        queries.push_back(std::make_shared<ValueQuery>(i));
+        thread.putQuery(queries.back());
+    }
+    thread.startThread();
+    for (int i = 0; i < 8; i++)
+        CHECK(queries[i]->waitForResult(std::chrono::seconds(2)));
+    CHECK(thread.batches == 2);
+    CHECK(thread.largestBatch == 4);
+}
+
+TEST(stoppedThreadFlushesCollectedBatch)
+{
+    std::vector<ValueQueryPtr> queries;
+    {
+        CountingBatchThread thread(100, std::chrono::seconds(10));
+        thread.startThread();
+        for (int i = 0; i < 3; i++) {
+            queries.push_back(std::make_shared<ValueQuery>(i));
+            thread.putQuery(queries.back());
+        }
+        // Queries have left the queue for the batch, which waits for the delay
+        CHECK(test::waitUntil([&] { return thread.getQueue()->isEmpty(); }));
+        CHECK(!queries.front()->isCompleted());
+    }
+    for (int i = 0; i < 3; i++)
+        CHECK(queries[i]->getResult() == i * 2);
+}
+
+TEST(batchingWorkerWithFunctorHandler)
+{
+    typedef QueryWorker<Queue, BatchHandler, DynamicWait, NoTimeout, 1, NoHelping, BatchWindow> Worker;
+    BatchHandler handler;
+    QueryThreadPool<Worker> pool(2, std::make_shared<Queue>(), handler,
+                                 NoTimeout(), BatchWindow(3, std::chrono::milliseconds(5)));
+    pool.startThreads();
+    for (int i = 0; i < 20; i++)
+        CHECK(pool.emplaceQueryAndGetResult(i) == i + 1);
+    pool.stopThreads();
+    pool.joinThreads();
+    CHECK(*handler.batches > 0 && *handler.batches <= 20);
+}
+
+TEST(functorHandlerGetsArenaAndTicks)
+{
+    typedef QueryWorker<Queue, TickingArenaHandler, DynamicWait, NoTimeout, 1, NoHelping, BatchWindow> Worker;
+    TickingArenaHandler handler;
+    Worker worker(std::make_shared<Queue>(), handler, NoTimeout(),
+                  BatchWindow(3, std::chrono::seconds(10), std::chrono::milliseconds(5)));
+    std::vector<ValueQueryPtr> queries;
+    for (int i = 1; i <= 3; i++) {
+        queries.push_back(std::make_shared<ValueQuery>(i));
+        worker.putQuery(queries.back());
+    }
+    worker.startThread();
+    for (auto& query : queries)
+        CHECK(query->getResult() == 6);
+    CHECK(test::waitUntil([&] { return *handler.ticks >= 2; }));
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
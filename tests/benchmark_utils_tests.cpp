@@ -0,0 +1,60 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <string>
+#include <vector>
+
+#include "TestUtils.h"
+#include "../benchmarks/BenchmarkUtils.h"
+
+TEST(summaryUsesNearestRankPercentiles)
+{
+    std::vector<double> samples;
+    for (int i = 100; i >= 1; i--)
+        samples.push_back(i);
+    bench::Summary s = bench::summarize(samples);
+    CHECK(s.count == 100);
+    CHECK(s.mean == 50.5);
+    CHECK(s.p50 == 51);
+    CHECK(s.p90 == 91);
+    CHECK(s.p99 == 100);
+    CHECK(s.max == 100);
+
+    std::vector<double> empty;
+    CHECK(bench::summarize(empty).count == 0);
+}
+
+TEST(jsonObjectKeepsFieldOrderAndEscapes)
+{
+    bench::JsonObject json;
+    json.field("name", "a\"b").field("threads", 2u).field("ops_per_sec", 1.5).field("ok", true);
+    CHECK(json.str() == "{\"name\": \"a\\\"b\", \"threads\": 2, \"ops_per_sec\": 1.500, \"ok\": true}");
+}
+
+TEST(argsParseNamedValuesAndLists)
+{
+    const char* argv[] = {"bench", "--ops", "1000", "--rates", "10,20,,30", "--scale", "0.5"};
+    bench::Args args(7, const_cast<char**>(argv));
+    CHECK(args.getUInt("ops", 1) == 1000);
+    CHECK(args.getUInt("missing", 7) == 7);
+    CHECK(args.getDouble("scale", 1) == 0.5);
+    std::vector<double> rates = args.getList("rates", "");
+    CHECK(rates.size() == 3 && rates[2] == 30);
+}
+
+TEST(randomIsReproducible)
+{
+    bench::Random a(42), b(42);
+    for (int i = 0; i < 100; i++) {
+        CHECK(a.next() == b.next());
+        double unit = a.nextUnit();
+        b.nextUnit();
+        CHECK(unit > 0 && unit <= 1);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
@@ -0,0 +1,108 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <memory>
+
+#include "TestUtils.h"
+#include "query_thread/CoalescingQueryQueue.h"
+#include "query_thread/QueryBase.h"
+
+namespace {
+
+struct KeyedQuery : QueryBase<int> {
+    typedef int KeyType;
+    explicit KeyedQuery(int key) : key(key) { }
+    int getKey() const { return key; }
+    int key;
+};
+
+typedef std::shared_ptr<KeyedQuery> KeyedQueryPtr;
+
+KeyedQueryPtr makeQuery(int key)
+{ return std::make_shared<KeyedQuery>(key); }
+
+} // namespace
+
+TEST(followersGetResultOfLeader)
+{
+    CoalescingQueryQueue<KeyedQuery> queue;
+    auto leader = makeQuery(1);
+    auto follower = makeQuery(1);
+    auto other = makeQuery(2);
+    CHECK(queue.pushQuery(leader) == PushStatus::Pushed);
+    CHECK(queue.pushQuery(follower) == PushStatus::Coalesced);
+    CHECK(queue.pushQuery(other) == PushStatus::Pushed);
+    CHECK(queue.getCoalescedCount() == 1);
+    CHECK(queue.size() == 2);
+
+    queue.getQuery()->setResult(7);
+    CHECK(leader->getResult() == 7);
+    CHECK(follower->getResult() == 7);
+    CHECK(!other->isCompleted());
+
+    // Completed leader is forgotten, next query with its key is queued
+    CHECK(queue.pushQuery(makeQuery(1)) == PushStatus::Pushed);
+}
+
+TEST(tryPushQueryCoalescesWhenBounded)
+{
+    CoalescingQueryQueue<KeyedQuery> queue;
+    QueueLimits limits;
+    limits.maxCount = 1;
+    queue.setLimits(limits);
+
+    auto leader = makeQuery(1);
+    auto follower = makeQuery(1);
+    auto other = makeQuery(2);
+    CHECK(queue.tryPushQuery(leader) == PushStatus::Pushed);
+    CHECK(queue.tryPushQuery(follower) == PushStatus::Coalesced);
+    CHECK(queue.tryPushQuery(other) == PushStatus::Rejected);
+    CHECK_THROWS(other->getResult(), QueryOverloadedError);
+
+    // A follower completed elsewhere must not break the leader's completion
+    follower->cancel();
+    queue.getQuery()->setResult(5);
+    CHECK(leader->getResult() == 5);
+}
+
+TEST(removeIfFailsFollowersAndForgetsLeader)
+{
+    CoalescingQueryQueue<KeyedQuery> queue;
+    auto leader = makeQuery(1);
+    auto follower = makeQuery(1);
+    queue.pushQuery(leader);
+    queue.pushQuery(follower);
+
+    queue.removeIf([](const KeyedQueryPtr& query) { return query->key == 1; });
+    CHECK(queue.isEmpty());
+    CHECK(!leader->isCompleted());
+    CHECK_THROWS(follower->getResult(), QueryCancelledError);
+
+    auto next = makeQuery(1);
+    CHECK(queue.pushQuery(next) == PushStatus::Pushed);
+    // Removed leader is detached from the queue, completing it affects nobody else
+    leader->setResult(1);
+    CHECK(!next->isCompleted());
+    queue.getQuery()->setResult(2);
+    CHECK(next->getResult() == 2);
+}
+
+TEST(clearCancelsLeaderAndFollowers)
+{
+    CoalescingQueryQueue<KeyedQuery> queue;
+    auto leader = makeQuery(1);
+    auto follower = makeQuery(1);
+    queue.pushQuery(leader);
+    queue.pushQuery(follower);
+    queue.clear();
+
+    CHECK_THROWS(leader->getResult(), QueryCancelledError);
+    CHECK_THROWS(follower->getResult(), QueryCancelledError);
+    CHECK(queue.pushQuery(makeQuery(1)) == PushStatus::Pushed);
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
@@ -0,0 +1,104 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "TestUtils.h"
+#include "query_thread/QueryBase.h"
+#include "query_thread/QueryQueueBase.h"
+
+namespace {
+
+class IdQuery : public QueryBase<int> {
+public:
+    explicit IdQuery(int id) : id(id) { }
+
+    const int id;
+};
+
+typedef QueryQueueBase<IdQuery> Queue;
+
+CoDelParams params(int targetMs, int intervalMs)
+{
+    CoDelParams params;
+    params.target = std::chrono::milliseconds(targetMs);
+    params.interval = std::chrono::milliseconds(intervalMs);
+    return params;
+}
+
+void sleepMs(int ms)
+{ std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+} // namespace
+
+TEST(burstDrainedWithinIntervalIsNotShed)
+{
+    Queue queue;
+    queue.enableCoDel(params(1, 1000));
+    for (int i = 0; i < 10; i++)
+        queue.emplaceQuery(i);
+    sleepMs(20);
+    for (int i = 0; i < 10; i++)
+        CHECK(queue.getQuery()->id == i);
+    CHECK(queue.getShedCount() == 0);
+}
+
+TEST(standingQueueIsShedAfterInterval)
+{
+    Queue queue;
+    queue.enableCoDel(params(1, 10));
+    std::vector<std::shared_ptr<IdQuery>> stale;
+    for (int i = 0; i < 5; i++) {
+        stale.push_back(std::make_shared<IdQuery>(i));
+        queue.pushQuery(stale.back());
+    }
+    sleepMs(30);
+    // Opens the first interval, whose minimal sojourn is already above target
+    CHECK(queue.getQuery()->id == 0);
+    sleepMs(15);
+
+    queue.emplaceQuery(100);
+    CHECK(queue.getQuery()->id == 100);
+    CHECK(queue.getShedCount() == 4);
+    for (int i = 1; i < 5; i++) {
+        CHECK(!stale[i]->isValid());
+        CHECK_THROWS(stale[i]->getResult(), QueryOverloadedError);
+    }
+    CHECK(queue.isEmpty());
+}
+
+TEST(sheddingStopsWhenQueueDrainsFast)
+{
+    Queue queue;
+    queue.enableCoDel(params(1, 10));
+    queue.emplaceQuery(0);
+    queue.emplaceQuery(1);
+    sleepMs(30);
+    queue.getQuery();
+    sleepMs(15);
+    queue.emplaceQuery(2);
+    // Query 1 is shed, the fresh one is served
+    CHECK(queue.getQuery()->id == 2);
+    CHECK(queue.getShedCount() == 1);
+
+    // Interval with short sojourn clears the overload
+    sleepMs(15);
+    queue.emplaceQuery(3);
+    CHECK(queue.getQuery()->id == 3);
+    sleepMs(15);
+    queue.emplaceQuery(4);
+    queue.emplaceQuery(5);
+    sleepMs(5);
+    CHECK(queue.getQuery()->id == 4);
+    CHECK(queue.getQuery()->id == 5);
+    CHECK(queue.getShedCount() == 1);
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
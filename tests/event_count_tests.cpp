@@ -0,0 +1,97 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "TestUtils.h"
+#include "utils/Condition.h"
+#include "utils/EventCount.h"
+#include "utils/PredicateCondition.h"
+
+TEST(notifyWakesWaiter)
+{
+    EventCount eventCount;
+    std::atomic<bool> ready(false);
+    std::thread waiter([&] { eventCount.wait(WAKE_IF(ready.load())); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ready = true;
+    eventCount.notify_one();
+    waiter.join();
+    CHECK(eventCount.getWaiterCount() == 0);
+}
+
+TEST(wakeupsAreNotLost)
+{
+    EventCount eventCount;
+    std::atomic<int> produced(0);
+    const int count = 10000;
+    std::thread consumer([&] {
+        for (int seen = 1; seen <= count; seen++)
+            eventCount.wait([&] { return produced.load() >= seen; });
+    });
+    for (int i = 0; i < count; i++) {
+        produced++;
+        eventCount.notify_all();
+    }
+    consumer.join();
+    CHECK(eventCount.getWaiterCount() == 0);
+}
+
+TEST(timedOutWaitsUnregister)
+{
+    EventCount eventCount;
+    std::atomic<bool> done(false);
+    // Notifications racing with the deadline exercise both timeout paths
+    std::thread notifier([&] {
+        while (!done) {
+            eventCount.notify_all();
+            std::this_thread::yield();
+        }
+    });
+    for (int i = 0; i < 50; i++)
+        CHECK(!eventCount.wait_for(std::chrono::milliseconds(1), WAKE_IF(false)));
+    done = true;
+    notifier.join();
+    CHECK(eventCount.getWaiterCount() == 0);
+
+    for (int i = 0; i < 5; i++)
+        CHECK(!eventCount.wait_for(std::chrono::milliseconds(0), WAKE_IF(false)));
+    CHECK(eventCount.getWaiterCount() == 0);
+}
+
+TEST(commitWaitForTimesOutWithoutNotification)
+{
+    EventCount eventCount;
+    EventCount::Key key = eventCount.prepareWait();
+    CHECK(eventCount.getWaiterCount() == 1);
+    CHECK(!eventCount.commitWaitFor(key, std::chrono::milliseconds(5)));
+    CHECK(eventCount.getWaiterCount() == 0);
+}
+
+TEST(predicateConditionWaitsForPredicate)
+{
+    int value = 0;
+    auto condition = PredicateCondition<std::function<bool()>>::create([&value] { return value == 1; });
+    CHECK(!condition->wait_for(std::chrono::milliseconds(1)));
+    CHECK(!condition->wait_for(std::chrono::milliseconds(0)));
+    std::thread setter([&] {
+        condition->acquireLock();
+        value = 1;
+        condition->releaseLock();
+        condition->notify_all();
+    });
+    condition->wait();
+    setter.join();
+    CHECK(condition->wait_for(std::chrono::milliseconds(0)));
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
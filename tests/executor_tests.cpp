@@ -0,0 +1,108 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TestUtils.h"
+#include "parallel/Executor.h"
+#include "utils/UniqueFunction.h"
+
+TEST(executorCompletesFutures)
+{
+    Executor executor(2);
+    executor.startThreads();
+    CHECK(executor.submit([](int a, int b) { return a + b; }, 1, 2).get() == 3);
+    auto failing = executor.submit([] { throw std::runtime_error("call failed"); });
+    CHECK_THROWS(failing.get(), std::runtime_error);
+    auto moveOnly = executor.submit([] { return std::unique_ptr<int>(new int(4)); });
+    CHECK(*moveOnly.get() == 4);
+}
+
+TEST(executorReportsOverloadAndCancellation)
+{
+    for (OverflowPolicy policy : {OverflowPolicy::DropNewest, OverflowPolicy::Reject, OverflowPolicy::DropOldest}) {
+        auto queue = std::make_shared<QueryQueueBase<RunnableQuery>>();
+        QueueLimits limits;
+        limits.maxCount = 1;
+        limits.policy = policy;
+        queue->setLimits(limits);
+        Executor executor(1, queue);
+        auto first = executor.submit([] { return 1; });
+        auto second = executor.submit([] { return 2; });
+        auto& dropped = policy == OverflowPolicy::DropOldest ? first : second;
+        CHECK_THROWS(dropped.get(), QueryOverloadedError);
+    }
+
+    ExecutorFuture<void> pending;
+    {
+        Executor executor(1);
+        pending = executor.submit([] { });
+    }
+    CHECK_THROWS(pending.get(), QueryCancelledError);
+}
+
+TEST(postedFunctionsRunOnPoolThreads)
+{
+    Executor executor(3);
+    executor.startThreads();
+    std::atomic<int> sum(0);
+    std::unique_ptr<int> owned(new int(5));
+    CHECK(executor.post([&sum, value = std::move(owned)] { sum += *value; }) == PushStatus::Pushed);
+    for (int i = 0; i < 100; i++)
+        executor.post([&sum] { sum++; });
+    CHECK(test::waitUntil([&] { return sum == 105; }));
+    // A throwing posted function does not take its thread down
+    executor.post([] { throw std::runtime_error("posted"); });
+    CHECK(executor.submit([] { return 7; }).get() == 7);
+}
+
+TEST(futureWaitsWithoutTakingResult)
+{
+    Executor executor(1);
+    executor.startThreads();
+    auto future = executor.submit([](std::string text) { return text + "!"; }, std::string("done"));
+    future.wait();
+    CHECK(future.get() == "done!");
+}
+
+TEST(uniqueFunctionHoldsMoveOnlyCallables)
+{
+    std::unique_ptr<int> value(new int(3));
+    UniqueFunction<int(int)> function([captured = std::move(value)](int x) { return *captured * x; });
+    CHECK(function);
+    CHECK(function.isInline());
+    CHECK(function(4) == 12);
+
+    UniqueFunction<int(int)> moved(std::move(function));
+    CHECK(!function);
+    CHECK(moved(2) == 6);
+    function = std::move(moved);
+    CHECK(function(1) == 3);
+    function = nullptr;
+    CHECK(!function);
+    CHECK_THROWS(function(1), std::bad_function_call);
+}
+
+TEST(uniqueFunctionStoresLargeCallablesOnHeap)
+{
+    std::vector<int> values(10, 1);
+    char padding[256] = {};
+    UniqueFunction<int()> function([values, padding] { return static_cast<int>(values.size()) + padding[0]; });
+    CHECK(!function.isInline());
+    UniqueFunction<int()> moved(std::move(function));
+    CHECK(moved() == 10);
+
+    std::function<int()> empty;
+    CHECK(!UniqueFunction<int()>(empty));
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
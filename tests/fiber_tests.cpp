@@ -0,0 +1,149 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "TestUtils.h"
+#include "fiber/FiberPool.h"
+#include "fiber/FiberQueryHandler.h"
+#include "fiber/FiberSync.h"
+#include "query_thread/QueryBase.h"
+#include "query_thread/QueryQueueBase.h"
+#include "query_thread/QueryWorker.h"
+
+namespace {
+
+struct ValueQuery : QueryBase<int> {
+    explicit ValueQuery(int value) : value(value) { }
+    int value;
+};
+
+typedef std::shared_ptr<ValueQuery> ValueQueryPtr;
+
+/*
+ * Waits for the gate query to be completed, then returns the value plus the gate's result
+ */
+struct GateHandler {
+    explicit GateHandler(ValueQueryPtr gate) : gate(std::move(gate)) { }
+
+    void operator()(ValueQueryPtr query)
+    {
+        if (query->value < 0)
+            throw std::runtime_error("negative value");
+        int offset = fiberGetResult(gate);
+        query->setResult(query->value + offset);
+    }
+
+    ValueQueryPtr gate;
+};
+
+typedef QueryWorker<QueryQueueBase<ValueQuery>, FiberQueryHandler<GateHandler>> FiberWorkerThread;
+
+} // namespace
+
+TEST(spawnedFibersRunToCompletion)
+{
+    FiberPool pool(2);
+    pool.startThreads();
+    std::atomic<int> finished(0);
+    for (int i = 0; i < 1000; i++)
+        pool.spawn([&finished] {
+            FiberScheduler::yield();
+            finished++;
+        });
+    pool.waitForFibers();
+    CHECK(finished == 1000);
+    CHECK(pool.getFiberCount() == 0);
+}
+
+TEST(fiberMutexSerializesFibers)
+{
+    FiberPool pool(2);
+    pool.startThreads();
+    FiberMutex mutex;
+    int counter = 0;
+    for (int i = 0; i < 100; i++)
+        pool.spawn([&] {
+            for (int j = 0; j < 100; j++) {
+                std::lock_guard<FiberMutex> lock(mutex);
+                int value = counter;
+                FiberScheduler::yield();
+                counter = value + 1;
+            }
+        });
+    pool.waitForFibers();
+    CHECK(counter == 10000);
+}
+
+TEST(fiberConditionWakesWaitingFibers)
+{
+    FiberPool pool(1);
+    pool.startThreads();
+    FiberMutex mutex;
+    FiberCondition condition;
+    bool open = false;
+    std::atomic<int> passed(0);
+    for (int i = 0; i < 10; i++)
+        pool.spawn([&] {
+            std::unique_lock<FiberMutex> lock(mutex);
+            condition.wait(lock, [&] { return open; });
+            passed++;
+        });
+    // One thread runs all waiters, so they must be suspended, not blocked
+    pool.spawn([&] {
+        std::lock_guard<FiberMutex> lock(mutex);
+        open = true;
+        condition.notify_all();
+    });
+    pool.waitForFibers();
+    CHECK(passed == 10);
+}
+
+TEST(workerHandlesQueriesInFibers)
+{
+    FiberPool fibers(1);
+    fibers.startThreads();
+    auto gate = std::make_shared<ValueQuery>(0);
+    auto queue = std::make_shared<QueryQueueBase<ValueQuery>>();
+    FiberWorkerThread worker(queue, FiberQueryHandler<GateHandler>(fibers.getScheduler(), GateHandler(gate)));
+    worker.startThread();
+
+    std::vector<ValueQueryPtr> queries;
+    for (int i = 0; i < 50; i++) {
+        queries.push_back(std::make_shared<ValueQuery>(i));
+        worker.putQuery(queries.back());
+    }
+    // All handlers wait for the gate at once on a single fiber thread
+    CHECK(test::waitUntil([&] { return fibers.getFiberCount() == 50; }));
+    CHECK(!queries.front()->isCompleted());
+
+    gate->setResult(100);
+    for (int i = 0; i < 50; i++)
+        CHECK(queries[i]->getResult() == 100 + i);
+    fibers.waitForFibers();
+}
+
+TEST(handlerExceptionCompletesQuery)
+{
+    FiberPool fibers(1);
+    fibers.startThreads();
+    auto gate = std::make_shared<ValueQuery>(0);
+    gate->setResult(0);
+    auto queue = std::make_shared<QueryQueueBase<ValueQuery>>();
+    FiberWorkerThread worker(queue, FiberQueryHandler<GateHandler>(fibers.getScheduler(), GateHandler(gate)));
+    worker.startThread();
+
+    CHECK_THROWS(worker.emplaceQueryAndGetResult(-1), std::runtime_error);
+    CHECK(worker.emplaceQueryAndGetResult(1) == 1);
+    fibers.waitForFibers();
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
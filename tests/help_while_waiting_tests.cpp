@@ -0,0 +1,169 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "TestUtils.h"
+#include "query_thread/QueryBase.h"
+#include "query_thread/QueryQueueBase.h"
+#include "query_thread/QueryThreadPool.h"
+#include "query_thread/QueryThreadPoolThread.h"
+#include "query_thread/QueryThreadSimple.h"
+
+namespace {
+
+struct ValueQuery : QueryBase<int> {
+    explicit ValueQuery(int value) : value(value) { }
+    int value;
+};
+
+typedef std::shared_ptr<ValueQuery> ValueQueryPtr;
+
+class NestingThread : public QueryThreadSimple<ValueQuery> {
+public:
+    ~NestingThread()
+    {
+        stopThread();
+        joinThread();
+    }
+
+    ValueQueryPtr awaited = std::make_shared<ValueQuery>(0);
+    std::vector<int> order;
+    int depth = 0;
+    int maxDepth = 0;
+
+protected:
+    void onQuery(ValueQueryPtr query) override
+    {
+        maxDepth = std::max(maxDepth, ++depth);
+        if (query->value == 1)
+            awaited->waitForResult(std::chrono::milliseconds(100));
+        order.push_back(query->value);
+        depth--;
+        query->setResult(query->value);
+    }
+};
+
+/*
+ * Query 1 waits for inner() and query 2 waits for never() with a deadline,
+ * others record their value and return it
+ */
+class WaitingPoolThread : public QueryThreadPoolThread<ValueQuery> {
+public:
+    using QueryThreadPoolThread<ValueQuery>::QueryThreadPoolThread;
+
+    ~WaitingPoolThread()
+    {
+        stopThread();
+        joinThread();
+    }
+
+    static ValueQueryPtr& inner()
+    {
+        static ValueQueryPtr query;
+        return query;
+    }
+
+    static ValueQueryPtr& never()
+    {
+        static ValueQueryPtr query;
+        return query;
+    }
+
+    static std::vector<int>& order()
+    {
+        static std::vector<int> values;
+        return values;
+    }
+
+protected:
+    void onQuery(ValueQueryPtr query) override
+    {
+        if (query->value == 1) {
+            // The inner query is queued behind this one on the only thread
+            query->setResult(inner()->getResult() + 1);
+            return;
+        }
+        if (query->value == 2) {
+            bool completed = never()->waitForResult(std::chrono::milliseconds(50));
+            order().push_back(query->value);
+            query->setResult(completed ? 1 : 0);
+            return;
+        }
+        order().push_back(query->value);
+        query->setResult(query->value);
+    }
+};
+
+typedef QueryThreadPool<WaitingPoolThread> WaitingPool;
+
+} // namespace
+
+TEST(serialThreadIsNotReentered)
+{
+    NestingThread thread;
+    thread.startThread();
+    auto first = std::make_shared<ValueQuery>(1);
+    auto second = std::make_shared<ValueQuery>(2);
+    thread.putQuery(first);
+    thread.putQuery(second);
+    CHECK(second->getResult() == 2);
+    CHECK(first->getResult() == 1);
+    CHECK(thread.order.size() == 2 && thread.order[0] == 1);
+    CHECK(thread.maxDepth == 1);
+}
+
+TEST(poolThreadHelpsWhileWaiting)
+{
+    WaitingPool pool(1, std::make_shared<QueryQueueBase<ValueQuery>>());
+    WaitingPoolThread::inner() = std::make_shared<ValueQuery>(10);
+    auto outer = std::make_shared<ValueQuery>(1);
+    pool.putQuery(outer);
+    pool.putQuery(WaitingPoolThread::inner());
+    pool.startThreads();
+    CHECK(outer->getResult() == 11);
+    pool.stopThreads();
+    pool.joinThreads();
+    WaitingPoolThread::inner().reset();
+}
+
+TEST(helpingWaitStopsAtDeadline)
+{
+    WaitingPool pool(1, std::make_shared<QueryQueueBase<ValueQuery>>());
+    WaitingPoolThread::never() = std::make_shared<ValueQuery>(0);
+    WaitingPoolThread::order().clear();
+    auto waiting = std::make_shared<ValueQuery>(2);
+    auto queued = std::make_shared<ValueQuery>(5);
+    pool.putQuery(waiting);
+    pool.putQuery(queued);
+    pool.startThreads();
+
+    // The queued query runs inside the wait, the wait still times out
+    CHECK(waiting->getResult() == 0);
+    CHECK(queued->getResult() == 5);
+    std::vector<int>& order = WaitingPoolThread::order();
+    CHECK(order.size() == 2 && order[0] == 5 && order[1] == 2);
+    CHECK(!WaitingPoolThread::never()->isCompleted());
+    pool.stopThreads();
+    pool.joinThreads();
+    WaitingPoolThread::never().reset();
+}
+
+TEST(waitOutsideWorkersBlocksPlainly)
+{
+    CHECK(WorkerContext::current() == nullptr);
+    auto query = std::make_shared<ValueQuery>(0);
+    CHECK(!query->waitForResult(std::chrono::milliseconds(10)));
+    query->setResult(3);
+    CHECK(query->waitForResult(std::chrono::milliseconds(10)));
+    CHECK(query->getResult() == 3);
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
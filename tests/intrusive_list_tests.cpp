@@ -0,0 +1,158 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "TestUtils.h"
+#include "query_thread/IntrusiveQueryList.h"
+#include "query_thread/QueryBase.h"
+#include "query_thread/QueryQueueBase.h"
+#include "query_thread/QueryThreadPool.h"
+#include "query_thread/QueryThreadPoolThread.h"
+#include "query_thread/QueryThreadSimple.h"
+#include "utils/LockPolicy.h"
+
+namespace {
+
+struct ValueQuery : QueryBase<int> {
+    explicit ValueQuery(int value) : value(value) { }
+    int value;
+};
+
+struct LinkedQuery : QueryBase<int>, IntrusiveQueryHookBase {
+    explicit LinkedQuery(int value) : value(value) { }
+    int value;
+};
+
+typedef std::shared_ptr<LinkedQuery> LinkedQueryPtr;
+typedef IntrusiveQueryList<LinkedQuery> List;
+typedef QueryQueueBase<LinkedQuery, IntrusiveQueryList<LinkedQuery, SpinMutex>> LinkedQueue;
+
+class IncrementingThread : public QueryThreadSimple<LinkedQuery, LinkedQueue> {
+public:
+    ~IncrementingThread()
+    {
+        stopThread();
+        joinThread();
+    }
+
+protected:
+    void onQuery(LinkedQueryPtr query) override
+    { query->setResult(query->value + 1); }
+};
+
+class IncrementingPoolThread : public QueryThreadPoolThread<LinkedQuery, LinkedQueue> {
+public:
+    using QueryThreadPoolThread<LinkedQuery, LinkedQueue>::QueryThreadPoolThread;
+
+    ~IncrementingPoolThread()
+    {
+        stopThread();
+        joinThread();
+    }
+
+protected:
+    void onQuery(LinkedQueryPtr query) override
+    { query->setResult(query->value + 1); }
+};
+
+} // namespace
+
+TEST(onlyLinkedQueriesPayForHook)
+{
+    CHECK(sizeof(LinkedQuery) >= sizeof(ValueQuery) + sizeof(IntrusiveQueryHook));
+}
+
+TEST(listKeepsFifoOrderAndOwnership)
+{
+    List list;
+    std::vector<LinkedQueryPtr> queries;
+    for (int i = 0; i < 5; i++) {
+        queries.push_back(std::make_shared<LinkedQuery>(i));
+        list.pushBack(queries.back());
+    }
+    CHECK(list.size() == 5);
+    // The list holds one reference of every query, in the hook
+    CHECK(queries[0].use_count() == 2);
+    CHECK(list.front()->value == 0);
+    for (int i = 0; i < 5; i++) {
+        LinkedQueryPtr query = list.getFront();
+        CHECK(query == queries[i]);
+        CHECK(!query->getQueueHook().linked);
+    }
+    CHECK(list.empty());
+    CHECK(queries[0].use_count() == 1);
+    CHECK_THROWS(list.getFront(), std::runtime_error);
+}
+
+TEST(queuedQueryCannotBePushedTwice)
+{
+    List first;
+    List second;
+    auto query = std::make_shared<LinkedQuery>(1);
+    first.pushBack(query);
+    CHECK_THROWS(second.pushBack(query), std::logic_error);
+    CHECK(second.empty());
+    first.getFront();
+    second.pushBack(query);
+    CHECK(second.size() == 1);
+}
+
+TEST(removeIfRelinksAndReleases)
+{
+    List list;
+    std::vector<LinkedQueryPtr> queries;
+    for (int i = 0; i < 6; i++) {
+        queries.push_back(std::make_shared<LinkedQuery>(i));
+        list.pushBack(queries.back());
+    }
+    list.removeIf([](const LinkedQueryPtr& query) { return query->value % 2 == 0 || query->value == 5; });
+    CHECK(list.size() == 2);
+    CHECK(queries[0].use_count() == 1);
+    CHECK(list.getFront()->value == 1);
+    // The tail was removed, so pushing must link after the new tail
+    list.pushBack(std::make_shared<LinkedQuery>(7));
+    CHECK(list.getFront()->value == 3);
+    CHECK(list.getFront()->value == 7);
+    CHECK(list.empty());
+}
+
+TEST(clearAndDestructionReleaseQueries)
+{
+    auto query = std::make_shared<LinkedQuery>(1);
+    {
+        List list;
+        list.pushBack(query);
+        list.pushBack(std::make_shared<LinkedQuery>(2));
+    }
+    CHECK(query.use_count() == 1);
+    CHECK(!query->getQueueHook().linked);
+}
+
+TEST(threadsRunOnIntrusiveQueue)
+{
+    IncrementingThread thread;
+    thread.startThread();
+    std::vector<LinkedQueryPtr> queries;
+    for (int i = 0; i < 100; i++) {
+        queries.push_back(std::make_shared<LinkedQuery>(i));
+        thread.putQuery(queries.back());
+    }
+    for (int i = 0; i < 100; i++)
+        CHECK(queries[i]->getResult() == i + 1);
+
+    QueryThreadPool<IncrementingPoolThread> pool(2, std::make_shared<LinkedQueue>());
+    pool.startThreads();
+    for (int i = 0; i < 100; i++)
+        CHECK(pool.emplaceQueryAndGetResult(i) == i + 1);
+    pool.stopThreads();
+    pool.joinThreads();
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
@@ -0,0 +1,186 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "TestUtils.h"
+#include "io/AsyncIoService.h"
+
+namespace {
+
+/*
+ * Temporary file removed on destruction
+ */
+class TempFile {
+public:
+    TempFile()
+    {
+        char path[] = "/tmp/threading_io_testXXXXXX";
+        fd = ::mkstemp(path);
+        if (fd < 0)
+            throw std::system_error(errno, std::system_category(), "mkstemp");
+        ::unlink(path);
+    }
+
+    ~TempFile()
+    { ::close(fd); }
+
+    int fd;
+};
+
+typedef QueryThreadPool<BlockingIoWorker> BlockingPool;
+
+/*
+ * Writes blocks with distinct contents at distinct offsets and reads them back
+ */
+template<typename _Executor>
+void checkRoundTrip(_Executor& executor, int fd, int blocks)
+{
+    const size_t blockSize = 512;
+    std::vector<std::string> written;
+    std::vector<std::shared_ptr<IoQuery>> writes;
+    for (int i = 0; i < blocks; i++) {
+        written.push_back(std::string(blockSize, static_cast<char>('a' + i % 26)));
+        auto query = std::make_shared<IoQuery>(IoOp::Write, fd, &written.back()[0], blockSize,
+                                               static_cast<off_t>(i * blockSize));
+        writes.push_back(query);
+    }
+    for (auto& query : writes)
+        CHECK(executor.putQuery(query) == PushStatus::Pushed);
+    for (auto& query : writes)
+        CHECK(query->getResult() == static_cast<ssize_t>(blockSize));
+    CHECK(executor.emplaceQueryAndGetResult(IoOp::Fdatasync, fd) == 0);
+
+    std::vector<std::string> read(blocks, std::string(blockSize, '\0'));
+    std::vector<std::shared_ptr<IoQuery>> reads;
+    for (int i = 0; i < blocks; i++) {
+        auto query = std::make_shared<IoQuery>(IoOp::Read, fd, &read[i][0], blockSize,
+                                               static_cast<off_t>(i * blockSize));
+        reads.push_back(query);
+        CHECK(executor.putQuery(query) == PushStatus::Pushed);
+    }
+    for (int i = 0; i < blocks; i++) {
+        CHECK(reads[i]->getResult() == static_cast<ssize_t>(blockSize));
+        CHECK(read[i] == written[i]);
+    }
+}
+
+int errorOf(const std::shared_ptr<IoQuery>& query)
+{
+    try {
+        query->getResult();
+    } catch (const std::system_error& e) {
+        return e.code().value();
+    }
+    return 0;
+}
+
+} // namespace
+
+TEST(performBlockingReturnsMinusErrno)
+{
+    char buffer[16];
+    IoQuery badFd(IoOp::Read, -1, buffer, sizeof(buffer));
+    CHECK(badFd.performBlocking() == -EBADF);
+
+    TempFile file;
+    IoQuery sync(IoOp::Fsync, file.fd);
+    CHECK(sync.performBlocking() == 0);
+}
+
+TEST(blockingPoolRoundTrip)
+{
+    TempFile file;
+    BlockingPool pool(2, std::make_shared<QueryQueueBase<IoQuery>>());
+    pool.startThreads();
+    checkRoundTrip(pool, file.fd, 20);
+    pool.stopThreads();
+    pool.joinThreads();
+}
+
+TEST(serviceRoundTripInEitherMode)
+{
+    TempFile file;
+    AsyncIoService service(8, 2);
+    std::cout << "  io_uring " << (service.usesIoUring() ? "is used" : "is unavailable, blocking pool is used")
+              << std::endl;
+    service.startThreads();
+    // More queries than submission entries
+    checkRoundTrip(service, file.fd, 40);
+}
+
+TEST(serviceReportsSyscallErrors)
+{
+    AsyncIoService service(8, 2);
+    service.startThreads();
+    char buffer[16];
+    auto query = service.emplaceQuery(IoOp::Read, -1, buffer, sizeof(buffer));
+    CHECK(errorOf(query) == EBADF);
+}
+
+#ifdef THREADING_HAS_IO_URING
+
+TEST(ringUsesRegisteredBuffers)
+{
+    std::unique_ptr<QueryThreadIoUring> ring;
+    try {
+        ring.reset(new QueryThreadIoUring(4));
+    } catch (const std::system_error& e) {
+        std::cout << "  io_uring is unavailable: " << e.what() << std::endl;
+        return;
+    }
+    CHECK(ring->getMaxInFlight() > 0);
+
+    TempFile file;
+    std::vector<char> buffer(4096, 'x');
+    std::vector<iovec> buffers(1);
+    buffers[0].iov_base = buffer.data();
+    buffers[0].iov_len = buffer.size();
+    try {
+        ring->registerBuffers(buffers);
+    } catch (const std::system_error& e) {
+        // Pinning memory may be limited by RLIMIT_MEMLOCK
+        std::cout << "  buffers are not registered: " << e.what() << std::endl;
+        return;
+    }
+    ring->startThread();
+    CHECK(ring->emplaceQueryAndGetResult(IoOp::Write, file.fd, buffer.data(), buffer.size(), 0, 0) == 4096);
+    std::fill(buffer.begin(), buffer.end(), '\0');
+    CHECK(ring->emplaceQueryAndGetResult(IoOp::Read, file.fd, buffer.data() + 100, 100, 100, 0) == 100);
+    CHECK(buffer[100] == 'x' && buffer[199] == 'x' && buffer[200] == '\0');
+}
+
+TEST(ringCancelsQueuedQueriesWhenDestroyed)
+{
+    std::unique_ptr<QueryThreadIoUring> ring;
+    try {
+        ring.reset(new QueryThreadIoUring(4));
+    } catch (const std::system_error& e) {
+        std::cout << "  io_uring is unavailable: " << e.what() << std::endl;
+        return;
+    }
+    TempFile file;
+    auto query = std::make_shared<IoQuery>(IoOp::Fsync, file.fd);
+    ring->putQuery(query);
+    ring.reset();
+    CHECK_THROWS(query->getResult(), QueryCancelledError);
+}
+
+#endif //THREADING_HAS_IO_URING
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
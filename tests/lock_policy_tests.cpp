@@ -0,0 +1,187 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "TestUtils.h"
+#include "ThreadSafeBase.h"
+#include "utils/GuardedDeque.h"
+#include "utils/GuardedMap.h"
+#include "utils/LockPolicy.h"
+
+namespace {
+
+template<typename _Lock>
+class Counter : public ThreadSafeBaseT<_Lock> {
+public:
+    void increment()
+    {
+        this->acquireLock();
+        // Read and write apart, so a broken lock loses increments
+        long current = value;
+        std::this_thread::yield();
+        value = current + 1;
+        this->releaseLock();
+    }
+
+    long get()
+    {
+        this->acquireSharedLock();
+        long current = value;
+        this->releaseSharedLock();
+        return current;
+    }
+
+private:
+    long value = 0;
+};
+
+template<typename _Lock>
+long countConcurrently(int threads, int perThread)
+{
+    Counter<_Lock> counter;
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++)
+        workers.emplace_back([&] {
+            for (int j = 0; j < perThread; j++)
+                counter.increment();
+        });
+    for (auto& worker : workers)
+        worker.join();
+    return counter.get();
+}
+
+template<typename _Lock>
+void checkTryLock()
+{
+    _Lock lock;
+    CHECK(lock.try_lock());
+    bool otherGotIt = true;
+    std::thread([&] { otherGotIt = lock.try_lock(); }).join();
+    CHECK(!otherGotIt);
+    lock.unlock();
+    std::thread([&] { otherGotIt = lock.try_lock(); }).join();
+    CHECK(otherGotIt);
+    lock.unlock();
+}
+
+} // namespace
+
+TEST(locksAreMutuallyExclusive)
+{
+    CHECK(countConcurrently<std::mutex>(4, 2000) == 8000);
+    CHECK(countConcurrently<SpinMutex>(4, 2000) == 8000);
+    CHECK(countConcurrently<TicketLock>(4, 2000) == 8000);
+    CHECK(countConcurrently<SharedMutex>(4, 2000) == 8000);
+}
+
+TEST(tryLockFailsWhileHeld)
+{
+    checkTryLock<SpinMutex>();
+    checkTryLock<TicketLock>();
+}
+
+TEST(spinBudgetShrinksWhenOwnerIsSlow)
+{
+    SpinMutex mutex;
+    CHECK(mutex.getSpinBudget() == SpinMutex::maxSpins);
+    // Uncontended locking does not touch the budget
+    for (int i = 0; i < 10; i++) {
+        mutex.lock();
+        mutex.unlock();
+    }
+    CHECK(mutex.getSpinBudget() == SpinMutex::maxSpins);
+
+    for (int round = 0; round < 10; round++) {
+        std::atomic<bool> held(false);
+        std::thread owner([&] {
+            mutex.lock();
+            held = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            mutex.unlock();
+        });
+        while (!held)
+            std::this_thread::yield();
+        mutex.lock();
+        mutex.unlock();
+        owner.join();
+    }
+    CHECK(mutex.getSpinBudget() == SpinMutex::minSpins);
+}
+
+TEST(ticketLockServesWaitersInOrder)
+{
+    TicketLock lock;
+    std::mutex orderMutex;
+    std::vector<int> order;
+    std::atomic<int> started(0);
+    lock.lock();
+    std::vector<std::thread> waiters;
+    for (int i = 0; i < 3; i++) {
+        waiters.emplace_back([&, i] {
+            started++;
+            lock.lock();
+            {
+                std::lock_guard<std::mutex> guard(orderMutex);
+                order.push_back(i);
+            }
+            lock.unlock();
+        });
+        // Let the waiter take its ticket before the next one starts
+        while (started != i + 1)
+            std::this_thread::yield();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    lock.unlock();
+    for (auto& waiter : waiters)
+        waiter.join();
+    CHECK(order.size() == 3 && order[0] == 0 && order[1] == 1 && order[2] == 2);
+}
+
+TEST(sharedLockAdmitsReadersTogether)
+{
+    CHECK(LockTraits<SharedMutex>::isShared);
+    CHECK(!LockTraits<SpinMutex>::isShared);
+
+    SharedMutex mutex;
+    SharedLockGuard<SharedMutex> reader(mutex);
+    bool otherReader = false;
+    bool writer = true;
+    std::thread([&] {
+        otherReader = mutex.try_lock_shared();
+        if (otherReader)
+            mutex.unlock_shared();
+        writer = mutex.try_lock();
+    }).join();
+    CHECK(otherReader);
+    CHECK(!writer);
+}
+
+TEST(guardedContainersWorkWithEveryLock)
+{
+    GuardedDeque<int, SpinMutex> deque;
+    deque.pushBack(1);
+    deque.pushBack(2);
+    CHECK(deque.size() == 2);
+    CHECK(deque.getFront() == 1);
+
+    GuardedDeque<int, SharedMutex> shared;
+    shared.pushFront(3);
+    CHECK(!shared.empty() && shared.getBack() == 3);
+
+    GuardedMap<int, int, TicketLock> map;
+    map.set(1, 10);
+    CHECK(map.get(1) && *map.get(1) == 10);
+    CHECK(!map.get(2));
+    CHECK(map.size() == 1);
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
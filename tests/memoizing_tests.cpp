@@ -0,0 +1,155 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "TestUtils.h"
+#include "query_thread/MemoizingQueryFront.h"
+#include "query_thread/QueryBase.h"
+#include "query_thread/QueryThreadSimple.h"
+#include "utils/ConcurrentLruCache.h"
+
+namespace {
+
+struct KeyedQuery : QueryBase<int> {
+    typedef int KeyType;
+    explicit KeyedQuery(int key) : key(key) { }
+    int getKey() const { return key; }
+    int key;
+};
+
+/*
+ * Returns the key, fails negative keys
+ */
+class KeyThread : public QueryThreadSimple<KeyedQuery> {
+public:
+    ~KeyThread()
+    {
+        stopThread();
+        joinThread();
+    }
+
+    std::atomic<int> calls{0};
+
+protected:
+    void onQuery(std::shared_ptr<KeyedQuery> query) override
+    {
+        calls++;
+        if (query->key < 0)
+            query->setException(std::make_exception_ptr(std::runtime_error("negative key")));
+        else
+            query->setResult(query->key);
+    }
+};
+
+typedef ConcurrentLruCache<int, std::string> Cache;
+
+} // namespace
+
+TEST(cacheEvictsLeastRecentlyUsed)
+{
+    Cache cache(2, std::chrono::milliseconds(0), 1);
+    cache.put(1, "one");
+    cache.put(2, "two");
+    std::string value;
+    CHECK(cache.get(1, value) && value == "one");
+    cache.put(3, "three");
+
+    CHECK(!cache.get(2, value));
+    CHECK(cache.get(1, value) && value == "one");
+    CHECK(cache.get(3, value) && value == "three");
+    CHECK(cache.size() == 2);
+    CHECK(cache.getStats().evictions == 1);
+}
+
+TEST(cacheNeverHoldsMoreThanCapacity)
+{
+    const size_t capacities[] = {1, 5, 16, 17, 31, 100};
+    for (size_t capacity : capacities) {
+        Cache cache(capacity, std::chrono::milliseconds(0), 16);
+        for (int key = 0; key < 2000; key++)
+            cache.put(key, "value");
+        CHECK(cache.size() <= capacity);
+    }
+}
+
+TEST(cacheWithCapacityZeroStoresNothing)
+{
+    Cache cache(0);
+    cache.put(1, "one");
+    std::string value;
+    CHECK(!cache.get(1, value));
+    CHECK(cache.size() == 0);
+}
+
+TEST(expiredEntriesAreMisses)
+{
+    Cache cache(4, std::chrono::milliseconds(10));
+    cache.put(1, "one");
+    std::string value;
+    CHECK(cache.get(1, value));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(!cache.get(1, value));
+    CHECK(cache.size() == 0);
+    CHECK(cache.getStats().expirations == 1);
+}
+
+TEST(memoizingFrontProcessesMissesOnly)
+{
+    KeyThread thread;
+    thread.startThread();
+    MemoizingQueryFront<KeyThread> front(thread, 8);
+    for (int i = 0; i < 3; i++) {
+        CHECK(front.emplaceQueryAndGetResult(1) == 1);
+        CHECK(front.emplaceQueryAndGetResult(2) == 2);
+    }
+    CHECK(thread.calls == 2);
+    CHECK(front.getStats().hits == 4);
+
+    auto hit = std::make_shared<KeyedQuery>(1);
+    CHECK(front.putQueryAndGetResult(hit) == 1);
+    CHECK(hit->getResultRef() == 1);
+
+    front.invalidate(1);
+    CHECK(front.emplaceQueryAndGetResult(1) == 1);
+    CHECK(thread.calls == 3);
+}
+
+TEST(memoizingFrontDoesNotCacheExceptions)
+{
+    KeyThread thread;
+    thread.startThread();
+    MemoizingQueryFront<KeyThread> front(thread, 8);
+    CHECK_THROWS(front.emplaceQueryAndGetResult(-1), std::runtime_error);
+    CHECK_THROWS(front.emplaceQueryAndGetResult(-1), std::runtime_error);
+    CHECK(thread.calls == 2);
+    CHECK(front.getCachedCount() == 0);
+}
+
+TEST(memoizingFrontWithCapacityZeroDoesNotCache)
+{
+    KeyThread thread;
+    thread.startThread();
+    MemoizingQueryFront<KeyThread> uncached(thread, 0);
+    for (int i = 0; i < 3; i++)
+        CHECK(uncached.emplaceQueryAndGetResult(4) == 4);
+    CHECK(thread.calls == 3);
+    CHECK(uncached.getCachedCount() == 0);
+
+    MemoizingQueryFront<KeyThread> cached(thread, 1);
+    for (int i = 0; i < 3; i++)
+        CHECK(cached.emplaceQueryAndGetResult(4) == 4);
+    CHECK(thread.calls == 4);
+    CHECK(cached.getCachedCount() == 1);
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
@@ -0,0 +1,160 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "TestUtils.h"
+#include "query_thread/QueryBase.h"
+#include "query_thread/QueryThreadMultiplexer.h"
+#include "query_thread/SharedQueryThread.h"
+
+namespace {
+
+struct ValueQuery : QueryBase<int> {
+    explicit ValueQuery(int value) : value(value) { }
+    int value;
+};
+
+typedef std::shared_ptr<ValueQuery> ValueQueryPtr;
+
+/*
+ * Order in which queries of all logical threads were processed
+ */
+struct Journal {
+    std::mutex mutex;
+    std::vector<int> order;
+};
+
+/*
+ * Records processed values, checks it is never run by two workers at once
+ */
+class RecordingThread : public SharedQueryThread<ValueQuery> {
+public:
+    RecordingThread(QueryThreadMultiplexer& multiplexer, std::shared_ptr<Journal> journal,
+                    std::chrono::milliseconds timeout = std::chrono::milliseconds(0))
+            : SharedQueryThread<ValueQuery>(multiplexer, timeout), journal(std::move(journal)) { }
+
+    std::vector<int> values;
+    std::atomic<bool> overlapped{false};
+    std::atomic<int> timeouts{0};
+
+protected:
+    void onQuery(ValueQueryPtr query) override
+    {
+        if (running.exchange(true))
+            overlapped = true;
+        values.push_back(query->value);
+        if (journal) {
+            std::lock_guard<std::mutex> lock(journal->mutex);
+            journal->order.push_back(query->value);
+        }
+        running = false;
+        query->setResult(query->value);
+    }
+
+    void onTimeout() override
+    { timeouts++; }
+
+private:
+    std::shared_ptr<Journal> journal;
+    std::atomic<bool> running{false};
+};
+
+} // namespace
+
+TEST(manyLogicalThreadsShareFewWorkers)
+{
+    QueryThreadMultiplexer multiplexer(2, 4);
+    multiplexer.startThreads();
+    std::vector<std::unique_ptr<RecordingThread>> threads;
+    for (int i = 0; i < 100; i++) {
+        threads.emplace_back(new RecordingThread(multiplexer, nullptr));
+        threads.back()->startThread();
+    }
+
+    const int perThread = 50;
+    std::vector<ValueQueryPtr> queries;
+    for (int i = 0; i < perThread; i++)
+        for (auto& thread : threads) {
+            queries.push_back(std::make_shared<ValueQuery>(i));
+            thread->putQuery(queries.back());
+        }
+    for (auto& query : queries)
+        query->waitForResult();
+
+    for (auto& thread : threads) {
+        CHECK(!thread->overlapped);
+        CHECK(thread->values.size() == static_cast<size_t>(perThread));
+        for (int i = 0; i < perThread; i++)
+            CHECK(thread->values[i] == i);
+    }
+    threads.clear();
+}
+
+TEST(runLengthYieldsWorkerToOtherThreads)
+{
+    QueryThreadMultiplexer multiplexer(1, 2);
+    multiplexer.startThreads();
+    auto journal = std::make_shared<Journal>();
+    RecordingThread busy(multiplexer, journal);
+    RecordingThread other(multiplexer, journal);
+
+    std::vector<ValueQueryPtr> queries;
+    for (int i = 0; i < 100; i++) {
+        queries.push_back(std::make_shared<ValueQuery>(i));
+        busy.putQuery(queries.back());
+    }
+    auto single = std::make_shared<ValueQuery>(-1);
+    other.putQuery(single);
+    busy.startThread();
+    other.startThread();
+
+    CHECK(single->getResult() == -1);
+    queries.back()->waitForResult();
+    std::lock_guard<std::mutex> lock(journal->mutex);
+    CHECK(journal->order.size() == 101);
+    // The busy thread gave up the only worker after its run length
+    for (size_t i = 0; i < journal->order.size(); i++)
+        if (journal->order[i] == -1)
+            CHECK(i < 10);
+}
+
+TEST(idleThreadTimesOut)
+{
+    QueryThreadMultiplexer multiplexer(1);
+    multiplexer.startThreads();
+    RecordingThread thread(multiplexer, nullptr, std::chrono::milliseconds(5));
+    thread.startThread();
+    CHECK(test::waitUntil([&] { return thread.timeouts >= 3; }));
+    CHECK(thread.emplaceQueryAndGetResult(4) == 4);
+
+    // Stopped thread gets no more timeouts
+    thread.stopThread();
+    thread.joinThread();
+    int timeouts = thread.timeouts;
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    CHECK(thread.timeouts == timeouts);
+}
+
+TEST(joinCancelsQueuedQueries)
+{
+    QueryThreadMultiplexer multiplexer(1);
+    multiplexer.startThreads();
+    auto queued = std::make_shared<ValueQuery>(1);
+    {
+        RecordingThread thread(multiplexer, nullptr);
+        thread.putQuery(queued);
+    }
+    CHECK_THROWS(queued->getResult(), QueryCancelledError);
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
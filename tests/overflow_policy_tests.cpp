@@ -0,0 +1,192 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "TestUtils.h"
+#include "query_thread/QueryBase.h"
+#include "query_thread/QueryQueueBase.h"
+
+namespace {
+
+class SizedQuery : public QueryBase<int> {
+public:
+    explicit SizedQuery(int id, size_t bytes = 0) : id(id), bytes(bytes) { }
+
+    const int id;
+    const size_t bytes;
+};
+
+typedef QueryQueueBase<SizedQuery> Queue;
+
+std::shared_ptr<SizedQuery> makeQuery(int id, size_t bytes = 0)
+{ return std::make_shared<SizedQuery>(id, bytes); }
+
+QueueLimits countLimit(size_t maxCount, OverflowPolicy policy,
+                       std::chrono::milliseconds timeout = std::chrono::milliseconds(0))
+{
+    QueueLimits limits;
+    limits.maxCount = maxCount;
+    limits.policy = policy;
+    limits.timeout = timeout;
+    return limits;
+}
+
+} // namespace
+
+TEST(rejectLeavesQueryUntouched)
+{
+    Queue queue;
+    queue.setLimits(countLimit(2, OverflowPolicy::Reject));
+    CHECK(queue.pushQuery(makeQuery(1)) == PushStatus::Pushed);
+    CHECK(queue.pushQuery(makeQuery(2)) == PushStatus::Pushed);
+
+    auto rejected = makeQuery(3);
+    CHECK(queue.pushQuery(rejected) == PushStatus::Rejected);
+    CHECK(!rejected->isCompleted());
+    CHECK(queue.size() == 2);
+
+    CHECK(queue.getQuery()->id == 1);
+    CHECK(queue.pushQuery(rejected) == PushStatus::Pushed);
+    CHECK(queue.getQuery()->id == 2);
+    CHECK(queue.getQuery()->id == 3);
+}
+
+TEST(dropNewestCompletesPushedQuery)
+{
+    Queue queue;
+    queue.setLimits(countLimit(1, OverflowPolicy::DropNewest));
+    auto queued = makeQuery(1);
+    auto dropped = makeQuery(2);
+    CHECK(queue.pushQuery(queued) == PushStatus::Pushed);
+    CHECK(queue.pushQuery(dropped) == PushStatus::DroppedNewest);
+
+    CHECK(!queued->isCompleted());
+    CHECK(dropped->isCompleted());
+    CHECK_THROWS(dropped->getResult(), QueryOverloadedError);
+    CHECK(queue.size() == 1);
+    CHECK(queue.getQuery()->id == 1);
+}
+
+TEST(dropOldestCompletesQueriesAtTheHead)
+{
+    Queue queue;
+    queue.setLimits(countLimit(2, OverflowPolicy::DropOldest));
+    auto first = makeQuery(1);
+    auto second = makeQuery(2);
+    CHECK(queue.pushQuery(first) == PushStatus::Pushed);
+    CHECK(queue.pushQuery(second) == PushStatus::Pushed);
+    CHECK(queue.pushQuery(makeQuery(3)) == PushStatus::DroppedOldest);
+
+    CHECK_THROWS(first->getResult(), QueryOverloadedError);
+    CHECK(!first->isValid());
+    CHECK(!second->isCompleted());
+    CHECK(queue.size() == 2);
+    CHECK(queue.getQuery()->id == 2);
+    CHECK(queue.getQuery()->id == 3);
+}
+
+TEST(blockWaitsForRoom)
+{
+    Queue queue;
+    queue.setLimits(countLimit(1, OverflowPolicy::Block));
+    CHECK(queue.pushQuery(makeQuery(1)) == PushStatus::Pushed);
+
+    std::atomic<bool> returned(false);
+    PushStatus status = PushStatus::Rejected;
+    std::thread producer([&] {
+        status = queue.pushQuery(makeQuery(2));
+        returned = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(!returned);
+
+    CHECK(queue.getQuery()->id == 1);
+    producer.join();
+    CHECK(status == PushStatus::Pushed);
+    CHECK(queue.getQuery()->id == 2);
+}
+
+TEST(blockWithTimeoutGivesUpAfterTimeout)
+{
+    const std::chrono::milliseconds timeout(30);
+    Queue queue;
+    queue.setLimits(countLimit(1, OverflowPolicy::BlockWithTimeout, timeout));
+    CHECK(queue.pushQuery(makeQuery(1)) == PushStatus::Pushed);
+
+    auto late = makeQuery(2);
+    auto start = std::chrono::steady_clock::now();
+    CHECK(queue.pushQuery(late) == PushStatus::TimedOut);
+    CHECK(std::chrono::steady_clock::now() - start >= timeout);
+    CHECK(!late->isCompleted());
+    CHECK(queue.size() == 1);
+}
+
+TEST(blockWithTimeoutPushesWhenRoomAppears)
+{
+    Queue queue;
+    queue.setLimits(countLimit(1, OverflowPolicy::BlockWithTimeout, std::chrono::milliseconds(5000)));
+    CHECK(queue.pushQuery(makeQuery(1)) == PushStatus::Pushed);
+
+    std::thread consumer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.getQuery();
+    });
+    CHECK(queue.pushQuery(makeQuery(2)) == PushStatus::Pushed);
+    consumer.join();
+    CHECK(queue.getQuery()->id == 2);
+}
+
+TEST(tryPushQueryRejectsInsteadOfBlocking)
+{
+    Queue queue;
+    queue.setLimits(countLimit(1, OverflowPolicy::Block));
+    CHECK(queue.tryPushQuery(makeQuery(1)) == PushStatus::Pushed);
+    CHECK(queue.tryPushQuery(makeQuery(2)) == PushStatus::Rejected);
+    CHECK(queue.size() == 1);
+}
+
+TEST(byteLimitAcceptsOversizedQueryIntoEmptyQueue)
+{
+    Queue queue;
+    QueueLimits limits;
+    limits.maxBytes = 100;
+    limits.policy = OverflowPolicy::Reject;
+    queue.setLimits(limits, [](const SizedQuery& query) { return query.bytes; });
+
+    CHECK(queue.pushQuery(makeQuery(1, 60)) == PushStatus::Pushed);
+    CHECK(queue.pushQuery(makeQuery(2, 60)) == PushStatus::Rejected);
+    CHECK(queue.pushQuery(makeQuery(3, 40)) == PushStatus::Pushed);
+    CHECK(queue.getQueuedBytes() == 100);
+
+    queue.getQuery();
+    queue.getQuery();
+    CHECK(queue.getQueuedBytes() == 0);
+    CHECK(queue.pushQuery(makeQuery(4, 250)) == PushStatus::Pushed);
+    CHECK(queue.pushQuery(makeQuery(5, 1)) == PushStatus::Rejected);
+}
+
+TEST(clearCancelsQueuedQueriesAndReturnsRoom)
+{
+    Queue queue;
+    queue.setLimits(countLimit(2, OverflowPolicy::Reject));
+    auto first = makeQuery(1);
+    auto second = makeQuery(2);
+    queue.pushQuery(first);
+    queue.pushQuery(second);
+    queue.clear();
+
+    CHECK_THROWS(first->getResult(), QueryCancelledError);
+    CHECK_THROWS(second->getResult(), QueryCancelledError);
+    CHECK(queue.pushQuery(makeQuery(3)) == PushStatus::Pushed);
+    CHECK(queue.pushQuery(makeQuery(4)) == PushStatus::Pushed);
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
@@ -0,0 +1,120 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TestUtils.h"
+#include "parallel/ParallelAlgorithms.h"
+
+namespace {
+
+class StartedPool {
+public:
+    explicit StartedPool(unsigned int size) : pool(size)
+    { pool.startThreads(); }
+
+    ~StartedPool()
+    {
+        pool.stopThreads();
+        pool.joinThreads();
+    }
+
+    ForkJoinPool pool;
+};
+
+} // namespace
+
+TEST(parallelForVisitsEveryIndexOnce)
+{
+    StartedPool started(3);
+    std::vector<std::atomic<int>> visits(10000);
+    for (auto& v : visits)
+        v = 0;
+    parallelFor(started.pool, 0, 10000, [&](int i) { visits[i]++; });
+    CHECK(std::all_of(visits.begin(), visits.end(), [](const std::atomic<int>& v) { return v == 1; }));
+    parallelFor(started.pool, 5, 5, [&](int) { CHECK(false); });
+}
+
+TEST(parallelReduceKeepsIndexOrder)
+{
+    StartedPool started(3);
+    long sum = parallelReduce(started.pool, 0, 100000, 0L,
+                              [](int i) { return static_cast<long>(i); },
+                              [](long a, long b) { return a + b; }, 100);
+    CHECK(sum == 4999950000L);
+    // Concatenation is associative but not commutative
+    std::string digits = parallelReduce(started.pool, 0, 50, std::string(),
+                                        [](int i) { return std::to_string(i % 10); },
+                                        [](std::string a, const std::string& b) { return a + b; }, 3);
+    std::string expected;
+    for (int i = 0; i < 50; i++)
+        expected += std::to_string(i % 10);
+    CHECK(digits == expected);
+}
+
+TEST(parallelTransformWritesEveryElement)
+{
+    StartedPool started(2);
+    std::vector<int> in(5000), out(5000);
+    for (size_t i = 0; i < in.size(); i++)
+        in[i] = static_cast<int>(i);
+    auto end = parallelTransform(started.pool, in.begin(), in.end(), out.begin(), [](int v) { return v * 2; });
+    CHECK(end == out.end());
+    for (size_t i = 0; i < out.size(); i++)
+        CHECK(out[i] == static_cast<int>(i) * 2);
+}
+
+TEST(parallelSortWithComparatorAndGrain)
+{
+    StartedPool started(2);
+    std::vector<int> values(10000);
+    for (size_t i = 0; i < values.size(); i++)
+        values[i] = static_cast<int>((i * 7919) % 10007);
+
+    parallelSort(started.pool, values.begin(), values.end(), 100);
+    CHECK(std::is_sorted(values.begin(), values.end()));
+    parallelSort(started.pool, values.begin(), values.end(), std::greater<int>(), 100);
+    CHECK(std::is_sorted(values.rbegin(), values.rend()));
+    parallelSort(started.pool, values.begin(), values.end());
+    CHECK(std::is_sorted(values.begin(), values.end()));
+}
+
+TEST(bodyExceptionIsRethrownToCaller)
+{
+    StartedPool started(2);
+    CHECK_THROWS(parallelFor(started.pool, 0, 100, [](int i) {
+        if (i == 50)
+            throw std::logic_error("chunk failed");
+    }, 1), std::logic_error);
+}
+
+TEST(throwingPostedFunctionDoesNotKillWorker)
+{
+    StartedPool started(1);
+    started.pool.post([] { throw std::runtime_error("posted function failed"); });
+    std::atomic<bool> ran(false);
+    started.pool.post([&ran] { ran = true; });
+    CHECK(test::waitUntil([&] { return ran.load(); }));
+}
+
+TEST(nestedForkJoinOnPoolThreadDoesNotDeadlock)
+{
+    StartedPool started(1);
+    std::atomic<int> inner(0);
+    parallelFor(started.pool, 0, 4, [&](int) {
+        parallelFor(started.pool, 0, 100, [&](int) { inner++; }, 10);
+    }, 1);
+    CHECK(inner == 400);
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
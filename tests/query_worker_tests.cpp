@@ -0,0 +1,186 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "TestUtils.h"
+#include "query_thread/QueryBase.h"
+#include "query_thread/QueryQueueBase.h"
+#include "query_thread/QueryThreadPool.h"
+#include "query_thread/QueryThreadSimple.h"
+#include "query_thread/QueryThreadTimeout.h"
+#include "query_thread/QueryWorker.h"
+
+namespace {
+
+struct ValueQuery : QueryBase<int> {
+    explicit ValueQuery(int value) : value(value) { }
+    int value;
+};
+
+typedef std::shared_ptr<ValueQuery> ValueQueryPtr;
+typedef QueryQueueBase<ValueQuery> Queue;
+
+/// Handler state is shared_ptr, so a moved-from copy would crash or give wrong results
+struct ScalingHandler {
+    std::shared_ptr<int> factor = std::make_shared<int>(7);
+
+    void operator()(ValueQueryPtr query, MonotonicArena& arena)
+    {
+        int* scratch = static_cast<int*>(arena.allocate(sizeof(int), alignof(int)));
+        *scratch = query->value * *factor;
+        query->setResult(*scratch);
+    }
+};
+
+/*
+ * Records which copies of the handler processed queries
+ */
+struct CopyRecordingHandler {
+    struct Shared {
+        std::mutex mutex;
+        std::set<const CopyRecordingHandler*> copies;
+    };
+    std::shared_ptr<Shared> shared = std::make_shared<Shared>();
+
+    void operator()(ValueQueryPtr query)
+    {
+        {
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            shared->copies.insert(this);
+        }
+        query->setResult(query->value);
+    }
+};
+
+struct TimeoutHandler {
+    std::shared_ptr<std::atomic<int>> timeouts = std::make_shared<std::atomic<int>>(0);
+
+    void operator()(ValueQueryPtr query)
+    { query->setResult(query->value + 1); }
+
+    void onTimeout()
+    { (*timeouts)++; }
+};
+
+class DoublingThread : public QueryThreadSimple<ValueQuery> {
+public:
+    ~DoublingThread()
+    {
+        stopThread();
+        joinThread();
+    }
+
+protected:
+    void onQuery(ValueQueryPtr query) override
+    { query->setResult(query->value * 2); }
+};
+
+class IdleCountingThread : public QueryThreadTimeout<ValueQuery> {
+public:
+    IdleCountingThread() : QueryThreadTimeout<ValueQuery>(std::chrono::milliseconds(5)) { }
+
+    ~IdleCountingThread()
+    {
+        stopThread();
+        joinThread();
+    }
+
+    std::atomic<int> timeouts{0};
+
+protected:
+    void onQuery(ValueQueryPtr query) override
+    { query->setResult(query->value); }
+
+    void onTimeout() override
+    { timeouts++; }
+};
+
+} // namespace
+
+TEST(poolThreadsGetOwnHandlerCopies)
+{
+    typedef QueryWorker<Queue, ScalingHandler> Worker;
+    QueryThreadPool<Worker> pool(4, std::make_shared<Queue>(), ScalingHandler());
+    pool.startThreads();
+    std::vector<ValueQueryPtr> queries;
+    for (int i = 0; i < 200; i++) {
+        queries.push_back(std::make_shared<ValueQuery>(i));
+        pool.putQuery(queries.back());
+    }
+    for (int i = 0; i < 200; i++)
+        CHECK(queries[i]->getResult() == i * 7);
+    pool.stopThreads();
+    pool.joinThreads();
+}
+
+TEST(handlerCopiesAreDistinctPerThread)
+{
+    typedef QueryWorker<Queue, CopyRecordingHandler> Worker;
+    CopyRecordingHandler handler;
+    QueryThreadPool<Worker> pool(3, std::make_shared<Queue>(), handler);
+    std::set<const CopyRecordingHandler*> owned;
+    pool.forEachThread([&](const std::shared_ptr<Worker>& thread) {
+        owned.insert(&thread->getHandler());
+    });
+    CHECK(owned.size() == 3);
+
+    pool.startThreads();
+    for (int i = 0; i < 300; i++)
+        pool.putQuery(std::make_shared<ValueQuery>(i));
+    CHECK(pool.emplaceQueryAndGetResult(1) == 1);
+    pool.stopThreads();
+    pool.joinThreads();
+
+    std::lock_guard<std::mutex> lock(handler.shared->mutex);
+    CHECK(!handler.shared->copies.empty());
+    for (const CopyRecordingHandler* copy : handler.shared->copies)
+        CHECK(owned.count(copy) == 1);
+}
+
+TEST(functorHandlerTimesOutWhenIdle)
+{
+    typedef QueryWorker<Queue, TimeoutHandler, DynamicWait, WithTimeout> Worker;
+    TimeoutHandler handler;
+    Worker worker(std::make_shared<Queue>(), handler, WithTimeout(std::chrono::milliseconds(5)));
+    worker.startThread();
+    CHECK(test::waitUntil([&] { return *handler.timeouts >= 3; }));
+    CHECK(worker.emplaceQueryAndGetResult(1) == 2);
+}
+
+TEST(batchSizeProcessesSeveralQueriesPerWakeup)
+{
+    typedef QueryWorker<Queue, TimeoutHandler, BlockingWait, NoTimeout, 8> Worker;
+    Worker worker(std::make_shared<Queue>(), TimeoutHandler());
+    std::vector<ValueQueryPtr> queries;
+    for (int i = 0; i < 100; i++) {
+        queries.push_back(std::make_shared<ValueQuery>(i));
+        worker.putQuery(queries.back());
+    }
+    worker.startThread();
+    for (int i = 0; i < 100; i++)
+        CHECK(queries[i]->getResult() == i + 1);
+}
+
+TEST(virtualThreadsAreWorkerAliases)
+{
+    DoublingThread simple;
+    simple.startThread();
+    CHECK(simple.emplaceQueryAndGetResult(21) == 42);
+
+    IdleCountingThread timeout;
+    timeout.startThread();
+    CHECK(test::waitUntil([&] { return timeout.timeouts >= 2; }));
+    CHECK(timeout.emplaceQueryAndGetResult(3) == 3);
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
@@ -0,0 +1,143 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "TestUtils.h"
+#include "query_thread/QueryBase.h"
+#include "query_thread/QueryThreadReactor.h"
+
+namespace {
+
+struct ValueQuery : QueryBase<int> {
+    explicit ValueQuery(int value) : value(value) { }
+    int value;
+};
+
+typedef std::shared_ptr<ValueQuery> ValueQueryPtr;
+
+class EchoReactor : public QueryThreadReactor<ValueQuery> {
+public:
+    ~EchoReactor() override
+    {
+        stopThread();
+        joinThread();
+    }
+
+protected:
+    void onQuery(ValueQueryPtr query) override
+    { query->setResult(query->value); }
+};
+
+bool isOpen(int fd)
+{ return ::fcntl(fd, F_GETFD) != -1; }
+
+} // namespace
+
+TEST(reactorStopsWhenDestroyedIdle)
+{
+    EchoReactor reactor;
+    reactor.startThread();
+    CHECK(reactor.emplaceQueryAndGetResult(5) == 5);
+    // Destructor must wake the reactor blocked in epoll_wait()
+}
+
+TEST(reactorProcessesQueriesInBatches)
+{
+    EchoReactor reactor;
+    std::vector<ValueQueryPtr> queries;
+    for (int i = 0; i < 200; i++) {
+        queries.push_back(std::make_shared<ValueQuery>(i));
+        reactor.putQuery(queries.back());
+    }
+    reactor.startThread();
+    for (int i = 0; i < 200; i++)
+        CHECK(queries[i]->getResult() == i);
+}
+
+TEST(reactorDispatchesDescriptorEvents)
+{
+    EchoReactor reactor;
+    reactor.startThread();
+    int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    CHECK(fd >= 0);
+    std::atomic<uint64_t> received(0);
+    reactor.addFd(fd, EPOLLIN, [&](uint32_t events) {
+        uint64_t value;
+        if ((events & EPOLLIN) && ::read(fd, &value, sizeof(value)) == sizeof(value))
+            received += value;
+    });
+
+    uint64_t value = 3;
+    CHECK(::write(fd, &value, sizeof(value)) == sizeof(value));
+    CHECK(test::waitUntil([&] { return received == 3; }));
+
+    reactor.removeFd(fd);
+    CHECK(::write(fd, &value, sizeof(value)) == sizeof(value));
+    CHECK(reactor.emplaceQueryAndGetResult(1) == 1);
+    CHECK(received == 3);
+    ::close(fd);
+}
+
+TEST(reactorRunsTimers)
+{
+    EchoReactor reactor;
+    reactor.startThread();
+    std::atomic<int> periodic(0);
+    std::atomic<int> oneShot(0);
+    auto periodicTimer = reactor.addTimer(std::chrono::milliseconds(1), std::chrono::milliseconds(2),
+                                          [&] { periodic++; });
+    auto oneShotTimer = reactor.addTimer(std::chrono::milliseconds(5), std::chrono::nanoseconds(0),
+                                         [&] { oneShot++; });
+
+    CHECK(test::waitUntil([&] { return periodic >= 3 && oneShot == 1; }));
+    reactor.removeTimer(periodicTimer);
+    reactor.removeTimer(oneShotTimer);
+    // Reactor closes the timerfds before it waits again
+    CHECK(test::waitUntil([&] { return !isOpen(periodicTimer) && !isOpen(oneShotTimer); }));
+    int stopped = periodic;
+    CHECK(reactor.emplaceQueryAndGetResult(1) == 1);
+    CHECK(periodic <= stopped + 1);
+    CHECK(oneShot == 1);
+}
+
+TEST(timersRemovedFromOtherThreadWhileFiring)
+{
+    EchoReactor reactor;
+    reactor.startThread();
+    std::atomic<int> fired(0);
+    for (int round = 0; round < 200; round++) {
+        auto timer = reactor.addTimer(std::chrono::microseconds(10), std::chrono::microseconds(10),
+                                      [&] { fired++; });
+        reactor.removeTimer(timer);
+    }
+    CHECK(reactor.emplaceQueryAndGetResult(2) == 2);
+    CHECK(!reactor.isFailed());
+    CHECK(!reactor.getWaitError());
+}
+
+TEST(timersRemovedBeforeStartAreClosedByDestructor)
+{
+    int timer;
+    {
+        EchoReactor reactor;
+        timer = reactor.addTimer(std::chrono::seconds(10), std::chrono::nanoseconds(0), [] { });
+        reactor.removeTimer(timer);
+        CHECK(isOpen(timer));
+    }
+    CHECK(!isOpen(timer));
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
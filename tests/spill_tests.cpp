@@ -0,0 +1,150 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TestUtils.h"
+#include "query_thread/QueryBase.h"
+#include "query_thread/SpillQueryQueue.h"
+
+namespace {
+
+/*
+ * Negative values serialize, but fail to deserialize
+ */
+struct SerializableQuery : QueryBase<int> {
+    explicit SerializableQuery(int value) : value(value) { }
+
+    void serialize(std::string& out) const
+    { out.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+
+    static std::shared_ptr<SerializableQuery> deserialize(const char* data, size_t size)
+    {
+        if (size != sizeof(int))
+            return nullptr;
+        int value;
+        std::memcpy(&value, data, sizeof(value));
+        if (value < 0)
+            return nullptr;
+        return std::make_shared<SerializableQuery>(value);
+    }
+
+    int value;
+};
+
+typedef std::shared_ptr<SerializableQuery> SerializableQueryPtr;
+typedef SpillQueryQueue<SerializableQuery> Queue;
+
+SpillParams smallParams(size_t memoryWatermark)
+{
+    SpillParams params;
+    params.memoryWatermark = memoryWatermark;
+    params.segmentSize = 4096;
+    return params;
+}
+
+} // namespace
+
+TEST(spilledQueriesComeBackInOrder)
+{
+    Queue queue(smallParams(8));
+    for (int i = 0; i < 1000; i++)
+        queue.emplaceQuery(i);
+    CHECK(queue.size() == 8);
+    CHECK(queue.getSpilledCount() == 992);
+    CHECK(queue.getPinnedCount() == 0);
+    // Records of 8 bytes, so the backlog takes a few segments
+    CHECK(queue.getSegmentCount() > 1);
+
+    for (int i = 0; i < 1000; i++) {
+        SerializableQueryPtr query = queue.getQuery();
+        CHECK(query->value == i);
+        CHECK(queue.size() <= 8);
+    }
+    CHECK(queue.isEmpty());
+    CHECK(queue.getSpilledCount() == 0);
+    // Consumed segments are kept for reuse up to the limit
+    CHECK(queue.getSegmentCount() <= SpillParams().maxFreeSegments);
+}
+
+TEST(spillTryPushQueryKeepsOrder)
+{
+    Queue queue(smallParams(4));
+    QueueLimits limits;
+    limits.maxCount = 100;
+    queue.setLimits(limits);
+
+    for (int i = 0; i < 6; i++)
+        CHECK(queue.tryPushQuery(std::make_shared<SerializableQuery>(i)) == PushStatus::Pushed);
+    CHECK(queue.getSpilledCount() == 2);
+    CHECK(queue.getQuery()->value == 0);
+    // Memory has room again, but older queries are still on disk
+    CHECK(queue.tryPushQuery(std::make_shared<SerializableQuery>(6)) == PushStatus::Pushed);
+    for (int i = 1; i < 7; i++)
+        CHECK(queue.getQuery()->value == i);
+}
+
+TEST(heldQueriesArePinnedInMemory)
+{
+    Queue queue(smallParams(2));
+    std::vector<SerializableQueryPtr> held;
+    for (int i = 0; i < 6; i++) {
+        held.push_back(std::make_shared<SerializableQuery>(i));
+        queue.pushQuery(held.back());
+    }
+    queue.emplaceQuery(6);
+    CHECK(queue.getSpilledCount() == 5);
+    // Pinned queries are resident whatever the watermark is
+    CHECK(queue.getPinnedCount() == 4);
+
+    for (int i = 0; i < 6; i++) {
+        SerializableQueryPtr query = queue.getQuery();
+        // The very object the producer waits on
+        CHECK(query == held[i]);
+        query->setResult(i);
+    }
+    CHECK(queue.getQuery()->value == 6);
+    CHECK(queue.getPinnedCount() == 0);
+    for (int i = 0; i < 6; i++)
+        CHECK(held[i]->getResult() == i);
+}
+
+TEST(unreadableQueriesAreCountedAndSkipped)
+{
+    Queue queue(smallParams(1));
+    queue.emplaceQuery(0);
+    queue.emplaceQuery(-1);
+    queue.emplaceQuery(2);
+    CHECK(queue.getQuery()->value == 0);
+    CHECK(queue.getQuery()->value == 2);
+    CHECK(queue.getUnreadableCount() == 1);
+    CHECK(queue.isEmpty());
+}
+
+TEST(clearCancelsSpilledQueries)
+{
+    auto inMemory = std::make_shared<SerializableQuery>(0);
+    auto pinned = std::make_shared<SerializableQuery>(1);
+    {
+        Queue queue(smallParams(1));
+        queue.pushQuery(inMemory);
+        queue.pushQuery(pinned);
+        queue.emplaceQuery(2);
+        CHECK(queue.getSpilledCount() == 2);
+        queue.clear();
+        CHECK(queue.getSpilledCount() == 0);
+        CHECK(queue.getPinnedCount() == 0);
+        CHECK(queue.isEmpty());
+    }
+    CHECK_THROWS(inMemory->getResult(), QueryCancelledError);
+    CHECK_THROWS(pinned->getResult(), QueryCancelledError);
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
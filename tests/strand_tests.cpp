@@ -0,0 +1,204 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "TestUtils.h"
+#include "query_thread/KeyedStrandQueue.h"
+#include "query_thread/QueryBase.h"
+#include "query_thread/QueryThreadPool.h"
+#include "query_thread/QueryWorker.h"
+
+namespace {
+
+struct KeyedQuery : QueryBase<int> {
+    typedef int KeyType;
+    KeyedQuery(int key, int sequence) : key(key), sequence(sequence) { }
+    int getKey() const { return key; }
+    int key;
+    int sequence;
+};
+
+typedef std::shared_ptr<KeyedQuery> KeyedQueryPtr;
+typedef KeyedStrandQueue<KeyedQuery> StrandQueue;
+
+/*
+ * Records the order queries of every key are processed in
+ * and whether two queries of one key ever overlapped
+ */
+struct Recorder {
+    std::mutex mutex;
+    std::map<int, std::vector<int>> order;
+    std::map<int, int> running;
+    std::atomic<bool> overlapped{false};
+};
+
+struct RecordingHandler {
+    std::shared_ptr<Recorder> recorder;
+
+    void operator()(KeyedQueryPtr query)
+    {
+        {
+            std::lock_guard<std::mutex> lock(recorder->mutex);
+            if (recorder->running[query->key]++ != 0)
+                recorder->overlapped = true;
+            recorder->order[query->key].push_back(query->sequence);
+        }
+        std::this_thread::yield();
+        {
+            std::lock_guard<std::mutex> lock(recorder->mutex);
+            recorder->running[query->key]--;
+        }
+        query->setResult(query->sequence);
+    }
+};
+
+typedef QueryThreadPool<QueryWorker<StrandQueue, RecordingHandler>> StrandPool;
+
+KeyedQueryPtr makeQuery(int key, int sequence = 0)
+{ return std::make_shared<KeyedQuery>(key, sequence); }
+
+QueueLimits countLimit(size_t maxCount, OverflowPolicy policy)
+{
+    QueueLimits limits;
+    limits.maxCount = maxCount;
+    limits.policy = policy;
+    return limits;
+}
+
+} // namespace
+
+TEST(queriesOfOneKeyRunInOrderOneAtATime)
+{
+    auto recorder = std::make_shared<Recorder>();
+    auto queue = std::make_shared<StrandQueue>(4);
+    StrandPool pool(4, queue, RecordingHandler{recorder});
+    pool.startThreads();
+
+    const int keys = 8;
+    const int perKey = 200;
+    std::vector<KeyedQueryPtr> queries;
+    for (int i = 0; i < perKey; i++)
+        for (int key = 0; key < keys; key++) {
+            queries.push_back(makeQuery(key, i));
+            CHECK(pool.putQuery(queries.back()) == PushStatus::Pushed);
+        }
+    for (auto& query : queries)
+        query->waitForResult();
+
+    CHECK(!recorder->overlapped);
+    for (int key = 0; key < keys; key++) {
+        const std::vector<int>& order = recorder->order[key];
+        CHECK(order.size() == static_cast<size_t>(perKey));
+        for (int i = 0; i < perKey; i++)
+            CHECK(order[i] == i);
+    }
+    CHECK(test::waitUntil([&] { return queue->getStrandCount() == 0; }));
+}
+
+TEST(onlyStrandHeadsAreInSharedQueue)
+{
+    StrandQueue queue;
+    for (int i = 0; i < 5; i++)
+        queue.pushQuery(makeQuery(1, i));
+    queue.pushQuery(makeQuery(2));
+    CHECK(queue.size() == 2);
+    CHECK(queue.getStrandCount() == 2);
+
+    KeyedQueryPtr head = queue.getQuery();
+    CHECK(head->key == 1 && head->sequence == 0);
+    // The thread which processed the head continues with the strand
+    KeyedQueryPtr next = queue.queryProcessed(head);
+    CHECK(next && next->sequence == 1);
+}
+
+TEST(waitingQueriesCountAgainstLimits)
+{
+    StrandQueue queue;
+    queue.setLimits(countLimit(3, OverflowPolicy::Reject));
+    CHECK(queue.pushQuery(makeQuery(1, 0)) == PushStatus::Pushed);
+    CHECK(queue.pushQuery(makeQuery(1, 1)) == PushStatus::Pushed);
+    CHECK(queue.pushQuery(makeQuery(1, 2)) == PushStatus::Pushed);
+
+    auto rejected = makeQuery(1, 3);
+    CHECK(queue.pushQuery(rejected) == PushStatus::Rejected);
+    CHECK(!rejected->isCompleted());
+    CHECK(queue.pushQuery(makeQuery(2)) == PushStatus::Rejected);
+
+    // Room comes back as queries leave, wherever they leave from
+    KeyedQueryPtr head = queue.getQuery();
+    CHECK(queue.pushQuery(makeQuery(2)) == PushStatus::Pushed);
+    CHECK(queue.pushQuery(makeQuery(1, 3)) == PushStatus::Rejected);
+    KeyedQueryPtr next = queue.queryProcessed(head);
+    CHECK(next && next->sequence == 1);
+    CHECK(queue.pushQuery(makeQuery(1, 3)) == PushStatus::Pushed);
+}
+
+TEST(tryPushQueryRejectsWaitingQueryWhenFull)
+{
+    StrandQueue queue;
+    queue.setLimits(countLimit(1, OverflowPolicy::Block));
+    CHECK(queue.tryPushQuery(makeQuery(1, 0)) == PushStatus::Pushed);
+    CHECK(queue.tryPushQuery(makeQuery(1, 1)) == PushStatus::Rejected);
+    CHECK(queue.tryPushQuery(makeQuery(2)) == PushStatus::Rejected);
+}
+
+TEST(dropNewestCompletesWaitingQuery)
+{
+    StrandQueue queue;
+    queue.setLimits(countLimit(1, OverflowPolicy::DropNewest));
+    queue.pushQuery(makeQuery(1, 0));
+    auto dropped = makeQuery(1, 1);
+    CHECK(queue.pushQuery(dropped) == PushStatus::DroppedNewest);
+    CHECK_THROWS(dropped->getResult(), QueryOverloadedError);
+}
+
+TEST(blockedWaitingPushResumesWhenRoomAppears)
+{
+    StrandQueue queue;
+    queue.setLimits(countLimit(2, OverflowPolicy::Block));
+    queue.pushQuery(makeQuery(1, 0));
+    queue.pushQuery(makeQuery(1, 1));
+
+    std::atomic<bool> returned(false);
+    std::thread producer([&] {
+        queue.pushQuery(makeQuery(1, 2));
+        returned = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    CHECK(!returned);
+
+    KeyedQueryPtr head = queue.getQuery();
+    producer.join();
+    KeyedQueryPtr next = queue.queryProcessed(head);
+    CHECK(next && next->sequence == 1);
+    next = queue.queryProcessed(next);
+    CHECK(next && next->sequence == 2);
+    CHECK(!queue.queryProcessed(next));
+    CHECK(queue.getStrandCount() == 0);
+}
+
+TEST(destroyedQueueCancelsWaitingQueries)
+{
+    auto head = makeQuery(1, 0);
+    auto waiting = makeQuery(1, 1);
+    {
+        StrandQueue queue;
+        queue.pushQuery(head);
+        queue.pushQuery(waiting);
+    }
+    CHECK_THROWS(head->getResult(), QueryCancelledError);
+    CHECK_THROWS(waiting->getResult(), QueryCancelledError);
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
@@ -0,0 +1,153 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "TestUtils.h"
+#include "task_thread/TaskGraph.h"
+
+namespace {
+
+class FunctionTask : public ITask {
+public:
+    explicit FunctionTask(std::function<void()> function) : function(std::move(function)) { }
+
+    void execute() override
+    { function(); }
+
+    bool isTimeToExecute() const override
+    { return false; }
+
+private:
+    std::function<void()> function;
+};
+
+std::shared_ptr<ITask> makeTask(std::function<void()> function)
+{ return std::make_shared<FunctionTask>(std::move(function)); }
+
+std::shared_ptr<ITask> countingTask(std::atomic<int>& counter)
+{ return makeTask([&counter] { counter++; }); }
+
+} // namespace
+
+TEST(nodesRunAfterTheirPredecessors)
+{
+    ForkJoinPool pool(3);
+    pool.startThreads();
+    std::mutex mutex;
+    std::vector<int> order;
+    auto record = [&](int node) {
+        return makeTask([&, node] {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(node);
+        });
+    };
+    std::shared_ptr<TaskGraph> graph = TaskGraph::create();
+    // Diamond: 0 -> {1, 2} -> 3
+    for (int i = 0; i < 4; i++)
+        graph->addNode(record(i));
+    graph->addDependency(0, 1);
+    graph->addDependency(0, 2);
+    graph->addDependency(1, 3);
+    graph->addDependency(2, 3);
+
+    // Validated graph runs any number of times
+    for (int run = 0; run < 3; run++) {
+        order.clear();
+        graph->run(pool)->wait();
+        CHECK(order.size() == 4);
+        CHECK(order.front() == 0 && order.back() == 3);
+    }
+    CHECK_THROWS(graph->addNode(record(4)), std::logic_error);
+    pool.stopThreads();
+    pool.joinThreads();
+}
+
+TEST(cycleIsRejected)
+{
+    std::atomic<int> counter(0);
+    std::shared_ptr<TaskGraph> graph = TaskGraph::create();
+    TaskGraph::NodeId a = graph->addNode(countingTask(counter));
+    TaskGraph::NodeId b = graph->addNode(countingTask(counter));
+    graph->addDependency(a, b);
+    graph->addDependency(b, a);
+    CHECK_THROWS(graph->validate(), std::logic_error);
+    CHECK_THROWS(graph->addDependency(a, a), std::invalid_argument);
+}
+
+TEST(failureSkipsOnlyDependentNodes)
+{
+    ForkJoinPool pool(2);
+    pool.startThreads();
+    std::atomic<int> dependent(0), independent(0);
+    std::shared_ptr<TaskGraph> graph = TaskGraph::create();
+    TaskGraph::NodeId failing = graph->addNode(makeTask([] { throw std::runtime_error("node failed"); }));
+    TaskGraph::NodeId child = graph->addNode(countingTask(dependent));
+    TaskGraph::NodeId grandchild = graph->addNode(countingTask(dependent));
+    graph->addDependency(failing, child);
+    graph->addDependency(child, grandchild);
+    for (int i = 0; i < 50; i++)
+        graph->addNode(countingTask(independent));
+
+    CHECK_THROWS(graph->run(pool)->wait(), std::runtime_error);
+    CHECK(dependent == 0);
+    CHECK(independent == 50);
+    pool.stopThreads();
+    pool.joinThreads();
+}
+
+TEST(nodesDroppedByStoppedPoolFinishTheRun)
+{
+    ForkJoinPool pool(1);
+    pool.startThreads();
+    std::atomic<int> counter(0);
+    std::shared_ptr<TaskGraph> graph = TaskGraph::create();
+    for (int i = 0; i < 10; i++) {
+        TaskGraph::NodeId slow = graph->addNode(makeTask([&counter] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            counter++;
+        }));
+        graph->addDependency(slow, graph->addNode(countingTask(counter)));
+    }
+    TaskGraphRun::SPtr run = graph->run(pool);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    // The worker cancels the nodes left in the queue when it stops
+    pool.stopThreads();
+    pool.joinThreads();
+    CHECK_THROWS(run->waitFor(std::chrono::seconds(5)), QueryCancelledError);
+    CHECK(run->isDone());
+    CHECK(counter < 20);
+}
+
+TEST(nodesRejectedByBoundedQueueFail)
+{
+    auto queue = std::make_shared<QueryQueueBase<RunnableQuery>>();
+    QueueLimits limits;
+    limits.maxCount = 1;
+    limits.policy = OverflowPolicy::Reject;
+    queue->setLimits(limits);
+    ForkJoinPool pool(1, queue);
+    std::atomic<int> counter(0);
+    std::shared_ptr<TaskGraph> graph = TaskGraph::create();
+    for (int i = 0; i < 3; i++)
+        graph->addNode(countingTask(counter));
+
+    TaskGraphRun::SPtr run = graph->run(pool);
+    pool.startThreads();
+    CHECK_THROWS(run->wait(), QueryOverloadedError);
+    CHECK(counter == 1);
+    pool.stopThreads();
+    pool.joinThreads();
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
@@ -0,0 +1,107 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "TestUtils.h"
+#include "ThreadBase.h"
+#include "task_thread/Task.h"
+#include "task_thread/TaskThread.h"
+#include "utils/Condition.h"
+#include "utils/WaitStrategy.h"
+
+namespace {
+
+const WaitPolicy allPolicies[] = {
+        WaitPolicy::BusySpin, WaitPolicy::SpinYield, WaitPolicy::SpinPark, WaitPolicy::Block};
+
+/// Counts iterations, relies on default hasWork()
+class WakeCountingThread : public ThreadBase {
+public:
+    ~WakeCountingThread() override
+    {
+        stopThread();
+        joinThread();
+    }
+
+    std::atomic<int> iterations{0};
+
+protected:
+    void threadIteration() override
+    { iterations++; }
+};
+
+} // namespace
+
+TEST(everyPolicyWakesOnNotification)
+{
+    for (WaitPolicy policy : allPolicies) {
+        WaitStrategy strategy(policy, 100);
+        Condition::SPtr condition = Condition::create();
+        std::atomic<bool> ready(false);
+        std::thread notifier([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            ready = true;
+            condition->notify_all();
+        });
+        strategy.wait(*condition, WAKE_IF(ready.load()));
+        notifier.join();
+        CHECK(ready);
+        CHECK(strategy.getPolicy() == policy);
+    }
+}
+
+TEST(everyPolicyTimesOut)
+{
+    for (WaitPolicy policy : allPolicies) {
+        WaitStrategy strategy(policy, 100);
+        Condition::SPtr condition = Condition::create();
+        auto start = std::chrono::steady_clock::now();
+        CHECK(!strategy.waitFor(*condition, std::chrono::milliseconds(10), WAKE_IF(false)));
+        CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(10));
+        CHECK(strategy.waitFor(*condition, std::chrono::milliseconds(10), WAKE_IF(true)));
+    }
+}
+
+TEST(threadLoopIteratesOncePerWakeup)
+{
+    WakeCountingThread thread;
+    thread.startThread();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(thread.iterations == 0);
+    thread.wakeThread();
+    CHECK(test::waitUntil([&] { return thread.iterations == 1; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(thread.iterations == 1);
+}
+
+TEST(taskThreadRunsTasksEveryPeriodAndStopsPromptly)
+{
+    for (WaitPolicy policy : {WaitPolicy::SpinPark, WaitPolicy::Block}) {
+        TaskThread::SPtr thread = TaskThread::create(std::chrono::milliseconds(10));
+        thread->setWaitStrategy(WaitStrategy(policy, 100));
+        std::atomic<int> runs(0);
+        thread->addTask(Task::create([&runs] { runs++; }));
+        thread->startThread();
+        CHECK(test::waitUntil([&] { return runs >= 3; }));
+
+        TaskThread::SPtr slow = TaskThread::create(std::chrono::milliseconds(10000));
+        slow->setWaitStrategy(WaitStrategy(policy, 100));
+        slow->startThread();
+        auto start = std::chrono::steady_clock::now();
+        slow->stopThread();
+        slow->joinThread();
+        CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(1000));
+
+        thread->stopThread();
+        thread->joinThread();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}
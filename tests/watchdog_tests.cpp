@@ -0,0 +1,151 @@
+//
+// Created by konnod on 10/19/26.
+//
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TestUtils.h"
+#include "query_thread/QueryBase.h"
+#include "query_thread/QueryThreadPool.h"
+#include "query_thread/QueryThreadPoolThread.h"
+#include "watchdog/Watchdog.h"
+
+namespace {
+
+struct SleepQuery : QueryBase<int> {
+    explicit SleepQuery(int ms) : ms(ms) { }
+    int ms;
+};
+
+class SleepingThread : public QueryThreadPoolThread<SleepQuery> {
+public:
+    using QueryThreadPoolThread<SleepQuery>::QueryThreadPoolThread;
+
+    ~SleepingThread()
+    {
+        stopThread();
+        joinThread();
+    }
+
+protected:
+    void onQuery(std::shared_ptr<SleepQuery> query) override
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(query->ms));
+        query->setResult(query->ms);
+    }
+};
+
+} // namespace
+
+TEST(addedThreadIsWatchedFromItsStart)
+{
+    QueryThreadPool<SleepingThread> pool(0, std::make_shared<QueryQueueBase<SleepQuery>>());
+    std::mutex mutex;
+    std::string stalledWorker;
+    auto watchdog = Watchdog::create(std::chrono::milliseconds(30), std::chrono::milliseconds(5),
+                                     [&](const StallReport& report) {
+                                         std::lock_guard<std::mutex> lock(mutex);
+                                         stalledWorker = report.worker;
+                                     });
+    pool.startThreads();
+    watchdog->startThread();
+    // Thread starts right away as the pool is running, its heartbeat must be there already
+    CHECK(watchdog->addWatchedThread(pool, "added"));
+    CHECK(pool.getPoolSize() == 1);
+
+    auto query = std::make_shared<SleepQuery>(200);
+    pool.putQuery(query);
+    CHECK(test::waitUntil([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stalledWorker == "added";
+    }));
+    CHECK(query->getResult() == 200);
+
+    pool.stopThreads();
+    pool.joinThreads();
+    watchdog->stopThread();
+    watchdog->joinThread();
+}
+
+TEST(stallIsReportedOnceUntilNextWork)
+{
+    auto watchdog = Watchdog::create(std::chrono::milliseconds(10), std::chrono::milliseconds(1000),
+                                     [](const StallReport&) { });
+    Heartbeat::SPtr heartbeat = Heartbeat::create();
+    watchdog->watch(heartbeat, "custom");
+    CHECK(watchdog->check().empty());
+
+    heartbeat->begin("first");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::vector<StallReport> reports = watchdog->check();
+    CHECK(reports.size() == 1);
+    CHECK(reports[0].worker == "custom");
+    CHECK(reports[0].work == "first");
+    CHECK(reports[0].elapsed >= std::chrono::milliseconds(10));
+    CHECK(reports[0].completed == 0);
+    CHECK(watchdog->check().empty());
+    heartbeat->end();
+    CHECK(watchdog->check().empty());
+
+    heartbeat->begin("second");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    reports = watchdog->check();
+    CHECK(reports.size() == 1 && reports[0].work == "second" && reports[0].completed == 1);
+    heartbeat->end();
+
+    watchdog->unwatch(heartbeat);
+    heartbeat->begin("third");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(watchdog->check().empty());
+    heartbeat->end();
+}
+
+TEST(pooledThreadsAreReportedByName)
+{
+    QueryThreadPool<SleepingThread> pool(2, std::make_shared<QueryQueueBase<SleepQuery>>());
+    std::mutex mutex;
+    std::set<std::string> stalled;
+    std::string work;
+    auto watchdog = Watchdog::create(std::chrono::milliseconds(30), std::chrono::milliseconds(5),
+                                     [&](const StallReport& report) {
+                                         std::lock_guard<std::mutex> lock(mutex);
+                                         stalled.insert(report.worker);
+                                         work = report.work;
+                                     });
+    watchdog->watchPool(pool, "pool");
+    pool.startThreads();
+    watchdog->startThread();
+
+    auto first = std::make_shared<SleepQuery>(300);
+    auto second = std::make_shared<SleepQuery>(300);
+    pool.putQuery(first);
+    pool.putQuery(second);
+    CHECK(test::waitUntil([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stalled.size() == 2;
+    }));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        CHECK(stalled.count("pool#0") == 1 && stalled.count("pool#1") == 1);
+        CHECK(work.find("SleepQuery") != std::string::npos);
+    }
+    first->getResult();
+    second->getResult();
+
+    pool.stopThreads();
+    pool.joinThreads();
+    watchdog->stopThread();
+    watchdog->joinThread();
+}
+
+int main(int argc, char** argv)
+{
+    return test::runAll(argc, argv);
+}